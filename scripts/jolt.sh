@@ -1,16 +1,12 @@
 # screen off
 su -c "echo 0 > /sys/class/backlight/panel0-backlight/brightness"
 
-# silver cores off
-su -c "echo 0 > /sys/devices/system/cpu/cpu1/online"
-su -c "echo 0 > /sys/devices/system/cpu/cpu2/online"
-su -c "echo 0 > /sys/devices/system/cpu/cpu3/online"
-
 ./build/bin/thermo_jolt \
     -t 5 \
     -d 30 \
     -p 0 \
     -o output \
+    --offline 1-3 \
     --cpu-clock $1 \
     --ram-clock $2 \
     --pulse-cpu-clock $3 \
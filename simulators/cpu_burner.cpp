@@ -1,6 +1,6 @@
 // cpu_burner.cpp — Android/Termux load generator for DVFS testing
 // build: 
-//   ex) g++ -O0 -std=c++20 -pthread cpu_burner.cpp -o cpu_burner
+//   ex) g++ -O2 -std=c++20 -pthread cpu_burner.cpp -o cpu_burner
 // usage:
 //   ex) ./cpu_burner             
 //       --threads 8            # number of threads (default: # of online CPUs)
@@ -8,9 +8,23 @@
 //       --burst 4             # compute burst time in seconds (default: 4s)
 //       --pause 6             # pause (idle) time in seconds (default: 6s)
 //       --device Pixel9      # specify phone type [Pixel9 | S24] (default: Pixel9)
+//       --kernel avx2        # power-virus kernel [auto | scalar | sse2 | avx2 | avx512 | neon | sve] (default: auto [widest])
 //       --cpu-clock 12       # CPU clock index for DVFS (maintain) (default: -1 [off])
 //       --ram-clock 11       # RAM clock index for DVFS (maintain) (default: -1 [off])
+//       --cpu-map freq       # other clusters from the prime index [index | freq | capacity | efficient | override] (default: index)
+//       --cpu-map-override "0=3" # override: policy=idx or policy=idx,idx,.. per prime index (;-separated)
+//       --volt-file volt.txt # OPP voltages ("domain kHz uV" lines) on top of debugfs/devicetree (default: none)
+//       --governor schedutil # userspace governor [schedutil | ondemand | performance | powersave] (default: off)
+//       --gov-period 10      # governor sampling period in ms (default: 10)
+//       --gov-cpuidle        # governor utilization from cpuidle residency (default: /proc/stat)
+//       --setspeed           # userspace cpufreq governor + scaling_setspeed writes (default: min/max squeeze)
+//       --power-cap 4.5      # hold the battery power at 4.5 W (DVFS + duty cycle) (default: off)
+//       --cap-period 250     # power-cap control period in ms (default: 250)
+//       --cap-window 2000    # power averaging window in ms (default: 2000)
+//       --power-model auto   # power-cap nowcast from a power_fit model [auto | path] (default: off)
 //       --output output/     # specify output directory path (default: output/)
+//       --offline 1-3        # cpus to take offline during the run, restored at exit (default: none)
+//       --online 4-7         # cpus to bring online during the run, restored at exit (default: none)
 //       --nopin              # do not pin threads to specific cores (default: pin to cores)
 //       --help               # show this message
 // termination:     
@@ -22,6 +36,8 @@
 #include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <vector>
@@ -44,7 +60,12 @@
 #include "cmdline.h"
 #include "utils/util.hpp"
 #include "hardware/dvfs.h"
+#include "hardware/governor.h"
+#include "hardware/controller.h"
+#include "hardware/hotplug.h"
 #include "hardware/record.h"
+#include "model/power_model.h"
+#include "workload/burn.h"
 
 using namespace std::chrono;
 
@@ -56,37 +77,15 @@ static void on_sigint(int) {
     g_stop.store(true, std::memory_order_relaxed);
 }
 
-// /sys/devices/system/cpu/online parsing
-static std::vector<int> read_online_cpus() {
-    std::ifstream f("/sys/devices/system/cpu/online");
-    std::string s;
-    if (!(f >> s)) return {}; // fail -> empty vector
-    std::vector<int> cpus;
-
-    auto add_range = [&](int a, int b){
-        for (int i = a; i <= b; ++i) cpus.push_back(i);
-    };
-
-    size_t i = 0;
-    while (i < s.size()) {
-        // parse number
-        int a = 0, b = -1;
-        bool neg = false;
-        if (s[i] == ',') { ++i; continue; }
-        // read a
-        while (i < s.size() && isdigit(s[i])) { a = a*10 + (s[i]-'0'); ++i; }
-        if (i < s.size() && s[i] == '-') {
-            ++i;
-            b = 0;
-            while (i < s.size() && isdigit(s[i])) { b = b*10 + (s[i]-'0'); ++i; }
-        }
-        if (b < 0) b = a;
-        add_range(a, b);
-        if (i < s.size() && s[i] == ',') ++i;
-    }
-    std::sort(cpus.begin(), cpus.end());
-    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
-    return cpus;
+// thread placement: online cpus, republished when the online mask changes
+static std::mutex g_place_mu;
+static std::vector<int> g_place_cpus;
+static std::atomic<unsigned> g_place_gen{0};
+
+static void publish_placement(const std::vector<int>& cpus) {
+    std::lock_guard<std::mutex> lk(g_place_mu);
+    g_place_cpus = cpus;
+    g_place_gen.fetch_add(1, std::memory_order_release);
 }
 
 // affine thread to specific core
@@ -128,37 +127,42 @@ static void try_bump_priority() {
     setpriority(PRIO_PROCESS, 0, -5);
 }
 
-// busy loop: FMA-heavy floating point + LCG integer ops
-static void hot_loop(std::atomic<bool>& stop_flag, std::atomic<bool>& work_flag) {
-    // false sharing mitigation by align
-    alignas(64) volatile double v0 = 1.000001, v1 = 0.999999, v2 = 1.000003, v3 = 0.999997;
-    uint32_t rng = 123456789u;
+// busy loop: power-virus kernel chunks (workload/burn.h)
+// duty: busy fraction of every DUTY_PERIOD (power-cap controller), checked between chunks
+// pin_id >= 0: pinned to the pin_id-th online cpu, re-pinned whenever the placement changes
+static constexpr auto DUTY_PERIOD = std::chrono::milliseconds(20);
+struct alignas(64) BurnStats { // per thread, own cache line
+    double flop = 0.0;
+    double busy_s = 0.0;
+};
+static void hot_loop(std::atomic<bool>& stop_flag, std::atomic<bool>& work_flag, const BurnKernel& kernel,
+                     BurnStats& stats, const std::atomic<double>* duty = nullptr, int pin_id = -1) {
+    unsigned place_gen = 0;
 
-    // overhead minimization by large chunk
     while (!stop_flag.load(std::memory_order_relaxed)) {
+        if (pin_id >= 0 && g_place_gen.load(std::memory_order_acquire) != place_gen) {
+            std::lock_guard<std::mutex> lk(g_place_mu);
+            place_gen = g_place_gen.load(std::memory_order_relaxed);
+            if (!g_place_cpus.empty()) (void)pin_to_core(g_place_cpus[pin_id % g_place_cpus.size()]);
+        }
         if (!work_flag.load(std::memory_order_relaxed)) {
             std::this_thread::sleep_for(std::chrono::milliseconds(50));
             continue;
         }
-        
-        #pragma clang loop unroll(full)
-        for (int i = 0; i < 1'000'000; ++i) {
-            //FMA
-            v0 = v0 * 1.0000001 + 0.9999999;
-            v1 = v1 * 0.9999997 + 1.0000003;
-            v2 = v2 * 1.0000002 + 0.9999998;
-            v3 = v3 * 0.9999996 + 1.0000004;
-
-            //LCG
-            rng = rng * 1664525u + 1013904223u;
-
-            // value range control
-            if (v0 > 1e30) v0 = 1.0;
-            if (v1 < 1e-30) v1 = 1.0;
+        if (duty) {
+            // idle for the rest of the period once the busy share is used
+            const auto now = steady_clock::now();
+            const auto phase = now.time_since_epoch() % DUTY_PERIOD;
+            if (phase >= duration_cast<nanoseconds>(DUTY_PERIOD * duty->load(std::memory_order_relaxed))) {
+                std::this_thread::sleep_until(now - phase + DUTY_PERIOD);
+                continue;
+            }
         }
-        // To make not be optimized out by compiler
-        // memory barrier-like effect
-        asm volatile("" :: "r"(v0), "r"(v1), "r"(v2), "r"(v3), "r"(rng) : "memory");
+
+        // one chunk is well below the duty period
+        const auto t0 = steady_clock::now();
+        stats.flop += kernel.chunk();
+        stats.busy_s += duration<double>(steady_clock::now() - t0).count();
     }
 }
 
@@ -174,11 +178,26 @@ int main(int argc, char** argv) {
     cmdParser.add<int>("duration", 'd', "duration time in seconds (default: 10s)", false, 10);
     cmdParser.add<int>("burst", 'b', "computation burst time in seconds (default: 5s)", false, 5);
     cmdParser.add<int>("pause", 'p', "pause (idle) time in seconds (default: 5s)", false, 5);
-    cmdParser.add<std::string>("device", 0, "specify phone type [Pixel9 | S24] (default: Pixel9)", false, "Pixel9");
+    cmdParser.add<std::string>("device", 0, "specify phone type [Pixel9 | S24 | auto] (default: Pixel9)", false, "Pixel9");
     cmdParser.add<std::string>("output", 'o', "specify output directory path (default: output/)", false, "output/");
+    cmdParser.add<std::string>("kernel", 0, "power-virus kernel [auto | scalar | sse2 | avx2 | avx512 | neon | sve] (default: auto [widest of the cpu])", false, "auto");
     // dvfs options
     cmdParser.add<int>("cpu-clock", 'c', "CPU clock index for DVFS (default: -1 [off])", false, -1);
     cmdParser.add<int>("ram-clock", 'r', "CPU clock index for DVFS (default: -1 [off])", false, -1);
+    cmdParser.add<std::string>("cpu-map", 0, "cluster mapping of --cpu-clock [index | freq | capacity | efficient | override] (default: index)", false, "index");
+    cmdParser.add<std::string>("volt-file", 0, "OPP voltages for efficient without a kernel energy model (\"domain kHz uV\" lines)", false, "");
+    cmdParser.add<std::string>("cpu-map-override", 0, "override: policy=idx or policy=idx,idx,.. per prime index, ;-separated", false, "");
+    cmdParser.add<std::string>("governor", 0, "userspace governor [schedutil | ondemand | performance | powersave] (default: off)", false, "");
+    cmdParser.add<int>("gov-period", 0, "governor sampling period in ms, 1-10 (default: 10; below 10 uses cpuidle when available)", false, 10);
+    cmdParser.add("gov-cpuidle", 0, "governor utilization from cpuidle residency instead of /proc/stat");
+    cmdParser.add("setspeed", 0, "userspace cpufreq governor and scaling_setspeed writes instead of the min/max squeeze");
+    cmdParser.add<double>("power-cap", 0, "target battery power in W (default: -1 [off])", false, -1.0);
+    cmdParser.add<int>("cap-period", 0, "power-cap control period in ms (default: 250)", false, 250);
+    cmdParser.add<int>("cap-window", 0, "power averaging window in ms (default: 2000)", false, 2000);
+    cmdParser.add<std::string>("power-model", 0, "power-cap nowcast from a power_fit model, auto: the device cache (default: off)", false, "");
+    // hotplug options
+    cmdParser.add<std::string>("offline", 0, "cpus to take offline during the run, ex. 1-3 (default: none)", false, "");
+    cmdParser.add<std::string>("online", 0, "cpus to bring online during the run, ex. 4-7 (default: none)", false, "");
     cmdParser.parse_check(argc, argv);
     
     // get options
@@ -189,9 +208,31 @@ int main(int argc, char** argv) {
     const int pause_sec = cmdParser.get<int>("pause") > 0 ? cmdParser.get<int>("pause") : 0;
     const std::string device_name = cmdParser.get<std::string>("device");
     const std::string output_dir = cmdParser.get<std::string>("output");
+    const BurnKernel* kernel = find_burn_kernel(cmdParser.get<std::string>("kernel"));
+    if (!kernel) {
+        std::cerr << "kernel not available on this cpu: " << cmdParser.get<std::string>("kernel") << " (available:";
+        for (const auto& k : burn_kernels()) std::cerr << " " << k.name;
+        std::cerr << ")\n";
+        return 1;
+    }
     // dvfs options
     const int cpu_clk_idx = cmdParser.get<int>("cpu-clock");
     const int ram_clk_idx = cmdParser.get<int>("ram-clock");
+    const std::string governor_name = cmdParser.get<std::string>("governor");
+    GovPolicy gov_policy;
+    if (!governor_name.empty()) {
+        gov_policy = gov_policy_by_name(governor_name);
+        if (!gov_policy) {
+            std::cerr << "unknown governor: " << governor_name << "\n";
+            return 1;
+        }
+        if (cpu_clk_idx >= 0) std::cerr << "--cpu-clock is ignored with --governor\n";
+    }
+    const double power_cap = cmdParser.get<double>("power-cap");
+    if (power_cap > 0.0 && gov_policy) {
+        std::cerr << "--power-cap and --governor both drive the cpu clock\n";
+        return 1;
+    }
     
 
     // TODO: kernel hard recording path refinement
@@ -201,7 +242,23 @@ int main(int argc, char** argv) {
         std::string("kernel_hard_") + std::to_string(cpu_clk_idx) + "_" + std::to_string(ram_clk_idx) + std::string(".txt")
     );
 
-    auto cpus = read_online_cpus();
+    // cpu hotplug (states restored at exit); watch only when no change is requested
+    const std::vector<int> offline_cpus = parse_cpu_list(cmdParser.get<std::string>("offline"));
+    const std::vector<int> online_cpus = parse_cpu_list(cmdParser.get<std::string>("online"));
+    const bool hotplug_ctl = !offline_cpus.empty() || !online_cpus.empty();
+    Hotplug hotplug;
+    if (hotplug.open(hotplug_ctl) == 0 && hotplug_ctl) {
+        std::cerr << "no hotpluggable cpu (cpuN/online)\n";
+        return 1;
+    }
+    if (hotplug_ctl) {
+        int failed = hotplug.set_cpus(online_cpus, true) + hotplug.set_cpus(offline_cpus, false);
+        if (failed) std::cerr << failed << " hotplug transition(s) failed. Are you root or authorized?\n";
+        hotplug.refresh();
+        std::cout << hotplug.report() << "\n";
+    }
+
+    auto cpus = hotplug.get_online();
     int online = cpus.empty() ? (int)std::thread::hardware_concurrency() : (int)cpus.size();
     if (online <= 0) online = 1;
 
@@ -211,7 +268,9 @@ int main(int argc, char** argv) {
     std::cout << "cpu_burner: threads=" << threads
               << ", pin=" << (pin ? "yes" : "no")
               << ", duration=" << (duration_sec > 0 ? std::to_string(duration_sec) + "s" : "infinite")
-              << ", online_cpus=" << online << "\n";
+              << ", online_cpus=" << online
+              << ", kernel=" << kernel->name << "\n";
+    std::cout << "topology: " << Topology::system().describe() << "\n";
 
     try_bump_priority();
 
@@ -225,21 +284,81 @@ int main(int argc, char** argv) {
 
     std::vector<std::thread> ths;
     ths.reserve(threads);
+    std::vector<BurnStats> stats(threads);
+    publish_placement(cpus);
 
     // DVFS setting
     DVFS dvfs(device_name);
+    dvfs.load_freq_tables(); // device OPP tables (cached after the first scan)
     if (dvfs.init_fd_cache() != 0) {
         fprintf(stderr, "FD cache initialization failed. Are you root or authorized?\n");
     }
     dvfs.output_filename = output_hard;
-    // cpu clock candidates
-    std::vector<int> freq_config = dvfs.get_cpu_freqs_conf(cpu_clk_idx);
-    for (auto f : freq_config) { std::cout << f << " "; } std::cout << std::endl; // to validate (print freq-configuration)
-    // dvfs setting
-    dvfs.set_cpu_freq(freq_config);
-    dvfs.set_ram_freq(ram_clk_idx);
+    // userspace cpufreq governor (restored by the DVFS destructor)
+    if (cmdParser.exist("setspeed") && dvfs.set_userspace(true) != 0) {
+        std::cerr << "userspace governor not available: min/max squeeze kept\n";
+    }
+    // cluster mapping (resolved into a lookup table once)
+    CpuMap cpu_map;
+    std::map<int, std::vector<int>> cpu_map_overrides;
+    if (!cpu_map_from_name(cmdParser.get<std::string>("cpu-map"), cpu_map) ||
+        !parse_cpu_map_overrides(cmdParser.get<std::string>("cpu-map-override"), cpu_map_overrides)) {
+        std::cerr << "bad --cpu-map or --cpu-map-override\n";
+        return 1;
+    }
+    if (cpu_map == CpuMap::EFFICIENT && dvfs.load_voltages(cmdParser.get<std::string>("volt-file")) < 0) return 1;
+    if (cpu_map == CpuMap::EFFICIENT && dvfs.load_energy_model() == 0) {
+        std::cerr << "no energy model (debugfs) or OPP voltages: efficient falls back to freq\n";
+    }
+    if (dvfs.set_cpu_map(cpu_map, cpu_map_overrides) != 0) {
+        std::cerr << "--cpu-map-override does not match the OPP tables\n";
+        return 1;
+    }
+    // cpu clock candidates (-1: released)
+    DvfsState dvfs_state = dvfs.make_state(gov_policy ? -1 : cpu_clk_idx, ram_clk_idx);
+    for (auto f : dvfs_state.cpu_idx) { std::cout << f << " "; } std::cout << std::endl; // to validate (print freq-configuration)
+    // dvfs setting (all domains or none)
+    DvfsTxResult tx;
+    if (dvfs.fd_cache_enabled() && dvfs.apply_state(dvfs_state, &tx) != 0) {
+        fprintf(stderr, "DVFS transition failed (rc=%d, domain %d)%s\n",
+                tx.rc, tx.failed_domain, tx.rolled_back ? ", prior state restored" : "");
+        return 1;
+    }
+    // userspace governor (drives the cpu clusters instead of a fixed index)
+    GovernorConfig gov_cfg;
+    gov_cfg.period_us = std::min(10, std::max(1, cmdParser.get<int>("gov-period"))) * 1000;
+    if (cmdParser.exist("gov-cpuidle")) gov_cfg.source = UtilSource::CPUIDLE;
+    Governor governor(dvfs, gov_policy, gov_cfg);
+    if (gov_policy) governor.start();
+    // power cap (drives the cpu clock and the duty cycle of the workers)
+    PowerMeter power_meter("battery", std::max(1, cmdParser.get<int>("cap-window")));
+    PowerCapConfig cap_cfg;
+    cap_cfg.target_w = power_cap;
+    cap_cfg.period_ms = std::max(10, cmdParser.get<int>("cap-period"));
+    cap_cfg.ram_idx = ram_clk_idx;
+    PowerModel power_model;
+    std::string model_path = cmdParser.get<std::string>("power-model");
+    if (!model_path.empty() && power_cap > 0.0) {
+        if (model_path == "auto") model_path = power_model_path(dvfs.get_device_name());
+        if (power_model.load(model_path, dvfs.get_device_name()) != 0) {
+            std::cerr << "power model not loadable for " << dvfs.get_device_name() << ": " << model_path << "\n";
+            return 1;
+        }
+        cap_cfg.model = &power_model;
+    }
+    char cap_tag[32];
+    snprintf(cap_tag, sizeof(cap_tag), "%.2fW", power_cap);
+    cap_cfg.log_path = joinPaths(output_dir, std::string("power_cap_") + cap_tag + ".csv");
+    PowerCapController power_ctl(dvfs, power_meter, cap_cfg);
+    if (power_cap > 0.0) {
+        if (power_meter.open() != 0) {
+            std::cerr << "battery current_now/voltage_now not readable\n";
+            return 1;
+        }
+        power_ctl.start();
+    }
     // start recording
-    std::thread record_thread = std::thread(record_hard, std::ref(sigterm), dvfs);
+    std::thread record_thread = std::thread(record_hard, std::ref(sigterm), std::cref(dvfs));
 
     // stabilize
     std::this_thread::sleep_for(std::chrono::milliseconds(50));
@@ -271,29 +390,51 @@ int main(int argc, char** argv) {
     
     for (int i = 0; i < threads; ++i) {
         ths.emplace_back([&, i]{
-            if (pin && !cpus.empty()) {
-                int core_id = cpus[i % cpus.size()];
-                (void)pin_to_core(core_id);
-            }
-            hot_loop(stop, g_work);
+            hot_loop(stop, g_work, *kernel, stats[i], power_cap > 0.0 ? &power_ctl.duty() : nullptr, (pin && !cpus.empty()) ? i : -1);
         });
     }
 
-    // 메인에서 SIGINT 감시
+    // 메인에서 SIGINT 감시 (+ re-place the workers when cpus go on/offline)
     while (!g_stop.load(std::memory_order_relaxed) &&
            !stop.load(std::memory_order_relaxed)) {
         std::this_thread::sleep_for(500ms);
+        if (hotplug.refresh() && !hotplug.get_online().empty()) {
+            std::cout << "[HOTPLUG] online cpus changed: " << hotplug.get_online().size() << " online\n";
+            publish_placement(hotplug.get_online());
+        }
     }
     stop.store(true, std::memory_order_relaxed);
 
     for (auto& t : ths) t.join();
 
+    // sustained rate while busy, summed over the threads
+    double gflops = 0.0, busy_s = 0.0;
+    for (const auto& st : stats) {
+        if (st.busy_s > 0.0) gflops += st.flop / st.busy_s / 1e9;
+        busy_s += st.busy_s;
+    }
+    char line[160];
+    snprintf(line, sizeof(line), "[KERNEL] %s: %.2f GFLOP/s over %d threads, %.1f s busy per thread", kernel->name,
+             gflops, threads, busy_s / threads);
+    std::cout << line << "\n";
     std::cout << "cpu_burner: done.\n";
 
     // done
     sigterm = true;
+    if (gov_policy) {
+        governor.stop();
+        std::cout << governor.report() << "\n";
+    }
+    if (power_cap > 0.0) {
+        power_ctl.stop();
+        std::cout << power_ctl.report() << "\n";
+    }
     dvfs.unset_cpu_freq();
     dvfs.unset_ram_freq();
+    if (hotplug_ctl) {
+        if (hotplug.restore() != 0) std::cerr << "hotplug: some cpus could not be restored\n";
+        std::cout << hotplug.report() << "\n";
+    }
     if (phase_thread.joinable()) phase_thread.join();
     record_thread.join();
     std::this_thread::sleep_for(std::chrono::milliseconds(1000));
@@ -9,6 +9,11 @@
 #include <cstdio>    // for std::remove
 #include <thread>    // for multithreading
 #include <atomic>
+#include <map>
+#include <sstream>
+#include <cmath>
+#include <cerrno>
+#include <climits>
 
 // Windows env for testing
 #if defined(_WIN32)
@@ -19,10 +24,9 @@
 #include "utils/util.hpp"              // for file and path utilities
 #include "hardware/dvfs.h"              // for DVFS control (reuse)
 #include "hardware/record.h" // for hardware recording (reuse)
-
-// type aliases for clarity
-using Vector = std::vector<float>;
-using Matrix = std::vector<std::vector<float>>;
+#include "workload/llm_sim.h"    // for GEMM/GEMV transformer layers (reuse)
+#include "model/perf_model.h"     // for throughput prediction (calibration)
+#include "model/platform_db.h"    // for machine balance (platform_char)
 
 // --- 1. file I/O and memory access functions ---
 void create_dummy_file(const std::string &filename, int size_mb) {
@@ -66,124 +70,126 @@ const Vector &read(const Vector &vec) {
     return vec;
 }
 
-// --- 2. GEMM, GEMV, and Transformer layer simulation functions ---
-Matrix gemm(const Matrix &A, const Matrix &B, const std::string &op_name = "", const int &num_th = 4, const bool verbose = false) {
-    // debugging output
-    if (!op_name.empty() && verbose) {
-        std::cout << "\n[GEMM Debug] Operation: '" << op_name << "'" << std::endl;
-        if (!A.empty() && !A[0].empty())
-            std::cout << "  - Matrix A dims: (" << A.size() << ", " << A[0].size() << ")" << std::endl;
-        else
-            std::cout << "  - Matrix A is empty or malformed." << std::endl;
-        if (!B.empty() && !B[0].empty())
-            std::cout << "  - Matrix B dims: (" << B.size() << ", " << B[0].size() << ")" << std::endl;
-        else
-            std::cout << "  - Matrix B is empty or malformed." << std::endl;
-    }
-
-    if (A.empty() || B.empty() || A[0].size() != B.size()) {
-        throw std::invalid_argument("Invalid GEMM dimensions.");
-    }
-
-    int m = A.size(), k = B.size(), n = B[0].size();
-    Matrix C(m, Vector(n, 0.0f));
-
-    unsigned int num_threads = num_th;
-    if (num_threads == 0) num_threads = 4;
-    std::vector<std::thread> threads;
-
-    int rows_per_thread = m / num_threads;
-
-    // worker function for each thread
-    auto worker = [&](int start_row, int end_row) {
-        for (int i = start_row; i < end_row; ++i) {
-            for (int j = 0; j < n; ++j) {
-                for (int l = 0; l < k; ++l) {
-                    C[i][j] += A[i][l] * B[l][j];
-                }
-            }
+// --- 2. calibration: measure a few clock pairs, predict the others ---
+// "c:r,c:r,..." (prime cpu index : ram index), "auto": 3 cpu x 2 ram points spread over the tables
+// indices past the tables are clamped to the top OPP; return 0 on success, -1 on a malformed spec
+int parse_pairs(const std::string &spec, int cpu_max, int ram_max, std::vector<std::pair<int, int>> &out) {
+    out.clear();
+    if (spec == "auto") {
+        for (int c : { cpu_max / 4, cpu_max / 2, cpu_max }) {
+            for (int r : { ram_max / 3, ram_max }) out.push_back({ c, r });
         }
+        return 0;
+    }
+    // a whole non-negative decimal integer, nothing else
+    auto to_idx = [](const std::string &t, int &v) {
+        char *end = nullptr;
+        errno = 0;
+        const long l = strtol(t.c_str(), &end, 10);
+        if (t.empty() || *end != '\0' || errno == ERANGE || l < 0 || l > INT_MAX) return false;
+        v = (int)l;
+        return true;
     };
-
-    // spawn threads and distribute work
-    for (unsigned int i = 0; i < num_threads; ++i) {
-        int start_row = i * rows_per_thread;
-        int end_row = (i == num_threads - 1) ? m : start_row + rows_per_thread;
-        threads.emplace_back(worker, start_row, end_row);
+    std::stringstream ss(spec);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        std::size_t colon = item.find(':');
+        int c = 0, r = 0;
+        if (colon == std::string::npos || !to_idx(item.substr(0, colon), c) || !to_idx(item.substr(colon + 1), r)) {
+            out.clear();
+            return -1;
+        }
+        out.push_back({ std::min(c, cpu_max), std::min(r, ram_max) });
     }
-
-    // wait for all threads to finish
-    for (auto &th : threads) { th.join(); }
-
-    return C;
+    return out.empty() ? -1 : 0;
 }
 
-Vector gemv(const Vector &y, const Matrix &A, const Vector &x, const int &num_th = 4, const bool verbose = false) {
-    if (verbose) { /* empty */
+// prefill and decode ms per token at one clock pair
+PerfPoint measure_point(DVFS &dvfs, int cpu_idx, int ram_idx, const LlmWeights &w, int num_layers, int seq_len,
+                        int num_threads, double seconds) {
+    PerfPoint p;
+    p.cpu_idx = cpu_idx;
+    p.ram_idx = ram_idx;
+    if (dvfs.fd_cache_enabled() && dvfs.apply_state(dvfs.make_state(cpu_idx, ram_idx)) != 0) {
+        fprintf(stderr, "[Calib] DVFS transition to (%d, %d) failed\n", cpu_idx, ram_idx);
+        return p;
     }
+    const double pre_tok_s = llm_prefill_for(w, num_layers, seq_len, num_threads, seconds);
+    const double dec_tok_s = llm_decode_for(w, num_layers, num_threads, seconds);
+    if (pre_tok_s > 0.0) p.prefill_ms = 1000.0 / pre_tok_s;
+    if (dec_tok_s > 0.0) p.decode_ms = 1000.0 / dec_tok_s;
+    printf("[Calib] cpu %2d ram %2d: TTFT %8.2f ms, TPOT %7.3f ms\n", cpu_idx, ram_idx, seq_len * p.prefill_ms, p.decode_ms);
+    return p;
+}
 
-    if (A.empty() || x.empty() || A[0].size() != x.size()) throw std::invalid_argument("Invalid GEMV dimensions.");
-    int m = A.size(), n = x.size();
-    Vector result_y = y; // y copy
-
-    unsigned int num_threads = num_th;
-    if (num_threads == 0) num_threads = 4;
-    std::vector<std::thread> threads;
-
-    int rows_per_thread = m / num_threads;
+int run_calibration(DVFS &dvfs, const std::vector<std::pair<int, int>> &calib_pairs,
+                    const std::vector<std::pair<int, int>> &validate_pairs, const LlmWeights &w,
+                    int num_layers, int seq_len, int num_threads, double seconds, const std::string &output_dir) {
+    const std::vector<int> &clusters = dvfs.get_cluster_indices();
+    const int cpu_max = (int)dvfs.get_cpu_freq().at(clusters.back()).size() - 1;
+    const int ram_max = (int)dvfs.get_ddr_freq().size() - 1;
+
+    std::vector<PerfPoint> points;
+    for (const auto &cr : calib_pairs) points.push_back(measure_point(dvfs, cr.first, cr.second, w, num_layers, seq_len, num_threads, seconds));
+    PerfModel model;
+    const int rc = model.fit(points, dvfs);
+    if (rc != 0) {
+        fprintf(stderr, "[Calib] fit failed (%s)\n", rc == 1 ? "needs 3 distinct clock pairs" : "degenerate measurements");
+        return 1;
+    }
+    std::cout << model.describe(dvfs) << std::endl;
+
+    // roofline: weight traffic intensity (fp32, 2 FLOP per weight and token) vs machine balance
+    PlatformDb db;
+    const bool has_db = db.load(platform_db_path(dvfs.get_device_name()), dvfs.get_device_name()) == 0;
+    if (has_db) {
+        const double top = db.balance(dvfs, model.decode.slot, -1, -1);
+        printf("[Calib] machine balance %.2f FLOP/B (platform db, top clocks): decode %.2f FLOP/B (%s), prefill %.2f FLOP/B (%s)\n",
+               top, 0.5, 0.5 < top ? "memory-bound" : "compute-bound", seq_len * 0.5,
+               seq_len * 0.5 < top ? "memory-bound" : "compute-bound");
+    }
 
-    // worker function for each thread
-    auto worker = [&](int start_row, int end_row) {
-        for (int i = start_row; i < end_row; ++i) {
-            for (int j = 0; j < n; ++j) {
-                result_y[i] += A[i][j] * x[j];
-            }
+    // every pair
+    const std::string predict_csv = joinPaths(output_dir, "dummy_predict.csv");
+    std::ofstream csv(predict_csv);
+    csv << "cpu_idx,ram_idx,ttft_ms,tpot_ms,prefill_compute_share,decode_compute_share,measured" << (has_db ? ",balance" : "") << "\n";
+    for (int c = 0; c <= cpu_max; ++c) {
+        for (int r = 0; r <= ram_max; ++r) {
+            bool measured = false;
+            for (const auto &cr : calib_pairs) measured = measured || (cr.first == c && cr.second == r);
+            csv << c << "," << r << "," << seq_len * model.predict(dvfs, c, r, false) << "," << model.predict(dvfs, c, r, true)
+                << "," << model.compute_share(dvfs, c, r, false) << "," << model.compute_share(dvfs, c, r, true) << ","
+                << (measured ? 1 : 0);
+            if (has_db) csv << "," << db.balance(dvfs, model.decode.slot, dvfs.make_state(c, r).cpu_idx[model.decode.slot], r);
+            csv << "\n";
         }
-    };
-
-    // spawn threads and distribute work
-    for (unsigned int i = 0; i < num_threads; ++i) {
-        int start_row = i * rows_per_thread;
-        int end_row = (i == num_threads - 1) ? m : start_row + rows_per_thread;
-        threads.emplace_back(worker, start_row, end_row);
     }
-
-    // wait for all threads to finish
-    for (auto &th : threads) { th.join(); }
-
-    return result_y;
-}
-
-// [mod] add name tags for debugging in GEMM
-Matrix transformer_layer_prefill(const Matrix &input,
-                                 const Matrix &W_q, const Matrix &W_k, const Matrix &W_v,
-                                 const Matrix &W_o, const Matrix &W_ffn1, const Matrix &W_ffn2,
-                                 const int &num_th) {
-    // prefill: input shape (seq_len, hidden_dim)
-    Matrix Q = gemm(input, W_q, "Prefill: Q = input * W_q", num_th);
-    Matrix AttentionOutput = gemm(Q, W_v, "Prefill: AttentionOutput = Q * W_v", num_th);
-    Matrix AttentionFinal = gemm(AttentionOutput, W_o, "Prefill: AttentionFinal = AttentionOutput * W_o", num_th);
-    Matrix ffn1_output = gemm(AttentionFinal, W_ffn1, "Prefill: ffn1_output = AttentionFinal * W_ffn1", num_th);
-    Matrix ffn2_output = gemm(ffn1_output, W_ffn2, "Prefill: ffn2_output = ffn1_output * W_ffn2", num_th);
-    return ffn2_output;
-}
-
-Vector transformer_layer_decode(const Vector &token,
-                                const Matrix &W_q, const Matrix &W_k, const Matrix &W_v,
-                                const Matrix &W_o, const Matrix &W_ffn1, const Matrix &W_ffn2,
-                                const int &num_th) {
-    // decode: token shape (hidden_dim,)
-    Vector y(W_q.size(), 0.0f);
-    Vector q = gemv(y, W_q, token, num_th);
-    Vector v = gemv(y, W_v, token, num_th);
-    Vector AttentionOutput = gemv(y, W_o, v, num_th);
-
-    Vector y_ffn(W_ffn2.size(), 0.0f);
-    Vector ffn1_output = gemv(y_ffn, W_ffn2, AttentionOutput, num_th);
-
-    Vector y_final(W_ffn1.size(), 0.0f);
-    Vector ffn2_output = gemv(y_final, W_ffn1, ffn1_output, num_th);
-    return ffn2_output;
+    std::cout << "[Calib] predictions for " << (cpu_max + 1) * (ram_max + 1) << " clock pairs: " << predict_csv << std::endl;
+
+    // validation: measured vs predicted
+    double ttft_err = 0.0, tpot_err = 0.0;
+    int validated = 0;
+    for (const auto &cr : validate_pairs) {
+        PerfPoint p = measure_point(dvfs, cr.first, cr.second, w, num_layers, seq_len, num_threads, seconds);
+        // state not applied or no token measured: nothing to compare
+        if (!(p.prefill_ms > 0.0) || !(p.decode_ms > 0.0)) {
+            fprintf(stderr, "[Calib] validate cpu %2d ram %2d: no measurement, skipped\n", cr.first, cr.second);
+            continue;
+        }
+        const double e_pre = std::fabs(model.predict(dvfs, cr.first, cr.second, false) / p.prefill_ms - 1.0);
+        const double e_dec = std::fabs(model.predict(dvfs, cr.first, cr.second, true) / p.decode_ms - 1.0);
+        printf("[Calib] validate cpu %2d ram %2d: TTFT error %.1f%%, TPOT error %.1f%%\n", cr.first, cr.second,
+               100.0 * e_pre, 100.0 * e_dec);
+        ttft_err += e_pre;
+        tpot_err += e_dec;
+        validated++;
+    }
+    if (validated > 0) {
+        printf("[Calib] mean absolute error over %d points: TTFT %.1f%%, TPOT %.1f%%\n", validated,
+               100.0 * ttft_err / validated, 100.0 * tpot_err / validated);
+    }
+    if (dvfs.fd_cache_enabled()) dvfs.apply_state(dvfs.make_state(-1, -1));
+    return 0;
 }
 
 // --- 3. main function ---
@@ -204,11 +210,15 @@ int main(int argc, char **argv) {
     cmdParser.add<int>("hidden-dim", 'h', "hidden dimension", false, 256); // lowered by fp16 memory issue
     cmdParser.add<int>("ffn-size", 'f', "hidden dimension", false, 588);   // lowered by fp16 memory issue
     cmdParser.add<int>("input-tokens", 'i', "input length (alias: prompt tokens)", false, 64);
-    cmdParser.add<int>("output-tokens", 'o', "output length (alias: generation tokens)", false, 256);
+    cmdParser.add<int>("output-tokens", 0, "output length (alias: generation tokens)", false, 256);
     cmdParser.add<int>("num-threads", 't', "number of threads", false, 4);
-    cmdParser.add<int>("cpu-clock", 'c', "number of threads", true, 12);
-    cmdParser.add<int>("ram-clock", 'r', "number of threads", true, 11);
+    cmdParser.add<int>("cpu-clock", 'c', "CPU clock index for DVFS", true, 12);
+    cmdParser.add<int>("ram-clock", 'r', "RAM clock index for DVFS", true, 11);
     cmdParser.add<std::string>("output", 'o', "specify output directory path (default: output/)", false, "output/");
+    cmdParser.add<std::string>("pin-devfreq", 0, "pin devfreq domains, name:idx[,name:idx] (ex. 1f000000.mali:0)", false, "");
+    cmdParser.add<std::string>("calibrate", 0, "measure clock pairs c:r[,c:r] (or auto) and predict TTFT/TPOT for all pairs", false, "");
+    cmdParser.add<std::string>("validate", 0, "clock pairs c:r[,c:r] measured against the calibrated predictions", false, "");
+    cmdParser.add<double>("calib-sec", 0, "seconds per phase and calibration point (default: 3)", false, 3.0);
     cmdParser.parse_check(argc, argv);
 
     // model hyperparameters
@@ -225,6 +235,21 @@ int main(int argc, char **argv) {
     const std::string output_dir = cmdParser.get<std::string>("output");
     const std::string device_name = "Pixel9"; // fixed for testing
 
+    // devfreq pins (ex. GPU or bus domains held fixed to isolate the memory-bandwidth effect)
+    std::map<std::string, int> devfreq_pins;
+    {
+        std::stringstream ss(cmdParser.get<std::string>("pin-devfreq"));
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            std::size_t colon = item.rfind(':');
+            if (colon == std::string::npos) {
+                fprintf(stderr, "--pin-devfreq expects name:idx (got %s)\n", item.c_str());
+                return 1;
+            }
+            devfreq_pins[item.substr(0, colon)] = std::stoi(item.substr(colon + 1));
+        }
+    }
+
     // TODO: kernel hard recording path refinement
     // output file join
     std::string output_hard = joinPaths(
@@ -234,18 +259,58 @@ int main(int argc, char **argv) {
 
     // DVFS setting
     DVFS dvfs(device_name);
+    dvfs.load_freq_tables(); // device OPP tables (cached after the first scan)
     if (dvfs.init_fd_cache() != 0) {
         fprintf(stderr, "FD cache initialization failed. Are you root or authorized?\n");
     }
+    for (const auto& pin : devfreq_pins) {
+        if (dvfs.add_devfreq(pin.first) != 0) {
+            fprintf(stderr, "devfreq domain %s unavailable. found:", pin.first.c_str());
+            for (const auto& path : DevfreqDomain::discover()) fprintf(stderr, " %s", DevfreqDomain(path).get_name().c_str());
+            fprintf(stderr, "\n");
+            return 1;
+        }
+    }
+    // calibration pairs (checked before anything runs)
+    const std::string calib_spec = cmdParser.get<std::string>("calibrate");
+    const std::string validate_spec = cmdParser.get<std::string>("validate");
+    std::vector<std::pair<int, int>> calib_pairs, validate_pairs;
+    if (!calib_spec.empty() || !validate_spec.empty()) {
+        if (!dvfs.fd_cache_enabled()) {
+            fprintf(stderr, "--calibrate/--validate need DVFS control (FD cache not ready)\n");
+            return 1;
+        }
+        const int cpu_max = (int)dvfs.get_cpu_freq().at(dvfs.get_cluster_indices().back()).size() - 1;
+        const int ram_max = (int)dvfs.get_ddr_freq().size() - 1;
+        if (!calib_spec.empty() && parse_pairs(calib_spec, cpu_max, ram_max, calib_pairs) != 0) {
+            std::cerr << "invalid --calibrate: " << calib_spec << "\n" << cmdParser.usage();
+            return 1;
+        }
+        if (!validate_spec.empty() && parse_pairs(validate_spec, cpu_max, ram_max, validate_pairs) != 0) {
+            std::cerr << "invalid --validate: " << validate_spec << "\n" << cmdParser.usage();
+            return 1;
+        }
+    }
     dvfs.output_filename = output_hard;
-    // cpu clock candidates
-    std::vector<int> freq_config = dvfs.get_cpu_freqs_conf(cpu_clk_idx);
-    for (auto f : freq_config) { std::cout << f << " "; } std::cout << std::endl; // to validate (print freq-configuration)
-    // dvfs setting
-    dvfs.set_cpu_freq(freq_config);
-    dvfs.set_ram_freq(ram_clk_idx);
+    // cpu clock candidates (-1: released)
+    DvfsState dvfs_state = dvfs.make_state(cpu_clk_idx, ram_clk_idx);
+    dvfs_state.devfreq_idx = devfreq_pins;
+    for (auto f : dvfs_state.cpu_idx) { std::cout << f << " "; } std::cout << std::endl; // to validate (print freq-configuration)
+    // dvfs setting (all domains or none)
+    DvfsTxResult tx;
+    if (dvfs.fd_cache_enabled() && dvfs.apply_state(dvfs_state, &tx) != 0) {
+        fprintf(stderr, "DVFS transition failed (rc=%d, domain %d)%s\n",
+                tx.rc, tx.failed_domain, tx.rolled_back ? ", prior state restored" : "");
+        return 1;
+    }
+    // calibration mode: no inference loop, no recording
+    if (!calib_spec.empty()) {
+        LlmWeights weights = random_weights(hidden_dim, ffn_dim);
+        return run_calibration(dvfs, calib_pairs, validate_pairs, weights, num_layers, seq_len, num_threads,
+                               cmdParser.get<double>("calib-sec"), output_dir);
+    }
     // start recording
-    std::thread record_thread = std::thread(record_hard, std::ref(sigterm), dvfs);
+    std::thread record_thread = std::thread(record_hard, std::ref(sigterm), std::cref(dvfs));
 
     // stabilize
     std::this_thread::sleep_for(std::chrono::milliseconds(50));
@@ -337,8 +402,10 @@ int main(int argc, char **argv) {
 
     // done
     sigterm = true;
-    dvfs.unset_cpu_freq();
-    dvfs.unset_ram_freq();
+    // release every pinned domain
+    DvfsState released = dvfs.make_state(-1, -1);
+    for (const auto& pin : devfreq_pins) released.devfreq_idx[pin.first] = -1;
+    dvfs.apply_state(released);
     record_thread.join();
     std::this_thread::sleep_for(std::chrono::milliseconds(1000));
 
@@ -0,0 +1,232 @@
+// dvfs_bench.cpp — DVFS write path micro-benchmark
+// Compares the legacy lookup (string-keyed nested std::map + linear fd scan + lseek/write)
+// and the flat slot lookup alone (no I/O) with the flat slot path of DVFS::set_cpu_freq() (array loads + pwrite),
+// with and without read-back, and for unchanged configs skipped by the state cache,
+// then the userspace governor path (one scaling_setspeed write per policy).
+// Runs on a fake sysfs tree, so no root is needed.
+// usage:
+//   ex) ./dvfs_bench
+//       --device Pixel9       # built-in device descriptor (default: Pixel9)
+//       --iters 200000        # set calls per method (default: 200000)
+//       --root /tmp/dds_bench # fake sysfs root (default: /tmp/dds_bench)
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "cmdline.h"
+#include "hardware/dvfs.h"
+
+using namespace std::chrono;
+
+// mkdir -p
+static void make_dirs(const std::string& path) {
+    for (std::size_t pos = 1; pos != std::string::npos; ) {
+        pos = path.find('/', pos + 1);
+        mkdir(path.substr(0, pos).c_str(), 0755);
+    }
+}
+
+static void touch(const std::string& path, const std::string& text = "") {
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+        if (!text.empty()) (void)!write(fd, text.c_str(), text.size());
+        close(fd);
+    }
+}
+
+// ---- legacy path (as before the flat slots) ----
+struct LegacyFD {
+    int policy_idx;
+    int min_fd;
+    int max_fd;
+};
+
+static int legacy_write(int fd, long long v) {
+    char buf[64];
+    int len = snprintf(buf, sizeof(buf), "%lld\n", v);
+    (void)lseek(fd, 0, SEEK_SET);
+    return write(fd, buf, len) == len ? 0 : -1;
+}
+
+static int legacy_set(const std::map<std::string, std::map<int, std::vector<int>>>& cpufreq,
+                      const std::string& device, const std::vector<int>& cluster_indices,
+                      std::vector<LegacyFD>& fds, const std::vector<int>& freq_indices, bool do_write) {
+    for (int i = 0; i < (int)cluster_indices.size(); ++i) {
+        int policy = cluster_indices[i];
+        const auto& table = cpufreq.at(device).at(policy);
+        int freq_idx = freq_indices[i];
+        if (freq_idx < 0 || freq_idx >= (int)table.size()) return 3;
+        int clk = table[freq_idx];
+
+        LegacyFD* fdp = nullptr;
+        for (auto& p : fds) if (p.policy_idx == policy) { fdp = &p; break; }
+        if (!fdp) return 4;
+        if (!do_write) { asm volatile("" :: "r"(clk), "r"(fdp) : "memory"); continue; }
+
+        if (legacy_write(fdp->max_fd, clk) != 0) return 5;
+        if (legacy_write(fdp->min_fd, clk) != 0) return 6;
+    }
+    return 0;
+}
+
+// ---- flat path without I/O (same layout as DVFS::cpu_opp / cpu_slots / cpu_fds) ----
+struct FlatSlot {
+    int begin;
+    int size;
+    int min_fd;
+    int max_fd;
+};
+
+static int flat_lookup(const std::vector<int>& opp, const std::vector<FlatSlot>& slots,
+                       const std::vector<int>& freq_indices) {
+    for (std::size_t i = 0; i < slots.size(); ++i) {
+        const FlatSlot& s = slots[i];
+        int freq_idx = freq_indices[i];
+        if (freq_idx < 0 || freq_idx >= s.size) return 3;
+        int clk = opp[s.begin + freq_idx];
+        asm volatile("" :: "r"(clk), "r"(s.min_fd), "r"(s.max_fd) : "memory");
+    }
+    return 0;
+}
+
+// ---- timing ----
+struct Stats { double mean, p50, p99; };
+
+template <typename F>
+static Stats measure(int iters, F&& fn) {
+    std::vector<double> ns(iters);
+    for (int i = 0; i < iters; ++i) {
+        auto t0 = steady_clock::now();
+        fn(i);
+        auto t1 = steady_clock::now();
+        ns[i] = (double)duration_cast<nanoseconds>(t1 - t0).count();
+    }
+    double sum = 0.0;
+    for (double v : ns) sum += v;
+    std::sort(ns.begin(), ns.end());
+    return { sum / iters, ns[iters / 2], ns[(std::size_t)(iters * 0.99)] };
+}
+
+static void print_row(const char* name, const Stats& s) {
+    printf("%-28s %10.1f %10.1f %10.1f\n", name, s.mean, s.p50, s.p99);
+}
+
+int main(int argc, char** argv) {
+    cmdline::parser cmdParser;
+    cmdParser.add<std::string>("device", 0, "built-in device descriptor (default: Pixel9)", false, "Pixel9");
+    cmdParser.add<int>("iters", 'n', "set calls per method (default: 200000)", false, 200000);
+    cmdParser.add<std::string>("root", 0, "fake sysfs root (default: /tmp/dds_bench)", false, "/tmp/dds_bench");
+    cmdParser.parse_check(argc, argv);
+
+    const std::string device_name = cmdParser.get<std::string>("device");
+    const int iters = std::max(100, cmdParser.get<int>("iters"));
+    const std::string root = cmdParser.get<std::string>("root");
+
+    const DeviceDesc* desc = find_device_desc(device_name);
+    if (!desc) {
+        fprintf(stderr, "unknown device: %s\n", device_name.c_str());
+        return 1;
+    }
+
+    // fake sysfs tree
+    std::vector<int> cluster_indices;
+    std::map<std::string, std::map<int, std::vector<int>>> cpufreq;
+    for (int c = 0; c < desc->num_clusters; ++c) {
+        const ClusterDesc& cl = desc->clusters[c];
+        const std::string base = root + "/sys/devices/system/cpu/cpufreq/policy" + std::to_string(cl.policy);
+        make_dirs(base);
+        touch(base + "/scaling_min_freq");
+        touch(base + "/scaling_max_freq");
+        touch(base + "/scaling_setspeed");
+        touch(base + "/scaling_cur_freq", std::to_string(cl.opp[0]) + "\n");
+        touch(base + "/scaling_governor", "schedutil\n");
+        touch(base + "/scaling_available_governors", "userspace schedutil\n");
+        cluster_indices.push_back(cl.policy);
+        cpufreq[device_name][cl.policy] = std::vector<int>(cl.opp.begin(), cl.opp.end());
+    }
+    const std::string mif = root + "/sys/devices/platform/17000010.devfreq_mif/devfreq/17000010.devfreq_mif";
+    make_dirs(mif);
+    touch(mif + "/scaling_devfreq_min");
+    touch(mif + "/scaling_devfreq_max");
+    touch(mif + "/max_freq");
+
+    // flat path
+    DVFS dvfs(device_name);
+    dvfs.set_sysfs_root(root);
+    if (dvfs.init_fd_cache() != 0) {
+        fprintf(stderr, "FD cache initialization failed on %s\n", root.c_str());
+        return 1;
+    }
+
+    // legacy path (own fds on the same files)
+    std::vector<LegacyFD> legacy_fds;
+    for (int policy : cluster_indices) {
+        const std::string base = root + "/sys/devices/system/cpu/cpufreq/policy" + std::to_string(policy);
+        legacy_fds.push_back({ policy,
+                               open((base + "/scaling_min_freq").c_str(), O_WRONLY | O_CLOEXEC),
+                               open((base + "/scaling_max_freq").c_str(), O_WRONLY | O_CLOEXEC) });
+    }
+
+    std::vector<int> flat_opp;
+    std::vector<FlatSlot> flat_slots;
+    for (std::size_t i = 0; i < cluster_indices.size(); ++i) {
+        const std::vector<int>& table = cpufreq[device_name][cluster_indices[i]];
+        flat_slots.push_back({ (int)flat_opp.size(), (int)table.size(), legacy_fds[i].min_fd, legacy_fds[i].max_fd });
+        flat_opp.insert(flat_opp.end(), table.begin(), table.end());
+    }
+
+    // alternate between two configurations
+    std::vector<int> conf_lo(cluster_indices.size(), 0);
+    std::vector<int> conf_hi = dvfs.get_cpu_freqs_conf(desc->clusters[desc->num_clusters - 1].opp.size - 1);
+    auto conf = [&](int i) -> const std::vector<int>& { return (i & 1) ? conf_hi : conf_lo; };
+
+    printf("dvfs_bench: device=%s, clusters=%zu, iters=%d\n", device_name.c_str(), cluster_indices.size(), iters);
+    printf("%-28s %10s %10s %10s\n", "method [ns/call]", "mean", "p50", "p99");
+
+    print_row("legacy lookup only", measure(iters, [&](int i) {
+        legacy_set(cpufreq, device_name, cluster_indices, legacy_fds, conf(i), false);
+    }));
+    print_row("flat lookup only", measure(iters, [&](int i) {
+        flat_lookup(flat_opp, flat_slots, conf(i));
+    }));
+    print_row("legacy lookup + lseek/write", measure(iters, [&](int i) {
+        legacy_set(cpufreq, device_name, cluster_indices, legacy_fds, conf(i), true);
+    }));
+    auto per_call = [&](const char* name, bool verify, bool changing) {
+        dvfs.set_verify(verify);
+        DVFS::IoStats before = dvfs.get_io_stats();
+        print_row(name, measure(iters, [&](int i) {
+            dvfs.set_cpu_freq(changing ? conf(i) : conf_hi);
+        }));
+        DVFS::IoStats after = dvfs.get_io_stats();
+        printf("%-28s writes=%.2f reads=%.2f skipped=%.2f per call\n", "",
+               (double)(after.writes - before.writes) / iters,
+               (double)(after.reads - before.reads) / iters,
+               (double)(after.skipped - before.skipped) / iters);
+    };
+    per_call("flat slots + pwrite", false, true);
+    per_call("flat + pwrite + read-back", true, true);
+    per_call("flat, unchanged (cached)", true, false);
+
+    // userspace governor: scaling_setspeed instead of the min/max squeeze
+    if (dvfs.set_userspace(true) != 0) {
+        fprintf(stderr, "userspace governor switch failed on %s\n", root.c_str());
+    } else {
+        per_call("setspeed + pwrite", false, true);
+        per_call("setspeed + read-back", true, true);
+        per_call("setspeed, unchanged (cached)", true, false);
+        dvfs.set_userspace(false); // saved governor back
+    }
+
+    for (auto& p : legacy_fds) { close(p.min_fd); close(p.max_fd); }
+    return 0;
+}
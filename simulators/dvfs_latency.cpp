@@ -0,0 +1,348 @@
+// dvfs_latency.cpp — DVFS transition latency characterisation
+// Steps each cpufreq policy and the MIF domain between OPP pairs and reports,
+// per pair, latency histograms of:
+//   - write:  set call return (sysfs write completion)
+//   - cur:    scaling_cur_freq (devfreq cur_freq) reporting the new clock
+//   - spin:   cycle-rate estimate of a calibrated spin loop pinned on the cluster
+//             reaching the new clock (+-5%)
+// and the sysfs syscalls per transition. CPU policies are stepped by the min/max
+// squeeze, the userspace governor (scaling_setspeed), or both in turn.
+// usage:
+//   ex) ./dvfs_latency
+//       --device Pixel9       # specify phone type (default: Pixel9)
+//       --reps 20             # repetitions per pair (default: 20)
+//       --window 50           # observation window per step in ms (default: 50)
+//       --output lat.csv      # raw samples as csv (default: none)
+//       --method both         # cpu write path [squeeze | setspeed | both] (default: squeeze)
+//       --no-mif              # skip the MIF domain
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#if defined(__linux__) || defined(__ANDROID__)
+  #include <sys/syscall.h>
+  #include <sched.h>
+#endif
+
+#include "cmdline.h"
+#include "hardware/dvfs.h"
+#include "utils/clock.h"
+
+using namespace std::chrono;
+
+// affine thread to specific core
+static bool pin_to_core(int core_id) {
+#if defined(__linux__) || defined(__ANDROID__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core_id, &set);
+    pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+    return sched_setaffinity(tid, sizeof(set), &set) == 0;
+#else
+    (void)core_id;
+    return true;
+#endif
+}
+
+// ---- calibrated spin loop ----
+// a dependent integer chain: the iteration rate is proportional to the core clock
+static constexpr int SPIN_CHUNK = 2000;
+
+static inline uint64_t spin_chunk(uint64_t x) {
+    for (int i = 0; i < SPIN_CHUNK; ++i) {
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+        asm volatile("" : "+r"(x));
+    }
+    return x;
+}
+
+struct SpinProbe {
+    std::vector<int64_t> stamps; // end time of every chunk
+    std::atomic<int> count{0};
+    std::atomic<bool> run{false};
+    std::thread th;
+
+    void start(int cpu, int max_samples) {
+        stamps.assign(max_samples, 0);
+        count = 0;
+        run = true;
+        th = std::thread([this, cpu] {
+            pin_to_core(cpu);
+            uint64_t x = 1;
+            int n = 0;
+            while (run.load(std::memory_order_relaxed) && n < (int)stamps.size()) {
+                x = spin_chunk(x);
+                stamps[n++] = now_ns();
+                count.store(n, std::memory_order_release);
+            }
+            asm volatile("" :: "r"(x));
+        });
+    }
+    void stop() {
+        run = false;
+        if (th.joinable()) th.join();
+    }
+};
+
+// chunks per second on cpu (current clock)
+static double measure_rate(int cpu, int ms) {
+    SpinProbe probe;
+    probe.start(cpu, 1 << 20);
+    std::this_thread::sleep_for(milliseconds(ms));
+    probe.stop();
+    int n = probe.count.load();
+    if (n < 10) return 0.0;
+    // skip the first samples (migration, warm-up)
+    int a = n / 5;
+    return (double)(n - 1 - a) * 1e9 / (double)(probe.stamps[n - 1] - probe.stamps[a]);
+}
+
+// ---- histogram ----
+static void print_hist(const char* name, std::vector<double> us) {
+    us.erase(std::remove_if(us.begin(), us.end(), [](double v) { return v < 0; }), us.end());
+    if (us.empty()) { printf("    %-6s n/a\n", name); return; }
+    std::sort(us.begin(), us.end());
+    auto pct = [&](double q) { return us[std::min(us.size() - 1, (std::size_t)(q * us.size()))]; };
+    printf("    %-6s n=%-3zu min=%9.1f p50=%9.1f p90=%9.1f max=%9.1f us\n",
+           name, us.size(), us.front(), pct(0.5), pct(0.9), us.back());
+
+    // log2 bins: [0,1), [1,2), [2,4), ... us
+    std::vector<int> bins(24, 0);
+    for (double v : us) {
+        int b = (v < 1.0) ? 0 : std::min(23, 1 + (int)std::floor(std::log2(v)));
+        bins[b]++;
+    }
+    for (int b = 0; b < (int)bins.size(); ++b) {
+        if (bins[b] == 0) continue;
+        double lo = (b == 0) ? 0.0 : std::pow(2.0, b - 1);
+        printf("           [%8.0f, %8.0f) %-3d %s\n", lo, std::pow(2.0, b), bins[b], std::string(bins[b], '#').c_str());
+    }
+}
+
+struct Sample {
+    double write_us = -1, cur_us = -1, spin_us = -1;
+    long syscalls = 0;
+    int rc = 0; // DVFS rc of the write, 7: read back another clock (checked after timing)
+};
+
+int main(int argc, char** argv) {
+    cmdline::parser cmdParser;
+    cmdParser.add<std::string>("device", 0, "specify phone type (default: Pixel9)", false, "Pixel9");
+    cmdParser.add<int>("reps", 'n', "repetitions per pair (default: 20)", false, 20);
+    cmdParser.add<int>("window", 'w', "observation window per step in ms (default: 50)", false, 50);
+    cmdParser.add<std::string>("output", 'o', "raw samples as csv (default: none)", false, "");
+    cmdParser.add<std::string>("method", 0, "cpu write path [squeeze | setspeed | both] (default: squeeze)", false, "squeeze");
+    cmdParser.add("no-mif", 0, "skip the MIF domain");
+    cmdParser.parse_check(argc, argv);
+
+    const std::string device_name = cmdParser.get<std::string>("device");
+    const int reps = std::max(1, cmdParser.get<int>("reps"));
+    const int window_ms = std::max(5, cmdParser.get<int>("window"));
+    const std::string output = cmdParser.get<std::string>("output");
+    const std::string method_opt = cmdParser.get<std::string>("method");
+    std::vector<std::string> methods;
+    if (method_opt == "squeeze" || method_opt == "both") methods.push_back("squeeze");
+    if (method_opt == "setspeed" || method_opt == "both") methods.push_back("setspeed");
+    if (methods.empty()) {
+        fprintf(stderr, "unknown method: %s\n", method_opt.c_str());
+        return 1;
+    }
+
+    DVFS dvfs(device_name);
+    dvfs.load_freq_tables();
+    if (dvfs.init_fd_cache() != 0) {
+        fprintf(stderr, "FD cache initialization failed. Are you root or authorized?\n");
+        return 1;
+    }
+
+    std::ofstream csv;
+    if (!output.empty()) {
+        csv.open(output);
+        csv << "domain,from_khz,to_khz,rep,write_us,cur_us,spin_us,method,syscalls,rc\n";
+    }
+
+    const Topology& topo = dvfs.get_topology();
+    const std::vector<int> clusters = dvfs.get_cluster_indices();
+
+    // OPP pairs per table: extremes and mid <-> max in both directions
+    auto make_pairs = [](int n) {
+        std::vector<std::pair<int, int>> pairs = { { 0, n - 1 }, { n - 1, 0 } };
+        if (n > 2) {
+            pairs.push_back({ n / 2, n - 1 });
+            pairs.push_back({ n - 1, n / 2 });
+        }
+        return pairs;
+    };
+
+    printf("dvfs_latency: device=%s, reps=%d, window=%dms\n", device_name.c_str(), reps, window_ms);
+
+    // write timings cover the write syscalls only: the read-back runs after the
+    // timed region (resync_state()), failed transitions are logged with their rc
+    dvfs.set_verify(false);
+
+    // ---- CPU policies ----
+    for (const std::string& method : methods) {
+        if (method == "setspeed" && dvfs.set_userspace(true) != 0) {
+            fprintf(stderr, "userspace governor not available: setspeed skipped\n");
+            continue;
+        }
+        for (int slot = 0; slot < (int)clusters.size(); ++slot) {
+            const std::vector<int>& table = dvfs.get_cpu_freq().at(clusters[slot]);
+            if (table.size() < 2) continue;
+
+            // spin probe on the last cpu of the cluster, writer elsewhere
+            int ci = topo.cluster_of(clusters[slot]);
+            int probe_cpu = (ci >= 0) ? topo.get_clusters()[ci].cpus.back() : clusters[slot];
+            for (int other : topo.cpus_by_capacity()) {
+                if (topo.cluster_of(other) != ci) { pin_to_core(other); break; }
+            }
+
+            // calibration: chunks per second per kHz at the highest OPP
+            dvfs.set_cluster_freq(slot, (int)table.size() - 1);
+            std::this_thread::sleep_for(milliseconds(100));
+            const double rate_per_khz = measure_rate(probe_cpu, 200) / table.back();
+            printf("\n[policy%d, %s] probe cpu%d, calibration %.3f chunks/s per kHz\n",
+                   clusters[slot], method.c_str(), probe_cpu, rate_per_khz);
+
+            for (auto pr : make_pairs((int)table.size())) {
+                const int f_from = table[pr.first], f_to = table[pr.second];
+                std::vector<Sample> samples;
+
+                for (int r = 0; r < reps; ++r) {
+                    // settle at the start OPP
+                    dvfs.set_cluster_freq(slot, pr.first);
+                    std::this_thread::sleep_for(milliseconds(window_ms));
+
+                    SpinProbe probe;
+                    probe.start(probe_cpu, 1 << 18);
+                    std::this_thread::sleep_for(milliseconds(2));
+
+                    Sample s;
+                    const DVFS::IoStats io0 = dvfs.get_io_stats();
+                    const int64_t t0 = now_ns();
+                    s.rc = dvfs.set_cluster_freq(slot, pr.second);
+                    s.write_us = (now_ns() - t0) / 1e3;
+                    const DVFS::IoStats io1 = dvfs.get_io_stats();
+                    s.syscalls = (io1.writes - io0.writes) + (io1.reads - io0.reads);
+
+                    // poll scaling_cur_freq within the window
+                    const int64_t deadline = t0 + (int64_t)window_ms * 1000000;
+                    while (now_ns() < deadline) {
+                        int cur = dvfs.get_cur_cpu_freq(slot);
+                        if (cur < 0) break;
+                        if (cur == f_to) { s.cur_us = (now_ns() - t0) / 1e3; break; }
+                    }
+                    std::this_thread::sleep_until(steady_clock::time_point(nanoseconds(deadline)));
+                    probe.stop();
+
+                    // first window of 4 chunks after t0 whose rate is within 5% of the target
+                    const int n = probe.count.load();
+                    const int W = 4;
+                    for (int i = W; i < n; ++i) {
+                        if (probe.stamps[i - W] < t0) continue;
+                        double rate = W * 1e9 / (double)(probe.stamps[i] - probe.stamps[i - W]);
+                        double est_khz = rate / rate_per_khz;
+                        if (std::fabs(est_khz - f_to) <= 0.05 * f_to) {
+                            s.spin_us = (probe.stamps[i - W] - t0) / 1e3;
+                            break;
+                        }
+                    }
+
+                    // validate outside the cur/spin window so the read-back cost is not measured
+                    if (s.rc == 0) {
+                        dvfs.resync_state();
+                        if (dvfs.get_state().cpu_idx[slot] != pr.second) s.rc = 7;
+                    }
+                    if (s.rc != 0) {
+                        fprintf(stderr, "  policy%d %d -> %d kHz rep %d: transition failed (rc=%d)\n",
+                                clusters[slot], f_from, f_to, r, s.rc);
+                    }
+
+                    samples.push_back(s);
+                    if (csv) {
+                        csv << "policy" << clusters[slot] << "," << f_from << "," << f_to << "," << r << ","
+                            << s.write_us << "," << s.cur_us << "," << s.spin_us << ","
+                            << method << "," << s.syscalls << "," << s.rc << "\n";
+                    }
+                }
+
+                // histograms over the applied transitions
+                std::vector<double> w, c, sp;
+                long syscalls = 0;
+                int failed = 0;
+                for (const auto& s : samples) {
+                    if (s.rc != 0) { failed++; continue; }
+                    w.push_back(s.write_us); c.push_back(s.cur_us); sp.push_back(s.spin_us);
+                    syscalls += s.syscalls;
+                }
+                printf("  %d -> %d kHz, %.1f syscalls per transition, %d/%zu failed\n", f_from, f_to,
+                       w.empty() ? 0.0 : (double)syscalls / w.size(), failed, samples.size());
+                print_hist("write", w);
+                print_hist("cur", c);
+                print_hist("spin", sp);
+            }
+        }
+        dvfs.unset_cpu_freq();
+        dvfs.set_userspace(false); // saved governors back
+    }
+
+    // ---- MIF ----
+    const std::vector<int>& ddr = dvfs.get_ddr_freq();
+    if (!cmdParser.exist("no-mif") && ddr.size() >= 2) {
+        printf("\n[MIF]\n");
+        for (auto pr : make_pairs((int)ddr.size())) {
+            const int f_from = ddr[pr.first], f_to = ddr[pr.second];
+            std::vector<double> w, c;
+            int failed = 0;
+
+            for (int r = 0; r < reps; ++r) {
+                dvfs.set_ram_freq(pr.first);
+                std::this_thread::sleep_for(milliseconds(window_ms));
+
+                const int64_t t0 = now_ns();
+                int rc = dvfs.set_ram_freq(pr.second);
+                double write_us = (now_ns() - t0) / 1e3, cur_us = -1;
+                if (rc == 0) {
+                    const int64_t deadline = t0 + (int64_t)window_ms * 1000000;
+                    while (now_ns() < deadline) {
+                        int cur = dvfs.get_cur_ram_freq();
+                        if (cur < 0) break;
+                        if (cur == f_to) { cur_us = (now_ns() - t0) / 1e3; break; }
+                    }
+                    // validate outside the cur window so the read-back cost is not measured
+                    dvfs.resync_state();
+                    if (dvfs.get_state().ram_idx != pr.second) rc = 7;
+                }
+                if (rc != 0) {
+                    fprintf(stderr, "  mif %d -> %d kHz rep %d: transition failed (rc=%d)\n", f_from, f_to, r, rc);
+                    failed++;
+                    if (csv) csv << "mif," << f_from << "," << f_to << "," << r << "," << write_us << ",-1,-1,range,," << rc << "\n";
+                    continue;
+                }
+
+                w.push_back(write_us);
+                c.push_back(cur_us);
+                if (csv) csv << "mif," << f_from << "," << f_to << "," << r << "," << write_us << "," << cur_us << ",-1,range,,0\n";
+            }
+
+            printf("  %d -> %d kHz, %d/%d failed\n", f_from, f_to, failed, reps);
+            print_hist("write", w);
+            print_hist("cur", c);
+        }
+        dvfs.unset_ram_freq();
+    }
+    dvfs.set_verify(true);
+
+    return 0;
+}
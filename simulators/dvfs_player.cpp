@@ -0,0 +1,109 @@
+// dvfs_player.cpp — DVFS trace player
+// Replays a schedule file of (time, cpu, ram) steps, or a synthetic square-wave /
+// chirp pattern between two prime cpu indices, at absolute deadlines.
+// The actual application time of every step is written as csv.
+// usage:
+//   ex) ./dvfs_player
+//       --device Pixel9         # specify phone type (default: Pixel9)
+//       --schedule trace.txt    # schedule file (see src/hardware/trace_player.h)
+//       --square 100            # square wave in Hz (instead of --schedule)
+//       --chirp 10:400          # linear chirp f0:f1 in Hz (instead of --schedule)
+//       --lo 0 --hi 16          # prime cpu indices of the synthetic patterns
+//       --ram-clock -1          # RAM clock index of the synthetic patterns (default: -1 [off])
+//       --duration 5            # synthetic pattern length in seconds (default: 5)
+//       --spin 200              # spin before each deadline in us (default: 200)
+//       --output output/        # output directory path (default: output/)
+
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "cmdline.h"
+#include "utils/util.hpp"
+#include "hardware/dvfs.h"
+#include "hardware/trace_player.h"
+
+static std::atomic<bool> g_stop{false};
+static void on_sigint(int) { g_stop.store(true, std::memory_order_relaxed); }
+
+int main(int argc, char** argv) {
+    std::signal(SIGINT, on_sigint);
+
+    cmdline::parser cmdParser;
+    cmdParser.add<std::string>("device", 0, "specify phone type [Pixel9 | S24 | auto] (default: Pixel9)", false, "Pixel9");
+    cmdParser.add<std::string>("schedule", 's', "schedule file (time_sec cpu_idx|c0,c1,.. ram_idx)", false, "");
+    cmdParser.add<double>("square", 0, "square wave frequency in Hz (default: off)", false, 0.0);
+    cmdParser.add<std::string>("chirp", 0, "linear chirp f0:f1 in Hz (default: off)", false, "");
+    cmdParser.add<int>("lo", 0, "low prime cpu index of the synthetic pattern (default: 0)", false, 0);
+    cmdParser.add<int>("hi", 0, "high prime cpu index of the synthetic pattern (default: max)", false, -1);
+    cmdParser.add<int>("ram-clock", 0, "RAM clock index of the synthetic pattern (default: -1 [off])", false, -1);
+    cmdParser.add<double>("duration", 'd', "synthetic pattern length in seconds (default: 5)", false, 5.0);
+    cmdParser.add<int>("spin", 0, "spin before each deadline in us (default: 200)", false, 200);
+    cmdParser.add<std::string>("output", 'o', "specify output directory path (default: output/)", false, "output/");
+    cmdParser.parse_check(argc, argv);
+
+    const std::string device_name = cmdParser.get<std::string>("device");
+    const std::string schedule = cmdParser.get<std::string>("schedule");
+    const double square_hz = cmdParser.get<double>("square");
+    const std::string chirp = cmdParser.get<std::string>("chirp");
+    const double duration_sec = cmdParser.get<double>("duration");
+    const int ram_clk_idx = cmdParser.get<int>("ram-clock");
+
+    DVFS dvfs(device_name);
+    dvfs.load_freq_tables();
+
+    // prime cluster table bounds the synthetic indices
+    const std::vector<int>& clusters = dvfs.get_cluster_indices();
+    const int prime_max = clusters.empty() ? 0 : (int)dvfs.get_cpu_freq().at(clusters.back()).size() - 1;
+    const int lo = std::max(0, cmdParser.get<int>("lo"));
+    const int hi = cmdParser.get<int>("hi") < 0 ? prime_max : std::min(prime_max, cmdParser.get<int>("hi"));
+
+    // build the trace
+    std::vector<TraceStep> steps;
+    std::string tag;
+    if (!schedule.empty()) {
+        steps = load_trace(schedule);
+        tag = "schedule";
+    } else if (square_hz > 0.0) {
+        steps = square_wave_trace(lo, hi, square_hz, duration_sec, ram_clk_idx);
+        tag = "square_" + std::to_string((int)square_hz);
+    } else if (!chirp.empty()) {
+        std::size_t colon = chirp.find(':');
+        if (colon == std::string::npos) {
+            fprintf(stderr, "--chirp expects f0:f1\n");
+            return 1;
+        }
+        double f0 = std::stod(chirp.substr(0, colon)), f1 = std::stod(chirp.substr(colon + 1));
+        steps = chirp_trace(lo, hi, f0, f1, duration_sec, ram_clk_idx);
+        tag = "chirp_" + std::to_string((int)f0) + "-" + std::to_string((int)f1);
+    } else {
+        std::cerr << cmdParser.usage();
+        return 1;
+    }
+    if (steps.empty()) {
+        fprintf(stderr, "empty trace\n");
+        return 1;
+    }
+
+    if (dvfs.init_fd_cache() != 0) {
+        fprintf(stderr, "FD cache initialization failed. Are you root or authorized?\n");
+    }
+
+    const std::string log_path = joinPaths(cmdParser.get<std::string>("output"), "dvfs_player_" + tag + ".csv");
+    std::cout << "dvfs_player: device=" << device_name << ", steps=" << steps.size()
+              << ", length=" << steps.back().time_sec << "s, log=" << log_path << "\n";
+
+    TracePlayer player(dvfs);
+    player.set_spin_us(cmdParser.get<int>("spin"));
+    int failed = player.play(steps, log_path, &g_stop);
+
+    dvfs.unset_cpu_freq();
+    dvfs.unset_ram_freq();
+
+    if (failed < 0) return 1;
+    std::cout << "dvfs_player: done (" << failed << " failed steps).\n";
+    return failed == 0 ? 0 : 2;
+}
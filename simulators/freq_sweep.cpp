@@ -0,0 +1,288 @@
+// freq_sweep.cpp — (CPU, RAM) frequency sweep with a perf/W Pareto report
+// Runs one workload over prime cpu index x ram index points in a single process
+// (one DVFS init and fd cache), measuring throughput, battery power and
+// temperature per point, with a cool-down in between. With a platform_char
+// database of the device, the roofline of every point is printed too.
+// usage:
+//   ex) ./freq_sweep
+//       --device Pixel9         # specify phone type (default: Pixel9)
+//       --cpu-points 0:16:4     # prime cpu indices: all | a:b[:step] | i,j,k (default: all)
+//       --ram-points 0,5,11     # ram indices, same syntax (default: -1 [released])
+//       --cpu-map index,freq    # cluster mappings to compare [index | freq | capacity | efficient] (default: index)
+//       --volt-file volt.txt    # OPP voltages ("domain kHz uV" lines) on top of debugfs/devicetree (default: none)
+//       --workload burn         # burn | prefill | decode (default: burn)
+//       --kernel avx2           # burn: power-virus kernel [auto | scalar | sse2 | avx2 | avx512 | neon | sve] (default: auto)
+//       --threads 4             # workload threads (default: # of online CPUs)
+//       --measure 5             # seconds measured per point (default: 5)
+//       --warmup 1              # seconds run before measuring (default: 1)
+//       --cooldown 10           # seconds idle at the lowest OPPs between points (default: 10)
+//       --cooldown-temp 40      # or: cool down until below this temperature (default: -1 [off])
+//       --search                # search the energy-optimal point instead of the full grid
+//       --min-throughput 20     # search bound in workload units/s (default: 0 [off])
+//       --max-latency 50        # or: bound as ms per unit of work (ex. TPOT for decode)
+//       --replay sweep.csv      # run the search on a recorded sweep and compare with its optimum
+//       --output output/        # output directory path (default: output/)
+
+#include <atomic>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cmdline.h"
+#include "utils/util.hpp"
+#include "hardware/dvfs.h"
+#include "hardware/power_meter.h"
+#include "hardware/sweep.h"
+#include "workload/burn.h"
+#include "workload/llm_sim.h"
+#include "model/freq_search.h"
+#include "model/platform_db.h"
+
+static std::atomic<bool> g_stop{false};
+static void on_sigint(int) { g_stop.store(true, std::memory_order_relaxed); }
+
+// roofline of every measured point from the platform_char database: peak GFLOP/s and
+// read GB/s of the prime cluster at the point's clocks, machine balance, and, for
+// burn (kernel FLOP/s), the share of the peak reached
+static void print_roofline(const PlatformDb& db, const DVFS& dvfs, const std::vector<SweepPoint>& points,
+                           const BurnKernel* burn) {
+    const int policy = dvfs.get_cluster_indices().back();
+    const std::vector<int>& ddr = dvfs.get_ddr_freq();
+    const bool simd = !burn || std::string(burn->name) != "scalar";
+    for (const auto& p : points) {
+        if (p.rc != 0 || p.cpu_khz <= 0) continue;
+        const int ram_khz = p.ram_khz > 0 ? p.ram_khz : (ddr.empty() ? 0 : ddr.back()); // released: top OPP
+        const double peak = db.peak_gflops(policy, p.cpu_khz, simd);
+        const double bw = db.bandwidth_gbs(policy, p.cpu_khz, ram_khz, MemKernel::READ);
+        printf("[Roofline] cpu %2d ram %2d: peak %7.2f GFLOP/s, read %6.2f GB/s, balance %5.2f FLOP/B", p.cpu_idx,
+               p.ram_idx, peak, bw, bw > 0.0 ? peak / bw : NAN);
+        if (burn && peak > 0.0) printf(", %5.1f%% of peak", 100.0 * p.throughput / peak);
+        printf("\n");
+    }
+}
+
+int main(int argc, char** argv) {
+    std::signal(SIGINT, on_sigint);
+
+    cmdline::parser cmdParser;
+    cmdParser.add<std::string>("device", 0, "specify phone type [Pixel9 | S24 | auto] (default: Pixel9)", false, "Pixel9");
+    cmdParser.add<std::string>("cpu-points", 0, "prime cpu indices: all | a:b[:step] | i,j,k (default: all)", false, "all");
+    cmdParser.add<std::string>("ram-points", 0, "ram indices: all | a:b[:step] | i,j,k (default: -1 [released])", false, "-1");
+    cmdParser.add<std::string>("volt-file", 0, "OPP voltages for efficient without a kernel energy model (\"domain kHz uV\" lines)", false, "");
+    cmdParser.add<std::string>("cpu-map", 0, "cluster mappings to compare, comma-separated [index | freq | capacity | efficient] (default: index)", false, "index");
+    cmdParser.add<std::string>("workload", 'w', "burn | prefill | decode (default: burn)", false, "burn");
+    cmdParser.add<std::string>("kernel", 0, "burn: power-virus kernel [auto | scalar | sse2 | avx2 | avx512 | neon | sve] (default: auto [widest of the cpu])", false, "auto");
+    cmdParser.add<int>("threads", 't', "workload threads (default: # of online CPUs)", false, -1);
+    cmdParser.add<double>("measure", 0, "seconds measured per point (default: 5)", false, 5.0);
+    cmdParser.add<double>("warmup", 0, "seconds run before measuring (default: 1)", false, 1.0);
+    cmdParser.add<double>("cooldown", 0, "seconds idle at the lowest OPPs between points (default: 10)", false, 10.0);
+    cmdParser.add<double>("cooldown-temp", 0, "cool down until below this temperature in degC (default: -1 [off])", false, -1.0);
+    // dummy model (prefill / decode)
+    cmdParser.add<int>("num-layers", 'l', "the number of layers", false, 24);
+    cmdParser.add<int>("hidden-dim", 0, "hidden dimension", false, 256);
+    cmdParser.add<int>("ffn-size", 'f', "ffn dimension", false, 588);
+    cmdParser.add<int>("input-tokens", 'i', "prefill length", false, 64);
+    // search
+    cmdParser.add("search", 0, "search the energy-optimal point instead of measuring the full grid");
+    cmdParser.add<double>("min-throughput", 0, "search bound in workload units/s (default: 0 [off])", false, 0.0);
+    cmdParser.add<double>("max-latency", 0, "search bound in ms per unit of work (default: 0 [off])", false, 0.0);
+    cmdParser.add<std::string>("replay", 0, "search a recorded sweep csv and compare with its exhaustive optimum", false, "");
+    cmdParser.add<std::string>("output", 'o', "specify output directory path (default: output/)", false, "output/");
+    cmdParser.parse_check(argc, argv);
+
+    // throughput bound: a latency bound L (ms per unit) is 1000 / L units/s
+    double min_throughput = cmdParser.get<double>("min-throughput");
+    if (cmdParser.get<double>("max-latency") > 0.0) {
+        min_throughput = std::max(min_throughput, 1000.0 / cmdParser.get<double>("max-latency"));
+    }
+
+    // offline: search over recorded data, no DVFS needed
+    const std::string replay = cmdParser.get<std::string>("replay");
+    if (!replay.empty()) {
+        std::vector<SweepPoint> grid = load_sweep_csv(replay);
+        if (grid.empty()) return 1;
+        FreqSearch search(grid_axis(grid, true), grid_axis(grid, false), replay_eval(grid), min_throughput);
+        SearchResult r = search.run();
+        bool feasible = false;
+        SweepPoint opt = exhaustive_best(grid, min_throughput, &feasible);
+        const double opt_cost = search_cost(opt, min_throughput);
+
+        std::cout << search_report(r, min_throughput) << "\n";
+        printf("exhaustive: best (cpu %d, ram %d) %.3f/s at %.2f W -> %.4g J/unit%s, %zu points\n",
+               opt.cpu_idx, opt.ram_idx, opt.throughput, opt.power_w, search_cost(opt, 0.0),
+               feasible ? "" : " [bound not met]", grid.size());
+        printf("gap: %.2f%% energy per unit (%s)\n", 100.0 * (r.cost / opt_cost - 1.0),
+               (r.best.cpu_idx == opt.cpu_idx && r.best.ram_idx == opt.ram_idx) ? "same point" : "different point");
+        return 0;
+    }
+
+    const std::string device_name = cmdParser.get<std::string>("device");
+    const std::string workload_name = cmdParser.get<std::string>("workload");
+    int threads = cmdParser.get<int>("threads");
+    if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    DVFS dvfs(device_name);
+    dvfs.load_freq_tables();
+    const std::vector<int>& clusters = dvfs.get_cluster_indices();
+    if (clusters.empty() || dvfs.get_cpu_freq().count(clusters.back()) == 0) {
+        fprintf(stderr, "no cpu OPP table for %s\n", device_name.c_str());
+        return 1;
+    }
+    if (dvfs.init_fd_cache() != 0) {
+        fprintf(stderr, "FD cache initialization failed. Are you root or authorized?\n");
+        return 1;
+    }
+
+    SweepConfig cfg;
+    if (parse_sweep_points(cmdParser.get<std::string>("cpu-points"), (int)dvfs.get_cpu_freq().at(clusters.back()).size() - 1,
+                           false, cfg.cpu_points) != 0) {
+        std::cerr << "invalid --cpu-points: " << cmdParser.get<std::string>("cpu-points") << "\n" << cmdParser.usage();
+        return 1;
+    }
+    if (parse_sweep_points(cmdParser.get<std::string>("ram-points"), (int)dvfs.get_ddr_freq().size() - 1, true,
+                           cfg.ram_points) != 0) {
+        std::cerr << "invalid --ram-points: " << cmdParser.get<std::string>("ram-points") << "\n" << cmdParser.usage();
+        return 1;
+    }
+    cfg.measure_sec = cmdParser.get<double>("measure");
+    cfg.warmup_sec = cmdParser.get<double>("warmup");
+    cfg.cooldown_sec = cmdParser.get<double>("cooldown");
+    cfg.cooldown_temp_c = cmdParser.get<double>("cooldown-temp");
+
+    // workload
+    SweepWorkload workload;
+    const BurnKernel* burn_kernel = nullptr; // burn only
+    std::string unit;
+    std::string workload_desc = workload_name;
+    LlmWeights weights;
+    if (workload_name == "burn") {
+        // the kernel cpu_burner runs with the same --kernel
+        const BurnKernel* kernel = find_burn_kernel(cmdParser.get<std::string>("kernel"));
+        if (!kernel) {
+            std::cerr << "kernel not available on this cpu: " << cmdParser.get<std::string>("kernel") << " (available:";
+            for (const auto& k : burn_kernels()) std::cerr << " " << k.name;
+            std::cerr << ")\n";
+            return 1;
+        }
+        workload = [kernel, threads](double sec, const std::atomic<bool>* stop) {
+            return kernel_flops_for(*kernel, threads, sec, {}, stop);
+        };
+        burn_kernel = kernel;
+        unit = "GFLOP/s";
+        workload_desc += std::string(" (") + kernel->name + ")";
+    } else if (workload_name == "prefill" || workload_name == "decode") {
+        weights = random_weights(cmdParser.get<int>("hidden-dim"), cmdParser.get<int>("ffn-size"));
+        const int layers = cmdParser.get<int>("num-layers");
+        const int seq_len = cmdParser.get<int>("input-tokens");
+        if (workload_name == "prefill") {
+            workload = [&, layers, seq_len, threads](double sec, const std::atomic<bool>* stop) {
+                return llm_prefill_for(weights, layers, seq_len, threads, sec, stop);
+            };
+        } else {
+            workload = [&, layers, threads](double sec, const std::atomic<bool>* stop) {
+                return llm_decode_for(weights, layers, threads, sec, stop);
+            };
+        }
+        unit = "tok/s";
+    } else {
+        fprintf(stderr, "unknown workload: %s\n", workload_name.c_str());
+        return 1;
+    }
+
+    Collector collector = dvfs.get_collector();
+    if (collector.open_thermal() == 0) fprintf(stderr, "no cpu thermal zone: temperatures read as 0\n");
+    PowerMeter meter;
+    PowerMeter* meter_ptr = (meter.open() == 0) ? &meter : nullptr;
+    if (!meter_ptr) fprintf(stderr, "battery power not readable: perf/W and Pareto use throughput only\n");
+
+    std::cout << "freq_sweep: device=" << device_name << ", workload=" << workload_desc
+              << ", threads=" << threads << ", points=" << cfg.cpu_points.size() * cfg.ram_points.size() << "\n";
+
+    // cluster mappings to compare (one sweep or search each)
+    std::vector<CpuMap> maps;
+    {
+        std::stringstream ss(cmdParser.get<std::string>("cpu-map"));
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            CpuMap m;
+            if (!cpu_map_from_name(item, m) || m == CpuMap::OVERRIDE) {
+                fprintf(stderr, "unknown --cpu-map: %s\n", item.c_str());
+                return 1;
+            }
+            maps.push_back(m);
+        }
+    }
+    for (CpuMap m : maps) {
+        if (m == CpuMap::EFFICIENT && dvfs.load_voltages(cmdParser.get<std::string>("volt-file")) < 0) return 1;
+        if (m == CpuMap::EFFICIENT && dvfs.load_energy_model() == 0) {
+            fprintf(stderr, "no energy model (debugfs) or OPP voltages: efficient falls back to freq\n");
+        }
+    }
+
+    // roofline per point when platform_char has characterized this device
+    PlatformDb platform;
+    const bool has_platform = platform.load(platform_db_path(device_name), device_name) == 0;
+    if (has_platform) std::cout << platform.describe() << "\n";
+
+    FreqSweep sweep(dvfs, collector, meter_ptr, cfg);
+    std::vector<std::string> summary;
+    for (CpuMap m : maps) {
+        if (g_stop.load(std::memory_order_relaxed)) break;
+        dvfs.set_cpu_map(m);
+        if (maps.size() > 1) std::cout << "=== cpu map: " << cpu_map_name(m) << " ===\n";
+
+        std::vector<SweepPoint> points;
+        if (cmdParser.exist("search")) {
+            // measure on demand, cool down after every point
+            FreqSearch search(cfg.cpu_points, cfg.ram_points, [&](int cpu, int ram) {
+                SweepPoint p = sweep.measure(cpu, ram, workload, &g_stop);
+                printf("[Search] cpu %d ram %d: %.3f/s, %.2f W, %.1f C\n", cpu, ram, p.throughput, p.power_w, p.temp_max_c);
+                fflush(stdout);
+                sweep.cool_down(&g_stop);
+                return p;
+            }, min_throughput);
+            SearchResult r = search.run();
+            points = r.visited;
+            mark_pareto(points);
+            std::cout << search_report(r, min_throughput) << "\n";
+        } else {
+            points = sweep.run(workload, &g_stop);
+        }
+
+        std::cout << sweep_table(points, unit);
+        if (has_platform) print_roofline(platform, dvfs, points, burn_kernel);
+        const std::string csv = joinPaths(cmdParser.get<std::string>("output"),
+                                          (cmdParser.exist("search") ? "freq_search_" : "freq_sweep_") + workload_name +
+                                          (m == CpuMap::INDEX ? "" : std::string("_") + cpu_map_name(m)) + ".csv");
+        if (write_sweep_csv(csv, points) != 0) return 1;
+
+        // best perf/W of this mapping (fastest point without power readings)
+        const SweepPoint* best = nullptr;
+        for (const auto& p : points) {
+            if (p.rc != 0) continue;
+            const double v = meter_ptr ? p.perf_per_watt : p.throughput;
+            if (!best || v > (meter_ptr ? best->perf_per_watt : best->throughput)) best = &p;
+        }
+        char line[256];
+        if (best) {
+            snprintf(line, sizeof(line), "%-10s best (cpu %d, ram %d): %.3f %s, %.2f W, %.3f per W (%s)",
+                     cpu_map_name(m), best->cpu_idx, best->ram_idx, best->throughput, unit.c_str(),
+                     best->power_w, best->perf_per_watt, csv.c_str());
+        } else {
+            snprintf(line, sizeof(line), "%-10s no valid point", cpu_map_name(m));
+        }
+        summary.push_back(line);
+    }
+
+    dvfs.unset_cpu_freq();
+    dvfs.unset_ram_freq();
+
+    for (const auto& line : summary) std::cout << line << "\n";
+    std::cout << "freq_sweep: done.\n";
+    return 0;
+}
@@ -0,0 +1,179 @@
+// gov_sim.cpp — offline governor evaluation over utilization traces
+// Replays a recorded (kernel_hard logs) or synthetic utilization trace through
+// governor policies x sampling periods x rate limits on the device OPP tables,
+// with a power_fit model and an optional thermo_sim network, in parallel on a
+// work-stealing pool. Reports energy, deadline misses and temperatures per
+// configuration. Runs offline: no root and no sysfs writes.
+// usage:
+//   ex) ./gov_sim
+//       --device Pixel9         # specify phone type (default: Pixel9)
+//       --power-model auto      # power_fit model [auto | path] (default: auto)
+//       --net auto              # thermo_sim network [auto | none | path] (default: auto)
+//       --trace a.txt,b.txt     # kernel_hard logs to replay (default: synthetic)
+//       --synth frames          # synthetic trace [frames | bursty | ramp] (default: frames)
+//       --seconds 60            # synthetic trace length (default: 60)
+//       --step-ms 1             # simulation step in ms (default: 1)
+//       --governors schedutil:1.1,schedutil:1.25,ondemand # policies, name[:param] (default: schedutil,ondemand)
+//       --periods 2,4,8         # sampling periods in ms (default: 4)
+//       --rate-limits 0,10      # rate limits in ms (default: 10)
+//       --deadline-ms 16.7      # work older than this is a miss (default: 16.7)
+//       --ram-clock 11          # fixed ram index (default: -1 [highest in the model])
+//       --max-miss 0.01         # miss ratio bound for the best configuration (default: 0.01)
+//       --threads 8             # worker threads (default: # of online CPUs)
+//       --output output/        # output directory path (default: output/)
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "cmdline.h"
+#include "utils/util.hpp"
+#include "hardware/dvfs.h"
+#include "hardware/governor.h"
+#include "model/power_model.h"
+#include "model/thermal_sim.h"
+#include "model/gov_sim.h"
+
+static std::vector<std::string> split_list(const std::string& s) {
+    std::vector<std::string> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) out.push_back(item);
+    }
+    return out;
+}
+
+int main(int argc, char** argv) {
+    cmdline::parser cmdParser;
+    cmdParser.add<std::string>("device", 0, "specify phone type [Pixel9 | S24 | auto] (default: Pixel9)", false, "Pixel9");
+    cmdParser.add<std::string>("power-model", 0, "power_fit model, auto: the device cache (default: auto)", false, "auto");
+    cmdParser.add<std::string>("net", 0, "thermo_sim network, auto: the device cache, none: no temperatures (default: auto)", false, "auto");
+    cmdParser.add<std::string>("trace", 0, "kernel_hard logs to replay, comma-separated (default: synthetic)", false, "");
+    cmdParser.add<std::string>("synth", 0, "synthetic trace [frames | bursty | ramp] (default: frames)", false, "frames");
+    cmdParser.add<double>("seconds", 0, "synthetic trace length in seconds (default: 60)", false, 60.0);
+    cmdParser.add<double>("step-ms", 0, "simulation step in ms (default: 1)", false, 1.0);
+    cmdParser.add<int>("seed", 0, "synthetic trace seed (default: 1)", false, 1);
+    cmdParser.add<std::string>("governors", 'g', "policies, name[:param] comma-separated (default: schedutil,ondemand)", false, "schedutil,ondemand");
+    cmdParser.add<std::string>("periods", 0, "sampling periods in ms, comma-separated (default: 4)", false, "4");
+    cmdParser.add<std::string>("rate-limits", 0, "rate limits in ms, comma-separated (default: 10)", false, "10");
+    cmdParser.add<double>("deadline-ms", 0, "work older than this is a deadline miss (default: 16.7)", false, 16.7);
+    cmdParser.add<int>("ram-clock", 'r', "fixed ram index (default: -1 [highest in the model])", false, -1);
+    cmdParser.add<double>("max-miss", 0, "miss ratio bound for the best configuration (default: 0.01)", false, 0.01);
+    cmdParser.add<int>("threads", 't', "worker threads (default: # of online CPUs)", false, -1);
+    cmdParser.add<std::string>("output", 'o', "specify output directory path (default: output/)", false, "output/");
+    cmdParser.parse_check(argc, argv);
+
+    const std::string device_name = cmdParser.get<std::string>("device");
+    DVFS dvfs(device_name);
+    dvfs.load_freq_tables();
+
+    std::string model_path = cmdParser.get<std::string>("power-model");
+    if (model_path == "auto") model_path = power_model_path(device_name);
+    PowerModel model;
+    if (model.load(model_path, device_name) != 0) {
+        fprintf(stderr, "power model not loadable for %s: %s (run power_fit first)\n", device_name.c_str(), model_path.c_str());
+        return 1;
+    }
+    ThermalNetwork net;
+    const ThermalNetwork* net_ptr = nullptr;
+    std::string net_path = cmdParser.get<std::string>("net");
+    if (net_path != "none") {
+        if (net_path == "auto") net_path = thermal_net_path(device_name);
+        if (net.load(net_path, device_name) == 0) net_ptr = &net;
+        else fprintf(stderr, "no thermal network for %s (%s): temperatures not simulated\n", device_name.c_str(), net_path.c_str());
+    }
+
+    // trace
+    const double step_s = std::max(0.0001, cmdParser.get<double>("step-ms") / 1000.0);
+    UtilTrace trace;
+    std::string trace_name;
+    if (!cmdParser.get<std::string>("trace").empty()) {
+        std::vector<PowerObs> obs;
+        for (const std::string& path : split_list(cmdParser.get<std::string>("trace"))) {
+            if (load_hard_log(path, dvfs, obs) < 0) {
+                fprintf(stderr, "%s: not a kernel_hard log\n", path.c_str());
+                return 1;
+            }
+        }
+        trace = util_trace_from_obs(obs, dvfs, step_s);
+        trace_name = "recorded";
+    } else {
+        trace_name = cmdParser.get<std::string>("synth");
+        trace = synth_util_trace(dvfs, trace_name, cmdParser.get<double>("seconds"), step_s,
+                                 (unsigned)cmdParser.get<int>("seed"));
+    }
+    if (trace.work.empty()) {
+        fprintf(stderr, "empty trace (%s)\n", trace_name.c_str());
+        return 1;
+    }
+
+    // configurations: governors x periods x rate limits
+    std::vector<GovSimConfig> cfgs;
+    for (const std::string& g : split_list(cmdParser.get<std::string>("governors"))) {
+        GovPolicy policy = gov_policy_by_name(g);
+        if (!policy) {
+            fprintf(stderr, "unknown governor: %s\n", g.c_str());
+            return 1;
+        }
+        for (const std::string& p : split_list(cmdParser.get<std::string>("periods"))) {
+            for (const std::string& rl : split_list(cmdParser.get<std::string>("rate-limits"))) {
+                GovSimConfig c;
+                c.name = g;
+                c.policy = policy;
+                c.period_us = (int)(std::stod(p) * 1000);
+                c.rate_limit_us = (int)(std::stod(rl) * 1000);
+                c.ram_idx = cmdParser.get<int>("ram-clock");
+                c.deadline_ms = cmdParser.get<double>("deadline-ms");
+                cfgs.push_back(c);
+            }
+        }
+    }
+
+    GovSim sim(dvfs, model, net_ptr);
+    long steals = 0;
+    const auto t0 = std::chrono::steady_clock::now();
+    std::vector<GovSimResult> res = sim.sweep(trace, cfgs, cmdParser.get<int>("threads"), &steals);
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    printf("gov_sim: %s trace, %.1f s in %zu steps, %zu configurations in %.3f s (%.1f/s, %ld steals)\n",
+           trace_name.c_str(), trace.work.size() * trace.step_s, trace.work.size(), cfgs.size(), sec,
+           cfgs.size() / sec, steals);
+
+    // lowest energy first; configurations within the miss bound marked
+    const double max_miss = cmdParser.get<double>("max-miss");
+    std::vector<std::size_t> order(cfgs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return res[a].energy_j < res[b].energy_j; });
+    printf("%-18s %6s %6s %10s %7s %8s %8s %8s %7s %7s\n", "governor", "period", "limit", "energy_j", "avg_w",
+           "miss_%", "changes", "mean_mhz", "peak_c", "ok");
+    for (std::size_t i : order) {
+        const GovSimConfig& c = cfgs[i];
+        const GovSimResult& r = res[i];
+        printf("%-18s %6.1f %6.1f %10.2f %7.3f %8.3f %8ld %8.0f %7.2f %7s\n", c.name.c_str(), c.period_us / 1e3,
+               c.rate_limit_us / 1e3, r.energy_j, r.avg_w, 100.0 * r.miss_ratio, r.changes, r.mean_mhz, r.peak_c,
+               r.miss_ratio <= max_miss ? "*" : "");
+    }
+
+    const std::string csv = joinPaths(cmdParser.get<std::string>("output"), std::string("gov_sim_") + trace_name + ".csv");
+    std::ofstream f(csv);
+    if (!f) {
+        fprintf(stderr, "cannot write %s\n", csv.c_str());
+        return 1;
+    }
+    f << "governor,period_ms,rate_limit_ms,energy_j,avg_w,misses,miss_ratio,changes,mean_mhz,peak_c,end_c\n";
+    for (std::size_t i = 0; i < cfgs.size(); ++i) {
+        const GovSimConfig& c = cfgs[i];
+        const GovSimResult& r = res[i];
+        f << c.name << "," << c.period_us / 1e3 << "," << c.rate_limit_us / 1e3 << "," << r.energy_j << "," << r.avg_w
+          << "," << r.misses << "," << r.miss_ratio << "," << r.changes << "," << r.mean_mhz << "," << r.peak_c << ","
+          << r.end_c << "\n";
+    }
+    printf("saved: %s\n", csv.c_str());
+    return 0;
+}
@@ -0,0 +1,281 @@
+// platform_char.cpp — platform characterization: peak FLOP/s and bandwidth per OPP
+// Measures sustained scalar / SIMD GFLOP/s per cluster OPP and read / write /
+// copy GB/s per cluster OPP x RAM OPP with the burner kernels (threads pinned
+// to the cluster), and stores them in a versioned per-device database that
+// other tools look up (machine balance) instead of measuring again.
+// usage:
+//   ex) ./platform_char
+//       --device Pixel9         # specify phone type (default: Pixel9)
+//       --clusters 4,7          # cpufreq policies to measure (default: all)
+//       --cpu-points 0:16:4     # OPP indices per cluster: all | a:b[:step] | i,j,k (default: all)
+//       --ram-points 0,5,11     # ram indices, same syntax (default: all)
+//       --seconds 0.5           # seconds per kernel and point (default: 0.5)
+//       --threads 2             # threads per cluster (default: -1 [every cpu of the cluster])
+//       --buffer-mb 64          # buffer per thread of the memory kernels (default: 64)
+//       --no-mem                # FLOP/s only
+//       --append                # keep the other points of an existing database
+//       --show                  # print the database and its balance table, no measurement
+//       --kernels               # GFLOP/s and battery power of every power-virus kernel per cluster, no database
+//       --kernel-sec 5          # seconds per kernel of --kernels (default: 5)
+//       --output db.txt         # database path (default: $DDS_CACHE_DIR or $HOME/.dds_platform_<device>.txt)
+
+#include <atomic>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <chrono>
+#include <thread>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <sys/utsname.h>
+
+#include "cmdline.h"
+#include "hardware/dvfs.h"
+#include "hardware/power_meter.h"
+#include "hardware/sweep.h"
+#include "hardware/topology.h"
+#include "workload/burn.h"
+#include "model/platform_db.h"
+
+static std::atomic<bool> g_stop{false};
+static void on_sigint(int) { g_stop.store(true, std::memory_order_relaxed); }
+
+// machine balance (FLOP/B) of every cluster OPP x ram OPP of the database
+static void print_balance(const PlatformDb& db, const DVFS& dvfs) {
+    const std::vector<int>& ddr = dvfs.get_ddr_freq();
+    for (int slot = 0; slot < (int)dvfs.get_cluster_indices().size(); ++slot) {
+        const int policy = dvfs.get_cluster_indices()[slot];
+        if (std::isnan(db.peak_gflops(policy, 0)) || std::isnan(db.bandwidth_gbs(policy, 0, 0))) continue;
+        printf("balance policy%d (FLOP/B, SIMD GFLOP/s / read GB/s)\n%9s", policy, "cpu\\ram");
+        for (int r = 0; r < (int)ddr.size(); ++r) printf(" %6d", r);
+        printf("\n");
+        const std::vector<int>& ct = dvfs.get_cpu_freq().at(policy);
+        for (int c = 0; c < (int)ct.size(); ++c) {
+            printf("%4d %4d", c, ct[c] / 1000);
+            for (int r = 0; r < (int)ddr.size(); ++r) printf(" %6.2f", db.balance(dvfs, slot, c, r));
+            printf("\n");
+        }
+    }
+}
+
+// sustained GFLOP/s and battery power of every power-virus kernel, per cluster at its top OPP
+static int report_kernels(DVFS& dvfs, const std::vector<int>& slots, int threads_opt, double seconds) {
+    using namespace std::chrono_literals;
+    PowerMeter meter("battery", (int)(seconds * 1000) + 1000); // window over the whole run
+    const bool has_meter = meter.open() == 0;
+    if (!has_meter) fprintf(stderr, "battery power not readable: GFLOP/s only\n");
+    if (!dvfs.fd_cache_enabled()) fprintf(stderr, "clocks not pinned: kernels run at the governor clocks\n");
+
+    auto average_w = [&](const std::atomic<bool>& done) {
+        meter.reset();
+        while (!done.load()) {
+            if (has_meter) meter.sample();
+            std::this_thread::sleep_for(100ms);
+        }
+        return has_meter ? meter.get_watts() : NAN;
+    };
+
+    printf("%-8s %-7s %6s %8s %9s %7s %7s %8s\n", "policy", "kernel", "MHz", "threads", "GFLOP/s", "W", "idle_W", "GFLOP/J");
+    for (int slot : slots) {
+        const int policy = dvfs.get_cluster_indices()[slot];
+        std::vector<int> cpus;
+        for (const auto& c : Topology::system().get_clusters()) {
+            if (c.policy == policy) cpus = c.cpus;
+        }
+        const int threads = threads_opt > 0 ? threads_opt : std::max(1, (int)cpus.size());
+        const std::vector<int>& table = dvfs.get_cpu_freq().at(policy);
+        if (dvfs.fd_cache_enabled()) dvfs.set_cluster_freq(slot, (int)table.size() - 1);
+
+        std::atomic<bool> done{false};
+        std::thread idle([&] { std::this_thread::sleep_for(std::chrono::duration<double>(std::min(seconds, 2.0))); done = true; });
+        const double idle_w = average_w(done);
+        idle.join();
+
+        for (const auto& k : burn_kernels()) {
+            if (g_stop.load(std::memory_order_relaxed)) break;
+            double gflops = 0.0;
+            done = false;
+            std::thread run([&] {
+                gflops = kernel_flops_for(k, threads, seconds, cpus, &g_stop);
+                done = true;
+            });
+            const double w = average_w(done);
+            run.join();
+            const int mhz = dvfs.fd_cache_enabled() ? dvfs.get_cur_cpu_freq(slot) / 1000 : -1;
+            // energy per FLOP above idle
+            printf("policy%-2d %-7s %6d %8d %9.2f %7.3f %7.3f %8.2f\n", policy, k.name, mhz, threads, gflops, w, idle_w,
+                   w > idle_w ? gflops / (w - idle_w) : NAN);
+            fflush(stdout);
+        }
+        if (dvfs.fd_cache_enabled()) dvfs.unset_cpu_freq();
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    std::signal(SIGINT, on_sigint);
+
+    cmdline::parser cmdParser;
+    cmdParser.add<std::string>("device", 0, "specify phone type [Pixel9 | S24 | auto] (default: Pixel9)", false, "Pixel9");
+    cmdParser.add<std::string>("clusters", 0, "cpufreq policies to measure, comma-separated (default: all)", false, "all");
+    cmdParser.add<std::string>("cpu-points", 0, "OPP indices per cluster: all | a:b[:step] | i,j,k (default: all)", false, "all");
+    cmdParser.add<std::string>("ram-points", 0, "ram indices: all | a:b[:step] | i,j,k (default: all)", false, "all");
+    cmdParser.add<double>("seconds", 0, "seconds per kernel and point (default: 0.5)", false, 0.5);
+    cmdParser.add<int>("threads", 't', "threads per cluster (default: -1 [every cpu of the cluster])", false, -1);
+    cmdParser.add<int>("buffer-mb", 0, "buffer per thread of the memory kernels in MB (default: 64)", false, 64);
+    cmdParser.add("no-mem", 0, "measure FLOP/s only");
+    cmdParser.add("append", 0, "keep the other points of an existing database");
+    cmdParser.add("show", 0, "print the database and its balance table, no measurement");
+    cmdParser.add("kernels", 0, "GFLOP/s and battery power of every power-virus kernel per cluster, no database");
+    cmdParser.add<double>("kernel-sec", 0, "seconds per kernel of --kernels (default: 5)", false, 5.0);
+    cmdParser.add<std::string>("output", 'o', "database path (default: $DDS_CACHE_DIR or $HOME/.dds_platform_<device>.txt)", false, "");
+    cmdParser.parse_check(argc, argv);
+
+    const std::string device_name = cmdParser.get<std::string>("device");
+    std::string db_path = cmdParser.get<std::string>("output");
+    if (db_path.empty()) db_path = platform_db_path(device_name);
+
+    DVFS dvfs(device_name);
+    dvfs.load_freq_tables();
+
+    PlatformDb db;
+    const int load_rc = db.load(db_path, device_name);
+    if (cmdParser.exist("show")) {
+        if (load_rc != 0) {
+            fprintf(stderr, "no platform db for %s: %s (%s)\n", device_name.c_str(), db_path.c_str(),
+                    load_rc == -3 ? "other version, measure again" : "run platform_char first");
+            return 1;
+        }
+        std::cout << db.describe() << "\n";
+        print_balance(db, dvfs);
+        return 0;
+    }
+    if (!cmdParser.exist("append") || load_rc != 0) {
+        if (cmdParser.exist("append") && load_rc == -3) fprintf(stderr, "%s: other version, starting over\n", db_path.c_str());
+        db = PlatformDb();
+    }
+
+    // clusters to measure and their cpus
+    const Topology& topo = Topology::system();
+    const std::vector<int>& clusters = dvfs.get_cluster_indices();
+    std::vector<int> slots;
+    for (int slot = 0; slot < (int)clusters.size(); ++slot) {
+        const std::string spec = cmdParser.get<std::string>("clusters");
+        bool wanted = spec == "all";
+        std::stringstream ss(spec);
+        std::string item;
+        while (!wanted && std::getline(ss, item, ',')) wanted = std::atoi(item.c_str()) == clusters[slot];
+        if (wanted && dvfs.get_cpu_freq().count(clusters[slot])) slots.push_back(slot);
+    }
+    if (slots.empty()) {
+        fprintf(stderr, "no cluster to measure for %s\n", device_name.c_str());
+        return 1;
+    }
+    if (dvfs.init_fd_cache() != 0) {
+        fprintf(stderr, "FD cache initialization failed. Are you root or authorized?\n");
+        if (!cmdParser.exist("kernels")) return 1;
+    }
+    if (cmdParser.exist("kernels")) return report_kernels(dvfs, slots, cmdParser.get<int>("threads"), cmdParser.get<double>("kernel-sec"));
+
+    struct utsname u;
+    db.device = device_name;
+    db.kernel = uname(&u) == 0 ? u.release : "";
+    db.threads = cmdParser.get<int>("threads") > 0 ? cmdParser.get<int>("threads") : 0;
+    db.seconds = cmdParser.get<double>("seconds");
+    db.buffer_kb = (long)cmdParser.get<int>("buffer-mb") * 1024;
+    const std::size_t buffer = (std::size_t)db.buffer_kb * 1024;
+    std::vector<int> ram_points;
+    if (!cmdParser.exist("no-mem") &&
+        parse_sweep_points(cmdParser.get<std::string>("ram-points"), (int)dvfs.get_ddr_freq().size() - 1, false,
+                           ram_points) != 0) {
+        std::cerr << "invalid --ram-points: " << cmdParser.get<std::string>("ram-points") << "\n" << cmdParser.usage();
+        return 1;
+    }
+
+    for (int slot : slots) {
+        const int policy = clusters[slot];
+        std::vector<int> cpus;
+        for (const auto& c : topo.get_clusters()) {
+            if (c.policy == policy) cpus = c.cpus;
+        }
+        if (cpus.empty()) {
+            fprintf(stderr, "policy%d: cpus unknown (topology), threads not pinned\n", policy);
+        }
+        const int threads = db.threads > 0 ? db.threads : std::max(1, (int)cpus.size());
+        const std::vector<int>& table = dvfs.get_cpu_freq().at(policy);
+        std::vector<int> cpu_points;
+        if (parse_sweep_points(cmdParser.get<std::string>("cpu-points"), (int)table.size() - 1, false, cpu_points) != 0) {
+            std::cerr << "invalid --cpu-points: " << cmdParser.get<std::string>("cpu-points") << "\n" << cmdParser.usage();
+            return 1;
+        }
+        printf("=== policy%d: %d threads on %zu cpus, %zu OPPs x %zu ram OPPs ===\n", policy, threads, cpus.size(),
+               table.size(), ram_points.size());
+
+        for (int idx : cpu_points) {
+            if (g_stop.load(std::memory_order_relaxed)) break;
+            // 6: clamped by a kernel limit, measured at the clock it runs at
+            const int set_rc = idx < 0 ? 3 : dvfs.set_cluster_freq(slot, idx);
+            if (set_rc != 0 && set_rc != 6) {
+                fprintf(stderr, "policy%d: OPP %d not applied (rc %d), skipped\n", policy, idx, set_rc);
+                continue;
+            }
+            dvfs.unset_ram_freq();
+            const int cur = dvfs.get_cur_cpu_freq(slot);
+            if (cur > 0 && cur != table[idx]) {
+                fprintf(stderr, "policy%d: running at %d kHz instead of %d (throttled?)\n", policy, cur, table[idx]);
+            }
+
+            ComputePeak cp;
+            cp.policy = policy;
+            cp.khz = cur > 0 ? cur : table[idx];
+            cp.scalar_gflops = flops_for(FlopKernel::SCALAR, threads, db.seconds, cpus, &g_stop);
+            cp.simd_gflops = flops_for(FlopKernel::SIMD, threads, db.seconds, cpus, &g_stop);
+            if (g_stop.load(std::memory_order_relaxed)) break;
+            db.put(cp);
+            printf("[Char] policy%d %4d MHz: scalar %7.2f, simd %7.2f GFLOP/s\n", policy, cp.khz / 1000,
+                   cp.scalar_gflops, cp.simd_gflops);
+
+            for (int r : ram_points) {
+                if (g_stop.load(std::memory_order_relaxed)) break;
+                const int ram_rc = r < 0 ? 1 : dvfs.set_ram_freq(r);
+                if (ram_rc != 0 && ram_rc != 6) {
+                    fprintf(stderr, "ram OPP %d not applied (rc %d), skipped\n", r, ram_rc);
+                    continue;
+                }
+                const int ram_cur = dvfs.get_cur_ram_freq();
+                MemPeak mp;
+                mp.policy = policy;
+                mp.cpu_khz = cp.khz;
+                mp.ram_khz = ram_rc == 6 && ram_cur > 0 ? ram_cur : dvfs.get_ddr_freq()[r];
+                mp.read_gbs = membw_for(MemKernel::READ, threads, db.seconds, buffer, cpus, &g_stop);
+                mp.write_gbs = membw_for(MemKernel::WRITE, threads, db.seconds, buffer, cpus, &g_stop);
+                mp.copy_gbs = membw_for(MemKernel::COPY, threads, db.seconds, buffer, cpus, &g_stop);
+                if (g_stop.load(std::memory_order_relaxed)) break;
+                db.put(mp);
+                printf("[Char] policy%d %4d MHz ram %4d MHz: read %6.2f, write %6.2f, copy %6.2f GB/s, balance %.2f FLOP/B\n",
+                       policy, mp.cpu_khz / 1000, mp.ram_khz / 1000, mp.read_gbs, mp.write_gbs, mp.copy_gbs,
+                       mp.read_gbs > 0.0 ? cp.simd_gflops / mp.read_gbs : 0.0);
+            }
+            fflush(stdout);
+        }
+        dvfs.unset_cpu_freq();
+    }
+    dvfs.unset_cpu_freq();
+    dvfs.unset_ram_freq();
+
+    if (db.empty()) {
+        fprintf(stderr, "nothing measured\n");
+        return 1;
+    }
+    if (db.save(db_path) != 0) {
+        fprintf(stderr, "cannot write %s\n", db_path.c_str());
+        return 1;
+    }
+    std::cout << db.describe() << "\n";
+    std::cout << "saved: " << db_path << (g_stop.load() ? " (interrupted)" : "") << "\n";
+    return 0;
+}
@@ -0,0 +1,77 @@
+// power_fit.cpp — per-cluster power model from kernel_hard logs
+// Fits P = sum(dyn x util x V^2 x f + leak x V + leak_t x V x (T - 25)) + mif[ram idx]
+// on the rows of one or more kernel_hard logs (cpu_burner / dummy_test runs) and
+// saves it per device for the controllers (cpu_burner --power-model).
+// Runs offline: no root and no sysfs writes.
+// usage:
+//   ex) ./power_fit
+//       --device Pixel9         # specify phone type (default: Pixel9)
+//       --input a.txt,b.txt     # kernel_hard logs, comma-separated (required)
+//       --output model.txt      # model path (default: $DDS_CACHE_DIR or $HOME/.dds_power_<device>.txt)
+//       --volt-file volt.txt    # OPP voltages ("domain kHz uV" lines) on top of debugfs/devicetree (default: none)
+//       --holdout 5             # validate on every 5th row, fit on the others (default: 0 [off])
+
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "cmdline.h"
+#include "hardware/dvfs.h"
+#include "model/power_model.h"
+
+int main(int argc, char** argv) {
+    cmdline::parser cmdParser;
+    cmdParser.add<std::string>("device", 0, "specify phone type [Pixel9 | S24 | auto] (default: Pixel9)", false, "Pixel9");
+    cmdParser.add<std::string>("input", 'i', "kernel_hard logs, comma-separated", true, "");
+    cmdParser.add<std::string>("output", 'o', "model path (default: $DDS_CACHE_DIR or $HOME/.dds_power_<device>.txt)", false, "");
+    cmdParser.add<std::string>("volt-file", 0, "OPP voltages (\"domain kHz uV\" lines) on top of debugfs/devicetree", false, "");
+    cmdParser.add<int>("holdout", 0, "validate on every Nth row, fit on the others (default: 0 [off])", false, 0);
+    cmdParser.parse_check(argc, argv);
+
+    const std::string device_name = cmdParser.get<std::string>("device");
+    DVFS dvfs(device_name);
+    dvfs.load_freq_tables();
+    if (dvfs.load_voltages(cmdParser.get<std::string>("volt-file")) < 0) return 1;
+
+    std::vector<PowerObs> obs;
+    std::stringstream ss(cmdParser.get<std::string>("input"));
+    std::string path;
+    while (std::getline(ss, path, ',')) {
+        const int rows = load_hard_log(path, dvfs, obs);
+        if (rows < 0) {
+            fprintf(stderr, "%s: %s\n", path.c_str(), rows == -1 ? "not readable" : "missing columns (cpu<p>_cur_freq, current_now, voltage_now, cur_freq)");
+            return 1;
+        }
+        printf("%s: %d rows\n", path.c_str(), rows);
+    }
+
+    // every Nth row held out for validation
+    const int holdout = cmdParser.get<int>("holdout");
+    std::vector<PowerObs> train, test;
+    for (std::size_t i = 0; i < obs.size(); ++i) {
+        if (holdout > 1 && i % holdout == (std::size_t)holdout - 1) test.push_back(obs[i]);
+        else train.push_back(obs[i]);
+    }
+
+    PowerModel model;
+    const int rc = fit_power_model(train, dvfs, model);
+    if (rc != 0) {
+        fprintf(stderr, "fit failed (%s)\n", rc == 1 ? "too few rows" : "degenerate data: sweep more OPPs");
+        return 1;
+    }
+    std::cout << model.describe() << "\n";
+    if (!test.empty()) {
+        printf("validation: %zu rows, rmse %.4f W\n", test.size(), power_model_rmse(model, test));
+    }
+
+    std::string out = cmdParser.get<std::string>("output");
+    if (out.empty()) out = power_model_path(device_name);
+    if (model.save(out) != 0) {
+        fprintf(stderr, "cannot write %s\n", out.c_str());
+        return 1;
+    }
+    printf("saved: %s\n", out.c_str());
+    return 0;
+}
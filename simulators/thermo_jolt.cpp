@@ -1,8 +1,10 @@
 /*
  * 🚨 WARNING
- * This file must be used after checking maintainence of temperature through cpu_burner.
- * This is not thermo-aware code.
- * Thus, it injects a clock puluse by using the dedicatied CPU/RAM clock and maintaining the temperature.
+ * Without --target-temp, this file must be used after checking maintainence of temperature through cpu_burner.
+ * In that mode it is not thermo-aware code:
+ * it injects a clock puluse by using the dedicatied CPU/RAM clock and maintaining the temperature.
+ * With --target-temp, a closed-loop controller holds the temperature during warm-up
+ * and the pulse starts from a settled thermal state.
  * */
 
 #include <atomic>
@@ -33,51 +35,23 @@
 #include "cmdline.h"
 #include "utils/util.hpp"
 #include "hardware/dvfs.h"
+#include "hardware/actuator.h"
+#include "hardware/controller.h"
+#include "hardware/hotplug.h"
 #include "hardware/record.h"
+#include "workload/burn.h"
 
 using namespace std::chrono;
 
 static std::atomic<bool> g_stop{false};
 static std::atomic<bool> g_work{true};
+static std::atomic<bool> g_pulse{false};
 std::atomic_bool sigterm(false);
 
 static void on_sigint(int) {
     g_stop.store(true, std::memory_order_relaxed);
 }
 
-// /sys/devices/system/cpu/online parsing
-static std::vector<int> read_online_cpus() {
-    std::ifstream f("/sys/devices/system/cpu/online");
-    std::string s;
-    if (!(f >> s)) return {}; // 실패 시 빈 벡터
-    std::vector<int> cpus;
-
-    auto add_range = [&](int a, int b){
-        for (int i = a; i <= b; ++i) cpus.push_back(i);
-    };
-
-    size_t i = 0;
-    while (i < s.size()) {
-        // parse number
-        int a = 0, b = -1;
-        bool neg = false;
-        if (s[i] == ',') { ++i; continue; }
-        // read a
-        while (i < s.size() && isdigit(s[i])) { a = a*10 + (s[i]-'0'); ++i; }
-        if (i < s.size() && s[i] == '-') {
-            ++i;
-            b = 0;
-            while (i < s.size() && isdigit(s[i])) { b = b*10 + (s[i]-'0'); ++i; }
-        }
-        if (b < 0) b = a;
-        add_range(a, b);
-        if (i < s.size() && s[i] == ',') ++i;
-    }
-    std::sort(cpus.begin(), cpus.end());
-    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
-    return cpus;
-}
-
 // affine thread to specific core
 static bool pin_to_core(int core_id) {
 #if defined(__linux__) || defined(__ANDROID__)
@@ -117,37 +91,36 @@ static void try_bump_priority() {
     setpriority(PRIO_PROCESS, 0, -5);
 }
 
-// busy loop: FMA-heavy floating point + LCG integer ops
-static void hot_loop(std::atomic<bool>& stop_flag, std::atomic<bool>& work_flag) {
-    // false sharing mitigation by align
-    alignas(64) volatile double v0 = 1.000001, v1 = 0.999999, v2 = 1.000003, v3 = 0.999997;
-    uint32_t rng = 123456789u;
-
-    // overhead minimization by large chunk
+// busy loop: power-virus kernel chunks (workload/burn.h)
+// active: thread ids >= *active idle (thermal controller thread gating)
+static void hot_loop(std::atomic<bool>& stop_flag, std::atomic<bool>& work_flag, const BurnKernel& kernel,
+                     const std::atomic<int>* active = nullptr, int id = 0) {
     while (!stop_flag.load(std::memory_order_relaxed)) {
         if (!work_flag.load(std::memory_order_relaxed)) {
             std::this_thread::sleep_for(std::chrono::milliseconds(50));
             continue;
         }
-        
-        #pragma clang loop unroll(full)
-        for (int i = 0; i < 1'000'000; ++i) {
-            //FMA
-            v0 = v0 * 1.0000001 + 0.9999999;
-            v1 = v1 * 0.9999997 + 1.0000003;
-            v2 = v2 * 1.0000002 + 0.9999998;
-            v3 = v3 * 0.9999996 + 1.0000004;
-
-            //LCG
-            rng = rng * 1664525u + 1013904223u;
-
-            // value range control
-            if (v0 > 1e30) v0 = 1.0;
-            if (v1 < 1e-30) v1 = 1.0;
+        if (active && id >= active->load(std::memory_order_relaxed)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
         }
-        // To make not be optimized out by compiler
-        // memory barrier-like effect
-        asm volatile("" :: "r"(v0), "r"(v1), "r"(v2), "r"(v3), "r"(rng) : "memory");
+        (void)kernel.chunk();
+    }
+}
+
+// wait for a queued transition; false on SIGINT (the actuator flushes it at exit)
+static bool wait_ticket(const ActuatorTicket& t) {
+    while (!t.ready()) {
+        if (g_stop.load(std::memory_order_relaxed)) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+// sleep `sec` seconds unless SIGINT comes first
+static void sleep_unless_stopped(int sec) {
+    for (int i = 0; i < sec * 100 && !g_stop.load(std::memory_order_relaxed); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
 }
 
@@ -163,13 +136,22 @@ int main(int argc, char** argv) {
     cmdParser.add<int>("threads", 't', "number of threads (default: # of online CPUs)", false, -1);
     cmdParser.add<int>("duration", 'd', "duration time in seconds (default: 10s)", false, 40);
     cmdParser.add<int>("pulse", 'p', "pulse time in seconds (default: 1s)", false, 1);
-    cmdParser.add<std::string>("device", 0, "specify phone type [Pixel9 | S24] (default: Pixel9)", false, "Pixel9");
+    cmdParser.add<std::string>("device", 0, "specify phone type [Pixel9 | S24 | auto] (default: Pixel9)", false, "Pixel9");
     cmdParser.add<std::string>("output", 'o', "specify output directory path (default: output/)", false, "output/");
+    cmdParser.add<std::string>("kernel", 0, "power-virus kernel [auto | scalar | sse2 | avx2 | avx512 | neon | sve] (default: auto [widest of the cpu])", false, "auto");
     // dvfs options
     cmdParser.add<int>("cpu-clock", 0, "CPU clock index for DVFS (maintain) (default: -1 [off])", true, -1);
     cmdParser.add<int>("ram-clock", 0, "RAM clock index for DVFS (maintain) (default: -1 [off])", true, -1);
     cmdParser.add<int>("pulse-cpu-clock", 0, "CPU clock index for DVFS (pulse) (default: -1 [off])", true, -1);
     cmdParser.add<int>("pulse-ram-clock", 0, "RAM clock index for DVFS (pulse) (default: -1 [off])", true, -1);
+    // thermal control options
+    cmdParser.add<double>("target-temp", 0, "hold this temperature (degC) during warm-up (default: -1 [off])", false, -1.0);
+    cmdParser.add<double>("temp-band", 0, "tolerance band of --target-temp in degC (default: 0.5)", false, 0.5);
+    cmdParser.add<double>("settle", 0, "seconds in band before the pulse (default: 5)", false, 5.0);
+    cmdParser.add("temp-threads", 0, "let the controller also gate the number of busy threads");
+    // hotplug options
+    cmdParser.add<std::string>("offline", 0, "cpus to take offline during the run, ex. 1-3 (default: none)", false, "");
+    cmdParser.add<std::string>("online", 0, "cpus to bring online during the run, ex. 4-7 (default: none)", false, "");
     cmdParser.parse_check(argc, argv);
     
     // get options
@@ -179,11 +161,20 @@ int main(int argc, char** argv) {
     const int pulse_sec = cmdParser.get<int>("pulse") > 0 ? cmdParser.get<int>("pulse") : 0;
     const std::string device_name = cmdParser.get<std::string>("device");
     const std::string output_dir = cmdParser.get<std::string>("output");
+    const BurnKernel* kernel = find_burn_kernel(cmdParser.get<std::string>("kernel"));
+    if (!kernel) {
+        std::cerr << "kernel not available on this cpu: " << cmdParser.get<std::string>("kernel") << " (available:";
+        for (const auto& k : burn_kernels()) std::cerr << " " << k.name;
+        std::cerr << ")\n";
+        return 1;
+    }
     // dvfs options
     const int cpu_clk_idx = cmdParser.get<int>("cpu-clock");
     const int ram_clk_idx = cmdParser.get<int>("ram-clock");
     const int pulse_cpu_clk_idx = cmdParser.get<int>("pulse-cpu-clock");
     const int pulse_ram_clk_idx = cmdParser.get<int>("pulse-ram-clock");
+    const double target_temp = cmdParser.get<double>("target-temp");
+    const bool thermal_ctl = target_temp > 0.0;
     
 
     // TODO: kernel hard recording path refinement
@@ -194,7 +185,23 @@ int main(int argc, char** argv) {
                                     + std::to_string(pulse_cpu_clk_idx) + "-" + std::to_string(pulse_ram_clk_idx) + std::string(".txt")
     );
 
-    auto cpus = read_online_cpus();
+    // cpu hotplug (states restored at exit)
+    const std::vector<int> offline_cpus = parse_cpu_list(cmdParser.get<std::string>("offline"));
+    const std::vector<int> online_cpus = parse_cpu_list(cmdParser.get<std::string>("online"));
+    const bool hotplug_ctl = !offline_cpus.empty() || !online_cpus.empty();
+    Hotplug hotplug;
+    if (hotplug.open(hotplug_ctl) == 0 && hotplug_ctl) {
+        std::cerr << "no hotpluggable cpu (cpuN/online)\n";
+        return 1;
+    }
+    if (hotplug_ctl) {
+        int failed = hotplug.set_cpus(online_cpus, true) + hotplug.set_cpus(offline_cpus, false);
+        if (failed) std::cerr << failed << " hotplug transition(s) failed. Are you root or authorized?\n";
+        hotplug.refresh();
+        std::cout << hotplug.report() << "\r\n";
+    }
+
+    auto cpus = hotplug.get_online();
     int online = cpus.empty() ? (int)std::thread::hardware_concurrency() : (int)cpus.size();
     if (online <= 0) online = 1;
 
@@ -204,7 +211,9 @@ int main(int argc, char** argv) {
     std::cout << "cpu_burner: threads=" << threads
               << ", pin=" << (pin ? "yes" : "no")
               << ", duration=" << (duration_sec > 0 ? std::to_string(duration_sec) + "s" : "infinite")
-              << ", online_cpus=" << online << "\n";
+              << ", online_cpus=" << online
+              << ", kernel=" << kernel->name << "\n";
+    std::cout << "topology: " << Topology::system().describe() << "\n";
 
     try_bump_priority();
 
@@ -213,33 +222,98 @@ int main(int argc, char** argv) {
 
     // DVFS setting
     DVFS dvfs(device_name);
+    dvfs.load_freq_tables(); // device OPP tables (cached after the first scan)
     if (dvfs.init_fd_cache() != 0) {
         fprintf(stderr, "FD cache initialization failed. Are you root or authorized?\n");
     }
     dvfs.output_filename = output_hard;
-    // cpu clock candidates
-    std::vector<int> freq_config = dvfs.get_cpu_freqs_conf(cpu_clk_idx);
-    for (auto f : freq_config) { std::cout << f << " "; } std::cout << std::endl; // to validate (print freq-configuration)
-    // dvfs setting
-    dvfs.set_cpu_freq(freq_config);
-    dvfs.set_ram_freq(ram_clk_idx);
+    // cpu clock candidates (-1: released)
+    DvfsState warm_state = dvfs.make_state(cpu_clk_idx, ram_clk_idx);
+    DvfsState pulse_state = dvfs.make_state(pulse_cpu_clk_idx, pulse_ram_clk_idx);
+    for (auto f : warm_state.cpu_idx) { std::cout << f << " "; } std::cout << std::endl; // to validate (print freq-configuration)
+    // dvfs setting (pulse transitions go through the actuator thread)
+    DvfsActuator actuator(dvfs);
+    actuator.start();
+
+    // warm-up: fixed clocks, or the thermal controller (--cpu-clock ignored, --ram-clock kept)
+    Collector collector = dvfs.get_collector();
+    ThermalControlConfig tcfg;
+    if (thermal_ctl) {
+        if (collector.open_thermal() == 0) {
+            fprintf(stderr, "No cpu thermal zone found for %s (%s)\n", device_name.c_str(),
+                    collector.get_thermal().describe().c_str());
+            actuator.stop();
+            return 1;
+        }
+        tcfg.target_c = target_temp;
+        tcfg.band_c = cmdParser.get<double>("temp-band");
+        tcfg.settle_sec = cmdParser.get<double>("settle");
+        tcfg.ram_idx = ram_clk_idx;
+        tcfg.max_threads = cmdParser.exist("temp-threads") ? threads : 0;
+        tcfg.log_path = joinPaths(output_dir, "thermal_ctl_" + std::to_string((int)target_temp) + ".csv");
+    } else {
+        auto warm = actuator.apply(warm_state);
+        if (warm->wait() != 0 && dvfs.fd_cache_enabled()) {
+            fprintf(stderr, "DVFS transition failed (rc=%d, domain %d)\n", warm->rc, warm->tx.failed_domain);
+            actuator.stop();
+            return 1;
+        }
+    }
+    ThermalController controller(dvfs, collector, tcfg);
+    if (thermal_ctl) controller.start();
     // start recording
-    std::thread record_thread = std::thread(record_hard, std::ref(sigterm), dvfs);
+    std::thread record_thread = std::thread(record_hard, std::ref(sigterm), std::cref(dvfs));
 
     // stop process
+    // the pulse thread writes `stop` and uses locals of main: joined before they go out of scope
     std::atomic<bool> stop = false;
-    if (duration_sec > 0) {
-        std::thread([&stop, &dvfs, duration_sec, pulse_sec, pulse_cpu_clk_idx, pulse_ram_clk_idx]{
-            // warm-up
-            std::this_thread::sleep_for(std::chrono::seconds(duration_sec-pulse_sec));
-            std::vector<int> freq_config = dvfs.get_cpu_freqs_conf(pulse_cpu_clk_idx);
-            dvfs.set_cpu_freq(freq_config);
-            dvfs.set_ram_freq(pulse_ram_clk_idx);
-            std::cout << "dvfs set\r\n";
+    std::thread pulse_thread;
+    if (duration_sec > 0 && thermal_ctl) {
+        // pulse once the temperature has settled (warm-up time is the deadline)
+        const int64_t deadline_ns = now_ns() + (int64_t)(duration_sec - pulse_sec) * 1000000000LL;
+
+        pulse_thread = std::thread([&stop, &actuator, &controller, &pulse_state, deadline_ns, pulse_sec]{
+            while (!controller.settled() && now_ns() < deadline_ns &&
+                   !g_stop.load(std::memory_order_relaxed)) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            if (g_stop.load(std::memory_order_relaxed)) return; // SIGINT: main thread cleans up
+            const bool settled = controller.settled();
+            controller.stop();
+            auto pulse = actuator.apply(pulse_state);
+            g_pulse.store(true, std::memory_order_relaxed);
+            std::cout << controller.report() << "\r\n";
+            if (!settled) std::cout << "warm-up deadline reached before settling\r\n";
+            if (!wait_ticket(*pulse)) return;
+            if (pulse->rc != 0) {
+                std::cout << "dvfs pulse failed (rc=" << pulse->rc << ")\r\n";
+            } else {
+                std::cout << "dvfs set at " << controller.get_temp() << "C ("
+                          << pulse->tx.elapsed_ns / 1000 << "us transition)\r\n";
+            }
             // pulse
-            std::this_thread::sleep_for(std::chrono::seconds(pulse_sec));
+            sleep_unless_stopped(pulse_sec);
             stop.store(true, std::memory_order_relaxed);
-        }).detach();
+        });
+    } else if (duration_sec > 0) {
+        // pulse transitions are queued now with an absolute target time
+        const int64_t pulse_ns = now_ns() + (int64_t)(duration_sec - pulse_sec) * 1000000000LL;
+        auto pulse = actuator.apply(pulse_state, pulse_ns);
+
+        pulse_thread = std::thread([&stop, pulse, pulse_sec]{
+            // warm-up (until the actuator applies the pulse)
+            if (!wait_ticket(*pulse)) return;
+            if (pulse->rc != 0) {
+                std::cout << "dvfs pulse failed (rc=" << pulse->rc
+                          << (pulse->tx.rolled_back ? ", warm-up state kept" : "") << ")\r\n";
+            } else {
+                std::cout << "dvfs set (+" << (pulse->applied_ns - pulse->target_ns) / 1000 << "us, "
+                          << pulse->tx.elapsed_ns / 1000 << "us transition)\r\n";
+            }
+            // pulse
+            sleep_unless_stopped(pulse_sec);
+            stop.store(true, std::memory_order_relaxed);
+        });
     }
 
     // stabilize
@@ -254,6 +328,7 @@ int main(int argc, char** argv) {
         g_work.store(true, std::memory_order_relaxed);
         std::cout << "[WARM-UP] " << duration_sec - pulse_sec << "s\r\n";
         for (int s = 0; s < 2*(duration_sec - pulse_sec) &&
+                !g_pulse.load(std::memory_order_relaxed) &&
                 !g_stop.load(std::memory_order_relaxed) &&
                 !stop.load(std::memory_order_relaxed); ++s) {
             std::this_thread::sleep_for(500ms);
@@ -275,7 +350,7 @@ int main(int argc, char** argv) {
                 int core_id = cpus[i % cpus.size()];
                 (void)pin_to_core(core_id);
             }
-            hot_loop(stop, g_work);
+            hot_loop(stop, g_work, *kernel, tcfg.max_threads > 0 ? &controller.active_threads() : nullptr, i);
         });
     }
 
@@ -287,13 +362,20 @@ int main(int argc, char** argv) {
     stop.store(true, std::memory_order_relaxed);
 
     for (auto& t : ths) t.join();
+    if (pulse_thread.joinable()) pulse_thread.join(); // returns at once on SIGINT
 
     std::cout << "thermo_jolt: done.\r\n";
 
     // done
     sigterm = true;
+    controller.stop(); // SIGINT during warm-up
+    actuator.stop(); // pending transitions are flushed
     dvfs.unset_cpu_freq();
     dvfs.unset_ram_freq();
+    if (hotplug_ctl) {
+        if (hotplug.restore() != 0) std::cerr << "hotplug: some cpus could not be restored\n";
+        std::cout << hotplug.report() << "\r\n";
+    }
     if (phase_thread.joinable()) phase_thread.join();
     record_thread.join();
     std::this_thread::sleep_for(std::chrono::milliseconds(1000));
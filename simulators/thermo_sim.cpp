@@ -0,0 +1,188 @@
+// thermo_sim.cpp — offline RC thermal simulator for thermo_jolt-style what-if studies
+// Fits an RC thermal network on kernel_hard logs (--fit), or runs a grid of pulse
+// scenarios (warm-up state, pulse state, recovery) through the fitted network and a
+// power_fit model, in parallel, to pre-screen experiments before using a phone.
+// Runs offline: no root and no sysfs writes.
+// usage:
+//   ex) ./thermo_sim
+//       --device Pixel9         # specify phone type (default: Pixel9)
+//       --power-model auto      # power_fit model [auto | path] (default: auto)
+//       --net auto              # thermal network [auto | path] (default: auto, generic values if missing)
+//       --fit a.txt,b.txt       # fit the network on kernel_hard logs and save it to --net
+//       --volt-file volt.txt    # OPP voltages for --fit, as for power_fit (default: none)
+//       --ambient 25            # ambient temperature in degC (default: 25)
+//       --warm-cpu 0:16:2       # warm-up prime cpu indices: all | a:b[:step] | i,j,k (default: all)
+//       --pulse-cpu all         # pulse prime cpu indices, same syntax (default: all)
+//       --warm-ram -1           # warm-up ram index (default: -1 [released])
+//       --pulse-ram -1          # pulse ram index (default: -1 [released])
+//       --warm 30               # warm-up seconds (default: 30)
+//       --pulse 1,2,5           # pulse lengths in seconds, comma-separated (default: 1)
+//       --after 10              # recovery seconds at the warm-up state (default: 10)
+//       --dt 0.05               # integration step in seconds (default: 0.05)
+//       --threads 8             # worker threads (default: # of online CPUs)
+//       --output output/        # output directory path (default: output/)
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "cmdline.h"
+#include "utils/util.hpp"
+#include "hardware/dvfs.h"
+#include "hardware/sweep.h"
+#include "model/power_model.h"
+#include "model/thermal_sim.h"
+
+int main(int argc, char** argv) {
+    cmdline::parser cmdParser;
+    cmdParser.add<std::string>("device", 0, "specify phone type [Pixel9 | S24 | auto] (default: Pixel9)", false, "Pixel9");
+    cmdParser.add<std::string>("power-model", 0, "power_fit model, auto: the device cache (default: auto)", false, "auto");
+    cmdParser.add<std::string>("net", 0, "thermal network, auto: the device cache (default: auto)", false, "auto");
+    cmdParser.add<std::string>("fit", 0, "fit the network on kernel_hard logs (comma-separated) and save it", false, "");
+    cmdParser.add<std::string>("volt-file", 0, "OPP voltages (\"domain kHz uV\" lines) on top of debugfs/devicetree", false, "");
+    cmdParser.add<double>("ambient", 0, "ambient temperature in degC (default: 25)", false, 25.0);
+    cmdParser.add<std::string>("warm-cpu", 0, "warm-up prime cpu indices: all | a:b[:step] | i,j,k (default: all)", false, "all");
+    cmdParser.add<std::string>("pulse-cpu", 0, "pulse prime cpu indices, same syntax (default: all)", false, "all");
+    cmdParser.add<int>("warm-ram", 0, "warm-up ram index (default: -1 [released])", false, -1);
+    cmdParser.add<int>("pulse-ram", 0, "pulse ram index (default: -1 [released])", false, -1);
+    cmdParser.add<double>("warm", 0, "warm-up seconds (default: 30)", false, 30.0);
+    cmdParser.add<std::string>("pulse", 'p', "pulse lengths in seconds, comma-separated (default: 1)", false, "1");
+    cmdParser.add<double>("after", 0, "recovery seconds at the warm-up state (default: 10)", false, 10.0);
+    cmdParser.add<double>("dt", 0, "integration step in seconds (default: 0.05)", false, 0.05);
+    cmdParser.add<int>("threads", 't', "worker threads (default: # of online CPUs)", false, -1);
+    cmdParser.add<std::string>("output", 'o', "specify output directory path (default: output/)", false, "output/");
+    cmdParser.parse_check(argc, argv);
+
+    const std::string device_name = cmdParser.get<std::string>("device");
+    DVFS dvfs(device_name);
+    dvfs.load_freq_tables();
+
+    std::string model_path = cmdParser.get<std::string>("power-model");
+    if (model_path == "auto") model_path = power_model_path(device_name);
+    PowerModel model;
+    if (model.load(model_path, device_name) != 0) {
+        fprintf(stderr, "power model not loadable for %s: %s (run power_fit first)\n", device_name.c_str(), model_path.c_str());
+        return 1;
+    }
+
+    std::string net_path = cmdParser.get<std::string>("net");
+    if (net_path == "auto") net_path = thermal_net_path(device_name);
+    ThermalNetwork net = ThermalNetwork::make_default(dvfs);
+    const std::string fit_logs = cmdParser.get<std::string>("fit");
+    net.ambient_c = cmdParser.get<double>("ambient");
+
+    // fit mode
+    if (!fit_logs.empty()) {
+        if (dvfs.load_voltages(cmdParser.get<std::string>("volt-file")) < 0) return 1;
+        std::vector<PowerObs> obs;
+        std::stringstream ss(fit_logs);
+        std::string path;
+        while (std::getline(ss, path, ',')) {
+            const int rows = load_hard_log(path, dvfs, obs);
+            if (rows < 0) {
+                fprintf(stderr, "%s: %s\n", path.c_str(), rows == -1 ? "not readable" : "missing columns");
+                return 1;
+            }
+            printf("%s: %d rows\n", path.c_str(), rows);
+        }
+        const int rc = fit_thermal_network(obs, model, net);
+        if (rc != 0) {
+            fprintf(stderr, "fit failed (%s)\n", rc == 1 ? "no consecutive rows" : "no node observed by a thermal zone");
+            return 1;
+        }
+        std::cout << net.describe() << "\n";
+        if (net.save(net_path) != 0) {
+            fprintf(stderr, "cannot write %s\n", net_path.c_str());
+            return 1;
+        }
+        printf("saved: %s\n", net_path.c_str());
+        return 0;
+    }
+
+    if (net.load(net_path, device_name) != 0) {
+        fprintf(stderr, "no thermal network for %s (%s): generic values\n", device_name.c_str(), net_path.c_str());
+    }
+    net.ambient_c = cmdParser.get<double>("ambient");
+
+    // scenario grid
+    const std::vector<int>& clusters = dvfs.get_cluster_indices();
+    if (clusters.empty() || dvfs.get_cpu_freq().count(clusters.back()) == 0) {
+        fprintf(stderr, "no cpu OPP table for %s\n", device_name.c_str());
+        return 1;
+    }
+    const int cpu_max = (int)dvfs.get_cpu_freq().at(clusters.back()).size() - 1;
+    std::vector<double> pulses;
+    {
+        std::stringstream ss(cmdParser.get<std::string>("pulse"));
+        std::string item;
+        while (std::getline(ss, item, ',')) pulses.push_back(std::stod(item));
+    }
+    std::vector<int> warm_points, pulse_points;
+    if (parse_sweep_points(cmdParser.get<std::string>("warm-cpu"), cpu_max, false, warm_points) != 0 ||
+        parse_sweep_points(cmdParser.get<std::string>("pulse-cpu"), cpu_max, false, pulse_points) != 0) {
+        std::cerr << "invalid --warm-cpu or --pulse-cpu\n" << cmdParser.usage();
+        return 1;
+    }
+    std::vector<JoltScenario> scenarios;
+    for (int w : warm_points) {
+        for (int p : pulse_points) {
+            for (double len : pulses) {
+                JoltScenario sc;
+                sc.warm_cpu = w;
+                sc.warm_ram = cmdParser.get<int>("warm-ram");
+                sc.pulse_cpu = p;
+                sc.pulse_ram = cmdParser.get<int>("pulse-ram");
+                sc.warm_s = cmdParser.get<double>("warm");
+                sc.pulse_s = len;
+                sc.after_s = cmdParser.get<double>("after");
+                scenarios.push_back(sc);
+            }
+        }
+    }
+
+    std::vector<JoltResult> results;
+    const auto t0 = std::chrono::steady_clock::now();
+    const int rc = simulate_jolts(net, model, dvfs, scenarios, results, cmdParser.get<int>("threads"),
+                                  cmdParser.get<double>("dt"));
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    if (rc != 0) {
+        fprintf(stderr, "simulation failed (%s)\n", rc == 1 ? "singular thermal network" : "empty power model");
+        return 1;
+    }
+    printf("thermo_sim: %zu scenarios in %.3f s (%.0f scenarios/s)\n", scenarios.size(), sec, scenarios.size() / sec);
+
+    // hottest peaks first
+    std::vector<std::size_t> order(scenarios.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return results[a].peak_c > results[b].peak_c; });
+    printf("%8s %8s %7s %9s %8s %9s %8s %9s\n", "warm_cpu", "pulse_cpu", "pulse_s", "start_c", "peak_c", "to_peak_s", "end_c", "energy_j");
+    for (std::size_t k = 0; k < std::min<std::size_t>(5, order.size()); ++k) {
+        const JoltScenario& s = scenarios[order[k]];
+        const JoltResult& r = results[order[k]];
+        printf("%8d %8d %7.2f %9.2f %8.2f %9.2f %8.2f %9.1f\n", s.warm_cpu, s.pulse_cpu, s.pulse_s,
+               r.pulse_start_c, r.peak_c, r.time_to_peak_s, r.end_c, r.energy_j);
+    }
+
+    const std::string csv = joinPaths(cmdParser.get<std::string>("output"), "thermo_sim.csv");
+    std::ofstream f(csv);
+    if (!f) {
+        fprintf(stderr, "cannot write %s\n", csv.c_str());
+        return 1;
+    }
+    f << "warm_cpu,warm_ram,pulse_cpu,pulse_ram,warm_s,pulse_s,after_s,pulse_start_c,peak_c,time_to_peak_s,end_c,energy_j\n";
+    for (std::size_t i = 0; i < scenarios.size(); ++i) {
+        const JoltScenario& s = scenarios[i];
+        const JoltResult& r = results[i];
+        f << s.warm_cpu << "," << s.warm_ram << "," << s.pulse_cpu << "," << s.pulse_ram << "," << s.warm_s << ","
+          << s.pulse_s << "," << s.after_s << "," << r.pulse_start_c << "," << r.peak_c << "," << r.time_to_peak_s
+          << "," << r.end_c << "," << r.energy_j << "\n";
+    }
+    printf("saved: %s\n", csv.c_str());
+    return 0;
+}
@@ -0,0 +1,258 @@
+#include "actuator.h"
+
+#include <errno.h>
+#include <sched.h>
+#include <time.h>
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+// spin margin before a target time (sleep granularity of the scheduler)
+static constexpr int64_t SPIN_MARGIN_NS = 200000;
+
+int ActuatorTicket::wait() const {
+    // sleep through a far target, then poll (spin, yield, short sleeps)
+    int64_t left = target_ns - now_ns();
+    if (left > 1000000) std::this_thread::sleep_for(std::chrono::nanoseconds(left - 1000000));
+
+    for (int i = 0; !ready(); ++i) {
+        if (i < 1000) continue;
+        if (i < 2000) sched_yield();
+        else std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    return rc;
+}
+
+DvfsActuator::DvfsActuator(DVFS& dvfs) : dvfs(dvfs), head(&stub), tail(&stub) {
+#if defined(__APPLE__)
+    sem = dispatch_semaphore_create(0);
+#else
+    sem_init(&sem, 0, 0);
+#endif
+}
+
+DvfsActuator::~DvfsActuator() {
+    stop();
+
+    // commands never consumed: release their waiters, then free them
+    while (Command* cmd = pop()) {
+        cmd->ticket->rc = -1;
+        cmd->ticket->done.store(true, std::memory_order_release);
+        delete cmd;
+    }
+#if defined(__APPLE__)
+    dispatch_release(sem);
+#else
+    sem_destroy(&sem);
+#endif
+}
+
+void DvfsActuator::post() {
+#if defined(__APPLE__)
+    dispatch_semaphore_signal(sem);
+#else
+    sem_post(&sem);
+#endif
+}
+
+void DvfsActuator::wait_post() {
+#if defined(__APPLE__)
+    dispatch_semaphore_wait(sem, DISPATCH_TIME_FOREVER);
+#else
+    while (sem_wait(&sem) != 0 && errno == EINTR) {}
+#endif
+}
+
+bool DvfsActuator::try_wait_post() {
+#if defined(__APPLE__)
+    return dispatch_semaphore_wait(sem, DISPATCH_TIME_NOW) == 0;
+#else
+    return sem_trywait(&sem) == 0;
+#endif
+}
+
+bool DvfsActuator::wait_post_for(int64_t ns) {
+#if defined(__APPLE__)
+    return dispatch_semaphore_wait(sem, dispatch_time(DISPATCH_TIME_NOW, ns)) == 0;
+#else
+    // sem_timedwait takes a CLOCK_REALTIME deadline; a clock step only
+    // lengthens or shortens one slice
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    int64_t nsec = ts.tv_nsec + ns;
+    ts.tv_sec += (time_t)(nsec / 1000000000);
+    ts.tv_nsec = (long)(nsec % 1000000000);
+    int rc;
+    while ((rc = sem_timedwait(&sem, &ts)) != 0 && errno == EINTR) {}
+    return rc == 0;
+#endif
+}
+
+// ---- MPSC queue (Vyukov) ----
+void DvfsActuator::push(Command* cmd) {
+    cmd->next.store(nullptr, std::memory_order_relaxed);
+    Command* prev = head.exchange(cmd, std::memory_order_acq_rel);
+    prev->next.store(cmd, std::memory_order_release);
+}
+
+DvfsActuator::Command* DvfsActuator::pop() {
+    // only called by the actuator thread (or after it is joined)
+    Command* t = tail;
+    Command* next = t->next.load(std::memory_order_acquire);
+
+    if (t == &stub) {
+        if (!next) return nullptr;
+        tail = next;
+        t = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+    if (next) {
+        tail = next;
+        return t;
+    }
+    // producer between exchange and link: retry later
+    if (t != head.load(std::memory_order_acquire)) return nullptr;
+
+    push(&stub);
+    next = t->next.load(std::memory_order_acquire);
+    if (next) {
+        tail = next;
+        return t;
+    }
+    return nullptr;
+}
+
+// ---- producer side ----
+std::shared_ptr<ActuatorTicket> DvfsActuator::submit(Command* cmd, int64_t target_ns) {
+    auto ticket = std::make_shared<ActuatorTicket>();
+    ticket->submit_ns = now_ns();
+    ticket->target_ns = target_ns;
+    cmd->ticket = ticket;
+
+    // nothing would consume it (STOP is submitted by stop() itself)
+    if (cmd->type != CmdType::STOP && (!running.load() || quit.load())) {
+        fprintf(stderr, "[Actuator] not running: command dropped\n");
+        ticket->rc = -1;
+        ticket->done.store(true, std::memory_order_release);
+        delete cmd;
+        return ticket;
+    }
+    push(cmd);
+    post();
+    return ticket;
+}
+
+std::shared_ptr<ActuatorTicket> DvfsActuator::set_cpu(const std::vector<int>& freq_indices, int64_t target_ns) {
+    Command* cmd = new Command();
+    cmd->type = CmdType::SET_CPU;
+    cmd->cpu_idx = freq_indices;
+    return submit(cmd, target_ns);
+}
+
+std::shared_ptr<ActuatorTicket> DvfsActuator::set_ram(int freq_idx, int64_t target_ns) {
+    Command* cmd = new Command();
+    cmd->type = CmdType::SET_RAM;
+    cmd->ram_idx = freq_idx;
+    return submit(cmd, target_ns);
+}
+
+std::shared_ptr<ActuatorTicket> DvfsActuator::apply(const DvfsState& state, int64_t target_ns) {
+    Command* cmd = new Command();
+    cmd->type = CmdType::APPLY;
+    cmd->state = state;
+    return submit(cmd, target_ns);
+}
+
+std::shared_ptr<ActuatorTicket> DvfsActuator::restore(int64_t target_ns) {
+    Command* cmd = new Command();
+    cmd->type = CmdType::RESTORE;
+    return submit(cmd, target_ns);
+}
+
+// ---- actuator thread ----
+void DvfsActuator::start() {
+    if (running.exchange(true)) return;
+    quit = false;
+    th = std::thread(&DvfsActuator::run, this);
+}
+
+void DvfsActuator::stop() {
+    if (!running.load()) return;
+    quit = true;
+
+    Command* cmd = new Command();
+    cmd->type = CmdType::STOP;
+    submit(cmd, 0);
+
+    if (th.joinable()) th.join();
+    running = false;
+}
+
+void DvfsActuator::take(std::multimap<int64_t, Command*>& pending) {
+    // one post per push: the command is there, possibly not linked yet
+    Command* cmd;
+    while ((cmd = pop()) == nullptr) sched_yield();
+
+    // STOP goes last, after every queued command; equal keys keep submission order
+    const int64_t key = cmd->type == CmdType::STOP ? std::numeric_limits<int64_t>::max() : cmd->ticket->target_ns;
+    pending.emplace(key, cmd);
+}
+
+void DvfsActuator::run() {
+    // open the fd cache if the owner of the DVFS has not
+    if (!dvfs.fd_cache_enabled() && dvfs.init_fd_cache() != 0) {
+        fprintf(stderr, "[Actuator] FD cache initialization failed. Are you root or authorized?\n");
+    }
+
+    // submitted, not applied yet: no target (0) first, then by target time
+    std::multimap<int64_t, Command*> pending;
+    while (true) {
+        if (pending.empty()) {
+            wait_post();
+            take(pending);
+        }
+        while (try_wait_post()) take(pending);
+
+        auto it = pending.begin();
+        Command* cmd = it->second;
+        ActuatorTicket& t = *cmd->ticket;
+        if (t.target_ns > 0 && cmd->type != CmdType::STOP && !quit.load(std::memory_order_relaxed)) {
+            // coarse sleep in slices, woken by a new submission, then spin
+            const int64_t left = t.target_ns - now_ns();
+            if (left > SPIN_MARGIN_NS) {
+                if (wait_post_for(std::min<int64_t>(left - SPIN_MARGIN_NS, 10000000))) take(pending);
+                continue;
+            }
+            while (now_ns() < t.target_ns) {}
+        }
+        pending.erase(it);
+
+        const CmdType type = cmd->type;
+        switch (type) {
+        case CmdType::SET_CPU:
+            t.rc = dvfs.set_cpu_freq(cmd->cpu_idx);
+            break;
+        case CmdType::SET_RAM:
+            t.rc = dvfs.set_ram_freq(cmd->ram_idx);
+            break;
+        case CmdType::APPLY:
+            t.rc = dvfs.apply_state(cmd->state, &t.tx);
+            break;
+        case CmdType::RESTORE: {
+            int rc_cpu = dvfs.unset_cpu_freq();
+            int rc_ram = dvfs.unset_ram_freq();
+            t.rc = rc_cpu != 0 ? rc_cpu : rc_ram;
+            break;
+        }
+        case CmdType::STOP:
+            break;
+        }
+
+        t.applied_ns = now_ns();
+        t.done.store(true, std::memory_order_release);
+        delete cmd;
+
+        if (type == CmdType::STOP) break;
+    }
+}
@@ -0,0 +1,114 @@
+#ifndef ACTUATOR_H
+#define ACTUATOR_H
+
+#include "dvfs.h"
+#include "utils/clock.h"
+
+#include <stdint.h>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#if defined(__APPLE__)
+  #include <dispatch/dispatch.h>
+#else
+  #include <semaphore.h>
+#endif
+
+/* ** DVFS actuator **
+ *
+ * A single thread applies commands taken from a lock-free MPSC queue
+ * (intrusive Vyukov queue). Producers never block: submitting is one atomic
+ * exchange plus a semaphore post. Other DVFS callers (controller, governor,
+ * recorder) are not routed through it; DVFS serializes their writes.
+ *
+ * Commands are applied by target time (steady_clock ns, see now_ns() in
+ * utils/clock.h): commands without a target first, then the earliest
+ * target; equal targets keep submission order. The thread sleeps until
+ * shortly before the earliest target, then spins; a command submitted
+ * meanwhile wakes it, so a far pulse does not hold back urgent commands.
+ *
+ * ex)
+ *   DvfsActuator act(dvfs);
+ *   act.start();
+ *   auto t = act.set_cpu(dvfs.get_cpu_freqs_conf(12), now_ns() + 5'000'000);
+ *   t->wait(); // t->applied_ns, t->rc
+ */
+struct ActuatorTicket {
+    std::atomic<bool> done{false};
+    int rc = 0;             // DVFS return code (-1: dropped, the actuator was not running)
+    DvfsTxResult tx;        // APPLY only
+    int64_t submit_ns = 0;  // steady_clock ns
+    int64_t target_ns = 0;  // 0: as soon as possible
+    int64_t applied_ns = 0; // write completion
+
+    bool ready() const { return done.load(std::memory_order_acquire); }
+    int wait() const;       // blocks until done (sleeps through far targets); returns rc
+};
+
+class DvfsActuator {
+public:
+    enum class CmdType { SET_CPU, SET_RAM, APPLY, RESTORE, STOP };
+
+private:
+    struct Command {
+        CmdType type = CmdType::STOP;
+        std::vector<int> cpu_idx;
+        int ram_idx = -1;
+        DvfsState state;
+        std::shared_ptr<ActuatorTicket> ticket;
+        std::atomic<Command*> next{nullptr};
+    };
+
+    DVFS& dvfs;
+
+    // MPSC queue: producers exchange head, the actuator thread owns tail
+    std::atomic<Command*> head;
+    Command* tail;
+    Command stub;
+
+#if defined(__APPLE__)
+    dispatch_semaphore_t sem;
+#else
+    sem_t sem;
+#endif
+
+    std::thread th;
+    std::atomic<bool> running{false};
+    std::atomic<bool> quit{false};
+
+public:
+    explicit DvfsActuator(DVFS& dvfs);
+    ~DvfsActuator();
+
+    DvfsActuator(const DvfsActuator&) = delete;
+    DvfsActuator& operator=(const DvfsActuator&) = delete;
+
+    void start();
+    void stop(); // applies queued commands without waiting for their target, then joins
+
+    // thread-safe and non-blocking (target_ns = 0: as soon as possible)
+    // before start() or once stop() began, the ticket comes back done with rc -1
+    std::shared_ptr<ActuatorTicket> set_cpu(const std::vector<int>& freq_indices, int64_t target_ns = 0);
+    std::shared_ptr<ActuatorTicket> set_ram(int freq_idx, int64_t target_ns = 0);
+    std::shared_ptr<ActuatorTicket> apply(const DvfsState& state, int64_t target_ns = 0); // DVFS::apply_state
+    std::shared_ptr<ActuatorTicket> restore(int64_t target_ns = 0); // unset cpu and ram
+
+
+private:
+    std::shared_ptr<ActuatorTicket> submit(Command* cmd, int64_t target_ns);
+    void push(Command* cmd);
+    Command* pop();
+    void post();
+    void wait_post();
+    bool try_wait_post();
+    bool wait_post_for(int64_t ns); // false on timeout
+    // pop the command of one post into the target-ordered pending set
+    void take(std::multimap<int64_t, Command*>& pending);
+    void run();
+};
+
+#endif // ACTUATOR_H
@@ -0,0 +1,363 @@
+#include "controller.h"
+#include "model/power_model.h"
+#include "utils/clock.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <fstream>
+
+// ---- PID ----
+void Pid::reset(double out) {
+    integ = std::min(g.out_max, std::max(g.out_min, out));
+    d_filt = 0.0;
+    primed = false;
+    last = PidTerms();
+    last.out = integ;
+}
+
+double Pid::update(double setpoint, double measured, double dt_sec) {
+    const double err = setpoint - measured;
+
+    // derivative on measurement: a setpoint step does not kick the output
+    double d_raw = 0.0;
+    if (primed && dt_sec > 0.0) d_raw = -(measured - prev_meas) / dt_sec;
+    d_filt = primed ? g.d_alpha * d_raw + (1.0 - g.d_alpha) * d_filt : 0.0;
+    prev_meas = measured;
+    primed = true;
+
+    PidTerms t;
+    t.p = g.kp * err;
+    t.d = g.kd * d_filt;
+
+    // conditional integration: hold the integral while saturated in the error direction
+    const double trial = integ + g.ki * err * dt_sec;
+    const double unclamped = t.p + trial + t.d;
+    const bool push_high = unclamped > g.out_max && err > 0.0;
+    const bool push_low = unclamped < g.out_min && err < 0.0;
+    if (!push_high && !push_low) integ = trial;
+    t.i = integ;
+
+    const double raw = t.p + t.i + t.d;
+    t.out = std::min(g.out_max, std::max(g.out_min, raw));
+    t.saturated = (t.out != raw);
+    last = t;
+    return t.out;
+}
+
+bool SettleTracker::update(double error, int64_t t_ns) {
+    const bool in_band = std::fabs(error) <= band;
+    if (!in_band) band_since = -1;
+    else if (band_since < 0) band_since = t_ns;
+    if (settle_ns < 0 && band_since >= 0 && t_ns - band_since >= hold_ns) settle_ns = t_ns;
+    return in_band;
+}
+
+// highest OPP index of the prime cluster (-1: no table)
+static int prime_opp_max(DVFS& dvfs) {
+    const std::vector<int>& clusters = dvfs.get_cluster_indices();
+    if (clusters.empty()) return -1;
+    auto it = dvfs.get_cpu_freq().find(clusters.back());
+    return (it != dvfs.get_cpu_freq().end()) ? (int)it->second.size() - 1 : -1;
+}
+
+// mean (or rms) |error| of the samples at or after settle_ns
+template <typename Sample, typename ErrorFn>
+static double steady_error(const std::vector<Sample>& samples, int64_t settle_ns, bool rms, ErrorFn err) {
+    if (settle_ns < 0) return 0.0;
+    double acc = 0.0;
+    long n = 0;
+    for (const Sample& s : samples) {
+        if (s.t_ns < settle_ns) continue;
+        const double e = err(s);
+        acc += rms ? e * e : std::fabs(e);
+        ++n;
+    }
+    if (n == 0) return 0.0;
+    return rms ? std::sqrt(acc / n) : acc / n;
+}
+
+
+// ---- thermal controller ----
+ThermalController::ThermalController(DVFS& dvfs, Collector& collector, ThermalControlConfig cfg)
+    : dvfs(dvfs), collector(collector), cfg(cfg), pid(cfg.gains) {
+    threads.store(cfg.max_threads, std::memory_order_relaxed);
+}
+
+ThermalController::~ThermalController() { stop(); }
+
+void ThermalController::start() {
+    if (running.exchange(true)) return;
+    settled_flag.store(false, std::memory_order_relaxed);
+    th = std::thread(&ThermalController::run, this);
+}
+
+void ThermalController::stop() {
+    if (!running.exchange(false)) return;
+    if (th.joinable()) th.join();
+    if (!cfg.log_path.empty()) write_log();
+}
+
+void ThermalController::run() {
+    if (!dvfs.fd_cache_enabled() && dvfs.init_fd_cache() != 0) {
+        fprintf(stderr, "[Thermal] FD cache initialization failed. Are you root or authorized?\n");
+    }
+
+    const int cpu_max = prime_opp_max(dvfs);
+    const int ram_max = (int)dvfs.get_ddr_freq().size() - 1;
+    if (cpu_max < 0) fprintf(stderr, "[Thermal] no cpu OPP table: temperature is logged only\n");
+
+    const int64_t period_ns = (int64_t)std::max(1, cfg.period_ms) * 1000000;
+
+    // bumpless start from the current prime index
+    double u0 = 0.5;
+    const DvfsState cur = dvfs.get_state();
+    if (cpu_max > 0 && !cur.cpu_idx.empty() && cur.cpu_idx.back() >= 0) u0 = (double)cur.cpu_idx.back() / cpu_max;
+    pid.reset(u0);
+
+    samples.clear();
+    samples.reserve(4096);
+    settle = SettleTracker{ cfg.band_c, (int64_t)(cfg.settle_sec * 1e9) };
+    int applied_cpu = -2, applied_ram = -2;
+
+    const int64_t t0 = now_ns();
+    int64_t next = t0;
+    while (running.load(std::memory_order_relaxed)) {
+        std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::nanoseconds(next)));
+        const int64_t t = now_ns();
+        next += period_ns;
+        if (next < t) next = t + period_ns; // overrun: skip missed periods
+
+        ThermalSample s;
+        s.t_ns = t - t0;
+        s.temp_c = collector.collect_high_temp();
+        last_temp.store(s.temp_c, std::memory_order_relaxed);
+
+        const double u = pid.update(cfg.target_c, s.temp_c, period_ns / 1e9);
+        s.pid = pid.get_terms();
+
+        // effort -> actuators
+        s.cpu_idx = (cpu_max >= 0) ? (int)std::lround(u * cpu_max) : -1;
+        s.ram_idx = (cfg.control_ram && ram_max >= 0) ? (int)std::lround(u * ram_max) : cfg.ram_idx;
+        if (cfg.max_threads > 0) {
+            s.threads = std::max(1, (int)std::ceil(u * cfg.max_threads));
+            threads.store(s.threads, std::memory_order_relaxed);
+        }
+        if (s.cpu_idx >= 0 && (s.cpu_idx != applied_cpu || s.ram_idx != applied_ram)) {
+            s.rc = dvfs.apply_state(dvfs.make_state(s.cpu_idx, s.ram_idx));
+            if (s.rc == 0) {
+                applied_cpu = s.cpu_idx;
+                applied_ram = s.ram_idx;
+            }
+        }
+
+        // settled: continuously in band for settle_sec
+        s.in_band = settle.update(cfg.target_c - s.temp_c, s.t_ns);
+        if (settle.settled()) settled_flag.store(true, std::memory_order_release);
+        samples.push_back(s);
+    }
+}
+
+int ThermalController::write_log() const {
+    std::ofstream file(cfg.log_path);
+    if (!file) {
+        fprintf(stderr, "[Thermal] cannot write log: %s\n", cfg.log_path.c_str());
+        return -1;
+    }
+    file << "time_s,temp_c,error_c,p,i,d,effort,cpu_idx,ram_idx,threads,rc,in_band\n";
+    for (const ThermalSample& s : samples) {
+        file << s.t_ns / 1e9 << "," << s.temp_c << "," << cfg.target_c - s.temp_c << ","
+             << s.pid.p << "," << s.pid.i << "," << s.pid.d << "," << s.pid.out << ","
+             << s.cpu_idx << "," << s.ram_idx << "," << s.threads << "," << s.rc << ","
+             << (s.in_band ? 1 : 0) << "\n";
+    }
+    return 0;
+}
+
+std::string ThermalController::report() const {
+    // steady state: in-band ratio and error over the samples after settling
+    long in_band = 0;
+    double effort_sum = 0.0;
+    for (const ThermalSample& s : samples) {
+        if (s.in_band) ++in_band;
+        effort_sum += s.pid.out;
+    }
+    const double err = steady_error(samples, settle.settle_ns, false,
+                                    [this](const ThermalSample& s) { return cfg.target_c - s.temp_c; });
+
+    char line[256];
+    if (settle.settled()) {
+        snprintf(line, sizeof(line),
+                 "thermal: target %.1f +- %.1f C, settled after %.1f s, %.1f%% in band, "
+                 "mean |error| %.2f C after settling, mean effort %.2f",
+                 cfg.target_c, cfg.band_c, settle.settle_ns / 1e9,
+                 samples.empty() ? 0.0 : 100.0 * in_band / samples.size(),
+                 err, samples.empty() ? 0.0 : effort_sum / samples.size());
+    } else {
+        snprintf(line, sizeof(line), "thermal: target %.1f +- %.1f C, not settled (%zu samples, last %.1f C)",
+                 cfg.target_c, cfg.band_c, samples.size(), get_temp());
+    }
+    return line;
+}
+
+
+// ---- power-cap controller ----
+PowerCapController::PowerCapController(DVFS& dvfs, PowerMeter& meter, PowerCapConfig cfg)
+    : dvfs(dvfs), meter(meter), collector(dvfs.get_collector()), cfg(cfg), pid(cfg.gains) {}
+
+PowerCapController::~PowerCapController() { stop(); }
+
+void PowerCapController::start() {
+    if (running.exchange(true)) return;
+    settled_flag.store(false, std::memory_order_relaxed);
+    th = std::thread(&PowerCapController::run, this);
+}
+
+void PowerCapController::stop() {
+    if (!running.exchange(false)) return;
+    if (th.joinable()) th.join();
+    if (!cfg.log_path.empty()) write_log();
+}
+
+void PowerCapController::run() {
+    if (!dvfs.fd_cache_enabled() && dvfs.init_fd_cache() != 0) {
+        fprintf(stderr, "[PowerCap] FD cache initialization failed. Are you root or authorized?\n");
+    }
+    if (!meter.is_open() && meter.open() != 0) {
+        fprintf(stderr, "[PowerCap] power supply not readable: controller idle\n");
+    }
+
+    const int cpu_max = prime_opp_max(dvfs);
+    const int ram_max = (int)dvfs.get_ddr_freq().size() - 1;
+    if (cpu_max < 0) fprintf(stderr, "[PowerCap] no cpu OPP table: duty cycle only\n");
+    const double split = std::min(0.95, std::max(0.0, cfg.split));
+
+    const int64_t period_ns = (int64_t)std::max(1, cfg.period_ms) * 1000000;
+
+    // bumpless start from the current prime index at full duty
+    double u0 = 1.0;
+    const DvfsState cur = dvfs.get_state();
+    if (cpu_max > 0 && !cur.cpu_idx.empty() && cur.cpu_idx.back() >= 0) {
+        u0 = split + (1.0 - split) * cur.cpu_idx.back() / cpu_max;
+    }
+    pid.reset(u0);
+    meter.reset();
+
+    samples.clear();
+    samples.reserve(4096);
+    settle = SettleTracker{ cfg.band_w, (int64_t)(cfg.settle_sec * 1e9) };
+    int applied_cpu = -2, applied_ram = -2;
+    double applied_duty = 1.0;
+
+    // model nowcast over the meter window: (time, W)
+    const PowerModel* model = (cfg.model && !cfg.model->empty()) ? cfg.model : nullptr;
+    const int64_t window_ns = (int64_t)meter.get_window_ms() * 1000000;
+    std::deque<std::pair<int64_t, double>> model_hist;
+    double model_sum = 0.0;
+
+    const int64_t t0 = now_ns();
+    int64_t next = t0;
+    while (running.load(std::memory_order_relaxed)) {
+        std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::nanoseconds(next)));
+        const int64_t t = now_ns();
+        next += period_ns;
+        if (next < t) next = t + period_ns; // overrun: skip missed periods
+
+        if (meter.sample() != 0) continue;
+
+        PowerSample s;
+        s.t_ns = t - t0;
+        s.instant_w = meter.get_instant();
+        s.filtered_w = meter.get_watts();
+        last_watts.store(s.filtered_w, std::memory_order_relaxed);
+
+        double measured = s.filtered_w;
+        if (model && applied_cpu >= 0) {
+            const DvfsState st = dvfs.make_state(applied_cpu, applied_ram);
+            // leakage follows the die temperature (0: no cpu zone, fit reference 25 degC)
+            s.temp_c = collector.collect_high_temp();
+            s.model_w = model->predict(st.cpu_idx, std::vector<double>(st.cpu_idx.size(), applied_duty),
+                                       st.ram_idx, s.temp_c > 0.0 ? s.temp_c : 25.0);
+            model_hist.emplace_back(t, s.model_w);
+            model_sum += s.model_w;
+            while (model_hist.size() > 1 && t - model_hist.front().first > window_ns) {
+                model_sum -= model_hist.front().second;
+                model_hist.pop_front();
+            }
+            measured += s.model_w - model_sum / model_hist.size();
+        }
+
+        const double u = pid.update(cfg.target_w, measured, period_ns / 1e9);
+        s.pid = pid.get_terms();
+
+        // effort -> (duty, OPP): frequency first, duty cycle below the lowest OPP
+        if (u >= split || cpu_max < 0) {
+            s.duty = (cpu_max < 0) ? std::max(cfg.min_duty, u) : 1.0;
+            s.cpu_idx = (cpu_max >= 0) ? (int)std::lround((u - split) / (1.0 - split) * cpu_max) : -1;
+        } else {
+            s.duty = cfg.min_duty + (1.0 - cfg.min_duty) * (split > 0.0 ? u / split : 1.0);
+            s.cpu_idx = 0;
+        }
+        s.ram_idx = (cfg.control_ram && ram_max >= 0) ? (int)std::lround(u * ram_max) : cfg.ram_idx;
+        duty_cycle.store(s.duty, std::memory_order_relaxed);
+        applied_duty = s.duty;
+
+        if (s.cpu_idx >= 0 && (s.cpu_idx != applied_cpu || s.ram_idx != applied_ram)) {
+            s.rc = dvfs.apply_state(dvfs.make_state(s.cpu_idx, s.ram_idx));
+            if (s.rc == 0) {
+                applied_cpu = s.cpu_idx;
+                applied_ram = s.ram_idx;
+            }
+        }
+
+        s.in_band = settle.update(cfg.target_w - s.filtered_w, s.t_ns);
+        if (settle.settled()) settled_flag.store(true, std::memory_order_release);
+        samples.push_back(s);
+    }
+    duty_cycle.store(1.0, std::memory_order_relaxed);
+}
+
+double PowerCapController::steady_error_w(bool rms) const {
+    return steady_error(samples, settle.settle_ns, rms,
+                        [this](const PowerSample& s) { return cfg.target_w - s.filtered_w; });
+}
+
+int PowerCapController::write_log() const {
+    std::ofstream file(cfg.log_path);
+    if (!file) {
+        fprintf(stderr, "[PowerCap] cannot write log: %s\n", cfg.log_path.c_str());
+        return -1;
+    }
+    // settle_s / steady_err_w: summary, repeated on every row for plotting
+    file << "time_s,instant_w,filtered_w,error_w,p,i,d,effort,cpu_idx,ram_idx,duty,rc,in_band,settle_s,steady_err_w,model_w,temp_c\n";
+    const double settle_s = settle_time_sec();
+    const double steady = steady_error_w();
+    for (const PowerSample& s : samples) {
+        file << s.t_ns / 1e9 << "," << s.instant_w << "," << s.filtered_w << "," << cfg.target_w - s.filtered_w << ","
+             << s.pid.p << "," << s.pid.i << "," << s.pid.d << "," << s.pid.out << ","
+             << s.cpu_idx << "," << s.ram_idx << "," << s.duty << "," << s.rc << ","
+             << (s.in_band ? 1 : 0) << "," << settle_s << "," << steady << "," << s.model_w << "," << s.temp_c << "\n";
+    }
+    return 0;
+}
+
+std::string PowerCapController::report() const {
+    double duty_sum = 0.0;
+    for (const PowerSample& s : samples) duty_sum += s.duty;
+
+    char line[256];
+    if (settle.settled()) {
+        snprintf(line, sizeof(line),
+                 "power cap: target %.2f +- %.2f W, settled after %.1f s, "
+                 "steady-state error %.3f W (rms %.3f W), mean duty %.2f",
+                 cfg.target_w, cfg.band_w, settle_time_sec(), steady_error_w(), steady_error_w(true),
+                 samples.empty() ? 1.0 : duty_sum / samples.size());
+    } else {
+        snprintf(line, sizeof(line), "power cap: target %.2f +- %.2f W, not settled (%zu samples, last %.2f W)",
+                 cfg.target_w, cfg.band_w, samples.size(), get_watts());
+    }
+    return line;
+}
@@ -0,0 +1,256 @@
+#ifndef CONTROLLER_H
+#define CONTROLLER_H
+
+#include "dvfs.h"
+#include "power_meter.h"
+
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+class PowerModel; // model/power_model.h
+
+/* ** PID controller **
+ *
+ * Discrete PID with:
+ * - output clamp and conditional integration (no windup while saturated)
+ * - derivative on measurement, low-pass filtered (no kick on setpoint change)
+ *
+ * ex)
+ *   Pid pid({ 0.15, 0.02, 0.05 });
+ *   pid.reset(0.5);                                  // bumpless start at 50 %
+ *   double u = pid.update(target, measured, 0.2);    // dt in seconds
+ */
+struct PidGains {
+    double kp = 0.0;
+    double ki = 0.0;
+    double kd = 0.0;
+    double out_min = 0.0;
+    double out_max = 1.0;
+    double d_alpha = 0.3;  // derivative EMA weight of the newest sample (1: unfiltered)
+};
+
+struct PidTerms {
+    double p = 0.0, i = 0.0, d = 0.0;
+    double out = 0.0;
+    bool saturated = false;
+};
+
+class Pid {
+private:
+    PidGains g;
+    double integ = 0.0;
+    double prev_meas = 0.0;
+    double d_filt = 0.0;
+    bool primed = false;
+    PidTerms last;
+
+public:
+    explicit Pid(const PidGains& gains = PidGains()) : g(gains) {}
+
+    void set_gains(const PidGains& gains) { g = gains; }
+    const PidGains& get_gains() const { return g; }
+
+    // start from a given output (integral preloaded, derivative history cleared)
+    void reset(double out = 0.0);
+    // error = setpoint - measured; return the clamped output
+    double update(double setpoint, double measured, double dt_sec);
+    const PidTerms& get_terms() const { return last; } // of the last update
+};
+
+// settling: |error| <= band continuously for hold_ns
+struct SettleTracker {
+    double band = 0.0;
+    int64_t hold_ns = 0;
+    int64_t band_since = -1;
+    int64_t settle_ns = -1;    // first time settled (-1: not yet)
+
+    bool update(double error, int64_t t_ns); // return in band
+    bool settled() const { return settle_ns >= 0; }
+};
+
+
+/* ** Thermal controller **
+ *
+ * Holds the hottest cpu thermal zone at a target temperature.
+ * A periodic loop reads the Collector (cached thermal fds), runs a PID and
+ * maps its effort u in [0, 1] to the actuators:
+ * - prime cpu OPP index   round(u * max)      (others by get_cpu_freqs_conf)
+ * - ram OPP index         round(u * max)      (if control_ram, else ram_idx)
+ * - active threads        ceil(u * max_threads) (if max_threads > 0)
+ * A DVFS transaction is issued only when an index changes. The controller
+ * is settled once the temperature stayed in target +- band for settle_sec.
+ * Every sample (temperature, PID terms, effort, indices) is logged as csv
+ * after stop().
+ *
+ * ex)
+ *   Collector col = dvfs.get_collector();
+ *   col.open_thermal();
+ *   ThermalControlConfig cfg;
+ *   cfg.target_c = 45.0;
+ *   ThermalController ctl(dvfs, col, cfg);
+ *   ctl.start();
+ *   while (!ctl.settled()) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+ *   ctl.stop();
+ */
+struct ThermalControlConfig {
+    double target_c = 45.0;
+    double band_c = 0.5;       // tolerance (+-)
+    double settle_sec = 5.0;   // time in band before settled()
+    int period_ms = 200;       // control period
+    PidGains gains = { 0.15, 0.02, 0.05, 0.0, 1.0, 0.3 }; // effort per degC
+    bool control_ram = false;
+    int ram_idx = -1;          // fixed ram index when !control_ram (-1: released)
+    int max_threads = 0;       // > 0: also gate the number of busy threads
+    std::string log_path;      // csv (empty: no log)
+};
+
+struct ThermalSample {
+    int64_t t_ns = 0;          // since start()
+    double temp_c = 0.0;
+    PidTerms pid;
+    int cpu_idx = -1;          // prime
+    int ram_idx = -1;
+    int threads = 0;
+    int rc = 0;                // apply_state (0 also when unchanged)
+    bool in_band = false;
+};
+
+class ThermalController {
+private:
+    DVFS& dvfs;
+    Collector& collector;
+    ThermalControlConfig cfg;
+    Pid pid;
+
+    std::thread th;
+    std::atomic<bool> running{false};
+    std::atomic<bool> settled_flag{false};
+    std::atomic<int> threads{0};
+    std::atomic<double> last_temp{0.0};
+    SettleTracker settle;
+    std::vector<ThermalSample> samples;
+
+public:
+    ThermalController(DVFS& dvfs, Collector& collector, ThermalControlConfig cfg = ThermalControlConfig());
+    ~ThermalController();
+
+    ThermalController(const ThermalController&) = delete;
+    ThermalController& operator=(const ThermalController&) = delete;
+
+    void start();
+    void stop(); // joins the loop and writes the log; the last state stays applied
+
+    bool settled() const { return settled_flag.load(std::memory_order_acquire); }
+    // threads allowed to work (max_threads when thread gating is off)
+    const std::atomic<int>& active_threads() const { return threads; }
+    double get_temp() const { return last_temp.load(std::memory_order_relaxed); }
+
+    // valid after stop()
+    const std::vector<ThermalSample>& get_samples() const { return samples; }
+    std::string report() const;
+
+private:
+    void run();
+    int write_log() const;
+};
+
+/* ** Power-cap controller **
+ *
+ * Holds the battery power (PowerMeter window average) at a target wattage.
+ * Same loop as the thermal controller, with an adjustable period; the PID
+ * effort u in [0, 1] is split over two actuators:
+ * - u >= split: duty 1, prime cpu OPP index round((u - split) / (1 - split) * max)
+ * - u <  split: lowest OPP, duty cycle min_duty .. 1
+ * so power below the lowest OPP is shed by the burner duty cycle.
+ * Time to settle and the steady-state error (mean/rms after settling) are
+ * part of the report and the csv log.
+ * With a fitted PowerModel, the PID sees the meter average corrected by the
+ * model: filtered + (P_model(now) - mean P_model over the meter window), so
+ * an actuation shows up in the next period instead of a window later.
+ * The model is evaluated at the hottest cpu zone, read once per period.
+ *
+ * ex)
+ *   PowerMeter pm;
+ *   pm.open();
+ *   PowerCapConfig cfg;
+ *   cfg.target_w = 4.0;
+ *   PowerCapController cap(dvfs, pm, cfg);
+ *   cap.start();
+ *   ... // workers follow cap.duty()
+ *   cap.stop();
+ */
+struct PowerCapConfig {
+    double target_w = 4.0;
+    double band_w = 0.2;       // tolerance (+-)
+    double settle_sec = 5.0;   // time in band before settled()
+    int period_ms = 250;       // control period
+    PidGains gains = { 0.05, 0.08, 0.0, 0.0, 1.0, 0.3 }; // effort per W
+    double split = 0.2;        // effort below which the duty cycle is reduced
+    double min_duty = 0.05;
+    bool control_ram = false;
+    int ram_idx = -1;          // fixed ram index when !control_ram (-1: released)
+    std::string log_path;      // csv (empty: no log)
+    const PowerModel* model = nullptr; // nowcast (optional, must outlive the controller)
+};
+
+struct PowerSample {
+    int64_t t_ns = 0;          // since start()
+    double instant_w = 0.0;
+    double filtered_w = 0.0;
+    double model_w = -1.0;     // model prediction of the running state (-1: no model)
+    double temp_c = 0.0;       // hottest cpu zone fed to the model (0: no model)
+    PidTerms pid;
+    int cpu_idx = -1;          // prime
+    int ram_idx = -1;
+    double duty = 1.0;
+    int rc = 0;                // apply_state (0 also when unchanged)
+    bool in_band = false;
+};
+
+class PowerCapController {
+private:
+    DVFS& dvfs;
+    PowerMeter& meter;
+    Collector collector; // cpu zone temperature for the model
+    PowerCapConfig cfg;
+    Pid pid;
+
+    std::thread th;
+    std::atomic<bool> running{false};
+    std::atomic<bool> settled_flag{false};
+    std::atomic<double> duty_cycle{1.0};
+    std::atomic<double> last_watts{0.0};
+    SettleTracker settle;
+    std::vector<PowerSample> samples;
+
+public:
+    PowerCapController(DVFS& dvfs, PowerMeter& meter, PowerCapConfig cfg = PowerCapConfig());
+    ~PowerCapController();
+
+    PowerCapController(const PowerCapController&) = delete;
+    PowerCapController& operator=(const PowerCapController&) = delete;
+
+    void start();
+    void stop(); // joins the loop and writes the log; the last state stays applied
+
+    bool settled() const { return settled_flag.load(std::memory_order_acquire); }
+    // fraction of each duty period the workers should be busy
+    const std::atomic<double>& duty() const { return duty_cycle; }
+    double get_watts() const { return last_watts.load(std::memory_order_relaxed); }
+
+    // valid after stop()
+    const std::vector<PowerSample>& get_samples() const { return samples; }
+    double settle_time_sec() const { return settle.settle_ns / 1e9; } // < 0: not settled
+    double steady_error_w(bool rms = false) const;                     // |error| after settling
+    std::string report() const;
+
+private:
+    void run();
+    int write_log() const;
+};
+
+#endif // CONTROLLER_H
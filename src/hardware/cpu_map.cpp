@@ -0,0 +1,191 @@
+#include "cpu_map.h"
+#include "sysfs_fd.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+const char* cpu_map_name(CpuMap m) {
+    switch (m) {
+    case CpuMap::INDEX:     return "index";
+    case CpuMap::FREQ:      return "freq";
+    case CpuMap::CAPACITY:  return "capacity";
+    case CpuMap::EFFICIENT: return "efficient";
+    case CpuMap::OVERRIDE:  return "override";
+    }
+    return "?";
+}
+
+bool cpu_map_from_name(const std::string& name, CpuMap& out) {
+    for (CpuMap m : { CpuMap::INDEX, CpuMap::FREQ, CpuMap::CAPACITY, CpuMap::EFFICIENT, CpuMap::OVERRIDE }) {
+        if (name == cpu_map_name(m)) {
+            out = m;
+            return true;
+        }
+    }
+    return false;
+}
+
+// nearest OPP to khz
+static int nearest_index(const std::vector<int>& opp, double khz) {
+    int best = 0;
+    for (int i = 1; i < (int)opp.size(); ++i) {
+        if (std::fabs(opp[i] - khz) < std::fabs(opp[best] - khz)) best = i;
+    }
+    return best;
+}
+
+// lowest OPP >= khz (highest if none)
+static int ceil_index(const std::vector<int>& opp, double khz) {
+    for (int i = 0; i < (int)opp.size(); ++i) {
+        if (opp[i] >= khz - 0.5) return i;
+    }
+    return (int)opp.size() - 1;
+}
+
+// efficient OPPs: no faster OPP has a lower or equal cost
+static std::vector<bool> efficient_opps(const CpuMapCluster& c) {
+    std::vector<bool> eff(c.opp.size(), true);
+    if (c.inefficient.size() == c.opp.size()) {
+        for (std::size_t i = 0; i < eff.size(); ++i) eff[i] = !c.inefficient[i];
+    } else if (c.cost.size() == c.opp.size()) {
+        double min_above = INFINITY;
+        for (int i = (int)c.opp.size() - 1; i >= 0; --i) {
+            if (!std::isnan(c.cost[i])) {
+                eff[i] = c.cost[i] < min_above;
+                min_above = std::min(min_above, c.cost[i]);
+            }
+        }
+    }
+    eff.back() = true; // the top OPP is always reachable
+    return eff;
+}
+
+int build_cpu_map(CpuMap m, const std::vector<CpuMapCluster>& clusters,
+                  const std::map<int, std::vector<int>>& overrides,
+                  std::vector<std::vector<int>>& lut) {
+    lut.clear();
+    if (clusters.empty()) return 0;
+    for (const auto& c : clusters) {
+        if (c.opp.empty()) return 0; // no table: get_cpu_freqs_conf() returns {}
+    }
+
+    const CpuMapCluster& prime = clusters.back();
+    const int prime_n = (int)prime.opp.size();
+    const double p_min = prime.opp.front(), p_max = prime.opp.back();
+
+    // validate overrides up front
+    if (m == CpuMap::OVERRIDE) {
+        for (const auto& o : overrides) {
+            auto it = std::find_if(clusters.begin(), clusters.end(), [&](const CpuMapCluster& c) { return c.policy == o.first; });
+            if (it == clusters.end()) return 1;
+            if (o.second.size() != 1 && (int)o.second.size() != prime_n) return 2;
+            for (int idx : o.second) {
+                if (idx < 0 || idx >= (int)it->opp.size()) return 3;
+            }
+        }
+    }
+
+    std::vector<std::vector<bool>> eff;
+    if (m == CpuMap::EFFICIENT) {
+        for (const auto& c : clusters) eff.push_back(efficient_opps(c));
+    }
+
+    lut.assign(prime_n, std::vector<int>(clusters.size(), 0));
+    for (int i = 0; i < prime_n; ++i) {
+        const double f_p = prime.opp[i];
+        const double frac = (p_max > p_min) ? (f_p - p_min) / (p_max - p_min) : 1.0;
+
+        for (std::size_t s = 0; s < clusters.size(); ++s) {
+            const CpuMapCluster& c = clusters[s];
+            const int c_max = (int)c.opp.size() - 1;
+            int idx;
+
+            if (s + 1 == clusters.size()) {
+                idx = i; // prime: as requested
+            } else if (m == CpuMap::INDEX) {
+                idx = (prime_n > 1) ? (int)std::lround((double)i / (prime_n - 1) * c_max) : c_max;
+            } else if (m == CpuMap::CAPACITY) {
+                // cpu_capacity is the capacity at the cluster's max frequency
+                const double perf = (double)prime.capacity * f_p / p_max;
+                idx = ceil_index(c.opp, perf / std::max(1, c.capacity) * c.opp.back());
+            } else {
+                idx = nearest_index(c.opp, c.opp.front() + frac * (c.opp.back() - c.opp.front()));
+                if (m == CpuMap::EFFICIENT) {
+                    while (idx < c_max && !eff[s][idx]) ++idx;
+                }
+            }
+
+            if (m == CpuMap::OVERRIDE) {
+                auto it = overrides.find(c.policy);
+                if (it != overrides.end()) idx = (it->second.size() == 1) ? it->second[0] : it->second[i];
+            }
+            lut[i][s] = idx;
+        }
+    }
+    return 0;
+}
+
+bool parse_cpu_map_overrides(const std::string& spec, std::map<int, std::vector<int>>& out) {
+    out.clear();
+    std::stringstream ss(spec);
+    std::string item;
+    while (std::getline(ss, item, ';')) {
+        if (item.empty()) continue;
+        const std::size_t eq = item.find('=');
+        if (eq == std::string::npos) return false;
+
+        char* end;
+        const long policy = strtol(item.c_str(), &end, 10);
+        if (end != item.c_str() + eq) return false;
+
+        std::vector<int> idx;
+        std::stringstream list(item.substr(eq + 1));
+        std::string v;
+        while (std::getline(list, v, ',')) {
+            const long x = strtol(v.c_str(), &end, 10);
+            if (v.empty() || *end != '\0') return false;
+            idx.push_back((int)x);
+        }
+        if (idx.empty()) return false;
+        out[(int)policy] = idx;
+    }
+    return true;
+}
+
+int load_energy_model(std::vector<CpuMapCluster>& clusters, const std::string& root) {
+    int found = 0;
+    for (auto& c : clusters) {
+        const std::string pd = root + "/sys/kernel/debug/energy_model/cpu" + std::to_string(c.policy);
+        DIR* dir = opendir(pd.c_str());
+        if (!dir) continue;
+
+        c.cost.assign(c.opp.size(), NAN);
+        c.inefficient.clear();
+        std::vector<bool> ineff(c.opp.size(), false);
+        bool have_flag = false;
+        while (dirent* e = readdir(dir)) {
+            if (strncmp(e->d_name, "ps:", 3) != 0) continue;
+            const int khz = atoi(e->d_name + 3);
+            auto it = std::find(c.opp.begin(), c.opp.end(), khz);
+            if (it == c.opp.end()) continue;
+            const std::size_t i = it - c.opp.begin();
+
+            std::string text;
+            if (sysfs::read_text(pd + "/" + e->d_name + "/cost", text)) c.cost[i] = atof(text.c_str());
+            if (sysfs::read_text(pd + "/" + e->d_name + "/inefficient", text)) {
+                ineff[i] = atoi(text.c_str()) != 0;
+                have_flag = true;
+            }
+        }
+        closedir(dir);
+        if (have_flag) c.inefficient = ineff;
+        ++found;
+    }
+    return found;
+}
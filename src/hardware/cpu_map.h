@@ -0,0 +1,53 @@
+#ifndef CPU_MAP_H
+#define CPU_MAP_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+/* ** Cluster frequency mapping **
+ *
+ * How one prime-cluster OPP index sets the other clusters
+ * (DVFS::get_cpu_freqs_conf). Every strategy is resolved once into a
+ * lookup table: lut[prime_idx][slot].
+ * - INDEX:     same relative index, round(i / prime_max * cluster_max)
+ * - FREQ:      same relative position in the frequency range, nearest OPP
+ * - CAPACITY:  same absolute compute capacity (cpu_capacity x f / f_max),
+ *              lowest OPP that reaches it (cluster max if none)
+ * - EFFICIENT: FREQ, then up to the next energy-efficient OPP of the kernel
+ *              energy model (OPPs costlier than a faster one are skipped)
+ * - OVERRIDE:  FREQ, with explicit indices for some clusters
+ *
+ * ex)
+ *   dvfs.load_energy_model();                 // optional, for EFFICIENT
+ *   dvfs.set_cpu_map(CpuMap::CAPACITY);
+ *   DvfsState st = dvfs.make_state(8, 5);     // resolved through the table
+ */
+enum class CpuMap { INDEX, FREQ, CAPACITY, EFFICIENT, OVERRIDE };
+
+const char* cpu_map_name(CpuMap m);
+bool cpu_map_from_name(const std::string& name, CpuMap& out); // false if unknown
+
+// one cluster as seen by the mapper (cluster_indices order, prime last)
+struct CpuMapCluster {
+    int policy = -1;
+    std::vector<int> opp;         // kHz, ascending
+    int capacity = 1024;          // cpu_capacity of the cluster
+    std::vector<double> cost;     // energy model cost per OPP (empty: unknown)
+    std::vector<bool> inefficient; // energy model flag per OPP (empty: derive from cost)
+};
+
+// overrides: policy -> { idx } (fixed) or one index per prime index
+// return 0 on success (1: unknown policy, 2: wrong list length, 3: bad index)
+int build_cpu_map(CpuMap m, const std::vector<CpuMapCluster>& clusters,
+                  const std::map<int, std::vector<int>>& overrides,
+                  std::vector<std::vector<int>>& lut);
+
+// "0=3;4=0,0,1,1,2" -> { 0: {3}, 4: {0,0,1,1,2} } (false on syntax error)
+bool parse_cpu_map_overrides(const std::string& spec, std::map<int, std::vector<int>>& out);
+
+// kernel energy model under <root>/sys/kernel/debug/energy_model/cpuN/ps:<kHz>/{cost,inefficient}
+// fills cost/inefficient of the matching clusters; return the number of clusters found
+int load_energy_model(std::vector<CpuMapCluster>& clusters, const std::string& root = "");
+
+#endif // CPU_MAP_H
@@ -0,0 +1,162 @@
+#include "devfreq.h"
+
+#include <dirent.h>
+#include <unistd.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <sstream>
+#include <utility>
+
+DevfreqDomain::DevfreqDomain(const std::string& path) : path(path) {
+    std::size_t slash = path.find_last_of('/');
+    name = (slash == std::string::npos) ? path : path.substr(slash + 1);
+
+    // available_frequencies: Hz on most drivers, kHz on some vendor nodes
+    std::string text;
+    if (!sysfs::read_text(path + "/available_frequencies", text)) return;
+
+    std::vector<long long> raw;
+    std::istringstream iss(text);
+    long long v;
+    while (iss >> v) raw.push_back(v);
+    if (raw.empty()) return;
+
+    unit = (*std::max_element(raw.begin(), raw.end()) > 100000000LL) ? 1000 : 1;
+    for (long long f : raw) freqs.push_back((int)(f / unit));
+    std::sort(freqs.begin(), freqs.end());
+    freqs.erase(std::unique(freqs.begin(), freqs.end()), freqs.end());
+}
+
+DevfreqDomain::~DevfreqDomain() { close(); }
+
+DevfreqDomain::DevfreqDomain(DevfreqDomain&& o) noexcept
+    : name(std::move(o.name)), path(std::move(o.path)), freqs(std::move(o.freqs)), unit(o.unit),
+      range(o.range), cur_fd(o.cur_fd), verify(o.verify), stats(o.stats) {
+    o.range = sysfs::RangeFd();
+    o.cur_fd = -1;
+}
+
+DevfreqDomain& DevfreqDomain::operator=(DevfreqDomain&& o) noexcept {
+    if (this != &o) {
+        close();
+        name = std::move(o.name);
+        path = std::move(o.path);
+        freqs = std::move(o.freqs);
+        unit = o.unit;
+        range = o.range;
+        cur_fd = o.cur_fd;
+        verify = o.verify;
+        stats = o.stats;
+        o.range = sysfs::RangeFd();
+        o.cur_fd = -1;
+    }
+    return *this;
+}
+
+std::string DevfreqDomain::class_path(const std::string& name, const std::string& root) {
+    return root + "/sys/class/devfreq/" + name;
+}
+
+std::vector<std::string> DevfreqDomain::discover(const std::string& root) {
+    std::vector<std::string> paths;
+    const std::string base = root + "/sys/class/devfreq";
+    DIR* dir = opendir(base.c_str());
+    if (!dir) return paths;
+
+    while (dirent* e = readdir(dir)) {
+        if (e->d_name[0] == '.') continue;
+        paths.push_back(base + "/" + e->d_name);
+    }
+    closedir(dir);
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+std::string DevfreqDomain::get_governor() const {
+    std::string gov;
+    sysfs::read_text(path + "/governor", gov);
+    return gov;
+}
+
+int DevfreqDomain::set_governor(const std::string& governor) {
+    int fd = sysfs::open_wr(path + "/governor");
+    if (fd < 0) return -1;
+    std::string line = governor + "\n";
+    ssize_t n = pwrite(fd, line.data(), line.size(), 0);
+    sysfs::close_fd(fd);
+    return (n == (ssize_t)line.size()) ? 0 : -1;
+}
+
+int DevfreqDomain::open(const std::vector<std::string>& min_names, const std::vector<std::string>& max_names) {
+    close();
+
+    auto open_first = [&](const std::vector<std::string>& names, int& fd) {
+        std::vector<const char*> cs;
+        for (const auto& n : names) cs.push_back(n.c_str());
+        return sysfs::try_open_first(path, cs.data(), (int)cs.size(), fd);
+    };
+    if (!open_first(min_names, range.min_fd)) {
+        fprintf(stderr, "[DVFS] %s min open failed (need root? path mismatch)\n", name.c_str());
+        close();
+        return -1;
+    }
+    if (!open_first(max_names, range.max_fd)) {
+        fprintf(stderr, "[DVFS] %s max open failed (need root? path mismatch)\n", name.c_str());
+        close();
+        return -2;
+    }
+    cur_fd = sysfs::open_rd(path + "/cur_freq");
+
+    // seed the state cache with the current min/max
+    stats = sysfs::IoStats();
+    long long v;
+    if (sysfs::read_int(range.min_fd, v) == 0) range.cur_min = (int)(v / unit);
+    if (sysfs::read_int(range.max_fd, v) == 0) range.cur_max = (int)(v / unit);
+    return 0;
+}
+
+void DevfreqDomain::close() {
+    sysfs::close_fd(range.min_fd);
+    sysfs::close_fd(range.max_fd);
+    sysfs::close_fd(cur_fd);
+    range.cur_min = range.cur_max = -1;
+}
+
+int DevfreqDomain::set_range(int min_khz, int max_khz) {
+    if (!is_open()) return 2;
+    int rc = sysfs::write_range(range, min_khz, max_khz, verify, stats, unit);
+    if (rc == -1) return 3;
+    if (rc == -2) return 5;
+    if (rc == -3) return 6;
+    return 0;
+}
+
+int DevfreqDomain::pin(int freq_idx) {
+    if (freq_idx < 0 || freq_idx >= (int)freqs.size()) return 1;
+    return set_range(freqs[freq_idx], freqs[freq_idx]);
+}
+
+int DevfreqDomain::release() {
+    if (freqs.empty()) return 1;
+    return set_range(freqs.front(), freqs.back());
+}
+
+int DevfreqDomain::get_cur() const {
+    long long v;
+    if (sysfs::read_int(cur_fd, v) != 0) return -1;
+    // same unit as available_frequencies
+    return (int)(v / unit);
+}
+
+int DevfreqDomain::get_pinned_index() const {
+    if (range.cur_min < 0 || range.cur_min != range.cur_max) return -1;
+    auto it = std::lower_bound(freqs.begin(), freqs.end(), range.cur_min);
+    return (it != freqs.end() && *it == range.cur_min) ? (int)(it - freqs.begin()) : -1;
+}
+
+int DevfreqDomain::resync() {
+    if (!is_open()) return 2;
+    sysfs::sync_range(range, stats, unit);
+    return 0;
+}
@@ -0,0 +1,81 @@
+#ifndef DEVFREQ_H
+#define DEVFREQ_H
+
+#include "sysfs_fd.h"
+
+#include <string>
+#include <vector>
+
+/* ** devfreq domain **
+ *
+ * One node under /sys/class/devfreq (MIF, GPU, bus, cache, ...):
+ * available frequencies, governor, and min/max/cur through cached fds.
+ * Frequencies are kHz; nodes reporting Hz are converted both ways.
+ * Not thread-safe: the owner serializes calls (DVFS holds its io_mu).
+ *
+ * ex)
+ *   for (const auto& path : DevfreqDomain::discover()) {
+ *       DevfreqDomain d(path);
+ *       printf("%s %s %zu OPPs\n", d.get_name().c_str(), d.get_governor().c_str(), d.get_freqs().size());
+ *   }
+ *   DevfreqDomain gpu(DevfreqDomain::class_path("1f000000.mali"));
+ *   if (gpu.open() == 0) gpu.pin(0);
+ */
+class DevfreqDomain {
+private:
+    std::string name;
+    std::string path;
+    std::vector<int> freqs; // kHz, ascending
+    int unit = 1;           // node value = kHz * unit (1000 for Hz nodes)
+
+    sysfs::RangeFd range;
+    int cur_fd = -1;
+    bool verify = true;
+    sysfs::IoStats stats;
+
+public:
+    DevfreqDomain() = default;
+    explicit DevfreqDomain(const std::string& path); // reads available_frequencies
+    ~DevfreqDomain();
+
+    DevfreqDomain(const DevfreqDomain&) = delete;
+    DevfreqDomain& operator=(const DevfreqDomain&) = delete;
+    DevfreqDomain(DevfreqDomain&& o) noexcept;
+    DevfreqDomain& operator=(DevfreqDomain&& o) noexcept;
+
+    // node directories under <root>/sys/class/devfreq (sorted by name)
+    static std::vector<std::string> discover(const std::string& root = "");
+    static std::string class_path(const std::string& name, const std::string& root = "");
+
+    const std::string& get_name() const { return name; }
+    const std::string& get_path() const { return path; }
+    const std::vector<int>& get_freqs() const { return freqs; }
+    void set_freqs(const std::vector<int>& table) { freqs = table; } // override (ex. built-in table)
+
+    std::string get_governor() const;
+    int set_governor(const std::string& governor); // 0 on success
+
+    // min/max node names differ across vendors: first existing one is used
+    // return 0 on success (-1: min open failed, -2: max open failed)
+    int open(const std::vector<std::string>& min_names = { "min_freq" },
+             const std::vector<std::string>& max_names = { "max_freq" });
+    void close();
+    bool is_open() const { return range.min_fd >= 0 && range.max_fd >= 0; }
+
+    // return 0 on success (1: bad index, 2: not open, 3: write failed, 5: read-back mismatch,
+    // 6: clamped by a kernel limit, the request is kept)
+    int set_range(int min_khz, int max_khz);
+    int pin(int freq_idx);
+    int release(); // full range of freqs
+
+    int get_min() const { return range.cur_min; } // last programmed (kHz, -1: unknown)
+    int get_max() const { return range.cur_max; }
+    int get_cur() const;                          // cur_freq (kHz, -1 if unavailable)
+    int get_pinned_index() const;                 // -1 if not pinned to one OPP
+    int resync();                                 // re-read min/max
+
+    void set_verify(bool on) { verify = on; }
+    const sysfs::IoStats& get_io_stats() const { return stats; }
+};
+
+#endif // DEVFREQ_H
@@ -1,10 +1,16 @@
 #include "device.h"
+#include "device_table.h"
 
 Device::Device(const std::string& device_name) : device(device_name){
-    if (device_name == "S22_Ultra" || device_name == "Fold4" ||  device_name == "Pixel9"){
-	    cluster_indices = {0, 4, 7};
-    } else if (device_name == "S24"){
-	    cluster_indices = {0, 4, 7, 9};
+    const DeviceDesc* desc = find_device_desc(device_name);
+    if (desc){
+        // built-in device (S22_Ultra, Fold4, Pixel9: {0, 4, 7} / S24: {0, 4, 7, 9})
+        for (int c = 0; c < desc->num_clusters; ++c){
+            cluster_indices.push_back(desc->clusters[c].policy);
+        }
+    } else {
+        // unknown device (or "auto"): clusters from cpufreq policies
+        cluster_indices = Topology::system().get_policies();
     }
 }
 
@@ -14,4 +20,4 @@ const std::vector<int> Device::get_cluster_indices() const{
 
 const std::string Device::get_device_name() const{
     return this->device;
-}
\ No newline at end of file
+}
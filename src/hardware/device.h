@@ -1,6 +1,8 @@
 #ifndef DEVICE_H
 #define DEVICE_H
 
+#include "topology.h"
+
 #include <string>
 #include <vector>
 #include <iostream>
@@ -16,6 +18,8 @@ public:
 
     const std::vector<int> get_cluster_indices() const;
     const std::string get_device_name() const;
+    // topology of the running system (detected once)
+    const Topology& get_topology() const { return Topology::system(); }
 };
 
-#endif // DEVICE_HPP
\ No newline at end of file
+#endif // DEVICE_HPP
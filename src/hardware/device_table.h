@@ -0,0 +1,113 @@
+#ifndef DEVICE_TABLE_H
+#define DEVICE_TABLE_H
+
+#include <string_view>
+
+/* ** Built-in device descriptors **
+ *
+ * Compile-time OPP tables (kHz, ascending) per cpufreq policy and MIF.
+ * DVFS flattens the selected descriptor into index-addressed slots,
+ * so the write path never touches a string-keyed map.
+ *
+ * ex)
+ *   constexpr const DeviceDesc* desc = find_device_desc("Pixel9");
+ *   static_assert(desc->clusters[2].policy == 7);
+ */
+
+struct OppSpan {
+    const int* freqs = nullptr;
+    int size = 0;
+
+    constexpr int operator[](int i) const { return freqs[i]; }
+    constexpr int front() const { return freqs[0]; }
+    constexpr int back() const { return freqs[size - 1]; }
+    constexpr const int* begin() const { return freqs; }
+    constexpr const int* end() const { return freqs + size; }
+};
+
+template <int N>
+constexpr OppSpan opp_span(const int (&table)[N]) { return OppSpan{ table, N }; }
+
+struct ClusterDesc {
+    int policy;
+    OppSpan opp;
+};
+
+constexpr int MAX_CLUSTERS = 4;
+
+struct DeviceDesc {
+    const char* name;
+    int num_clusters;
+    ClusterDesc clusters[MAX_CLUSTERS];
+    OppSpan ddr;
+};
+
+namespace device_table {
+
+// S22 Ultra
+inline constexpr int s22u_p0[] = { 307200, 403200, 518400, 614400, 729600, 844800, 960000, 1075200, 1171200, 1267200, 1363200, 1478400, 1574400, 1689600, 1785600 };
+inline constexpr int s22u_p4[] = { 633600, 768000, 883200, 998400, 1113600, 1209600, 1324800, 1440000, 1555200, 1651200, 1766400, 1881600, 1996800, 2112000, 2227200, 2342400, 2419200 };
+inline constexpr int s22u_p7[] = { 806400, 940800, 1056000, 1171200, 1286400, 1401600, 1497600, 1612800, 1728000, 1843200, 1958400, 2054400, 2169600, 2284800, 2400000, 2515200, 2630400, 2726400, 2822400, 2841600 };
+inline constexpr int s22u_ddr[] = { 547000, 768000, 1555000, 1708000, 2092000, 2736000, 3196000 };
+
+// S24
+inline constexpr int s24_p0[] = { 400000, 576000, 672000, 768000, 864000, 960000, 1056000, 1152000, 1248000, 1344000, 1440000, 1536000, 1632000, 1728000, 1824000, 1920000, 1959000 };
+inline constexpr int s24_p4[] = { 672000, 768000, 864000, 960000, 1056000, 1152000, 1248000, 1344000, 1440000, 1536000, 1632000, 1728000, 1824000, 1920000, 2016000, 2112000, 2208000, 2304000, 2400000, 2496000, 2592000 };
+inline constexpr int s24_p7[] = { 672000, 768000, 864000, 960000, 1056000, 1152000, 1248000, 1344000, 1440000, 1536000, 1632000, 1728000, 1824000, 1920000, 2016000, 2112000, 2208000, 2304000, 2400000, 2496000, 2592000, 2688000, 2784000, 2880000, 2900000 };
+inline constexpr int s24_p9[] = { 672000, 768000, 864000, 960000, 1056000, 1152000, 1248000, 1344000, 1440000, 1536000, 1632000, 1728000, 1824000, 1920000, 2016000, 2112000, 2208000, 2304000, 2400000, 2496000, 2592000, 2688000, 2784000, 2880000, 2976000, 3072000, 3207000 };
+inline constexpr int s24_ddr[] = { 421000, 676000, 845000, 1014000, 1352000, 1539000, 1716000, 2028000, 2288000, 2730000, 3172000, 3738000, 4206000 };
+
+// Fold4
+inline constexpr int fold4_p0[] = { 300000, 441600, 556800, 691200, 806400, 940800, 1056000, 1132800, 1228800, 1324800, 1440000, 1555200, 1670400, 1804800, 1920000, 2016000 };
+inline constexpr int fold4_p4[] = { 633600, 768000, 883200, 998400, 1113600, 1209600, 1324800, 1440000, 1555200, 1651200, 1766400, 1881600, 1996800, 2112000, 2227200, 2342400, 2457600, 2572800, 2649600, 2745600 };
+inline constexpr int fold4_p7[] = { 787200, 921600, 1036800, 1171200, 1286400, 1401600, 1536000, 1651200, 1766400, 1881600, 1996800, 2131200, 2246400, 2361600, 2476800, 2592000, 2707200, 2822400, 2918400, 2995200 };
+inline constexpr int fold4_ddr[] = { 547000, 768000, 1555000, 1708000, 2092000, 2736000, 3196000 };
+
+// Pixel9
+inline constexpr int pixel9_p0[] = { 820000, 955000, 1098000, 1197000, 1328000, 1425000, 1548000, 1696000, 1849000, 1950000 };
+inline constexpr int pixel9_p4[] = { 357000, 578000, 648000, 787000, 910000, 1065000, 1221000, 1328000, 1418000, 1549000, 1795000, 1945000, 2130000, 2245000, 2367000, 2450000, 2600000 };
+inline constexpr int pixel9_p7[] = { 700000, 1164000, 1396000, 1557000, 1745000, 1885000, 1999000, 2147000, 2294000, 2363000, 2499000, 2687000, 2802000, 2914000, 2943000, 2970000, 3015000, 3105000 };
+inline constexpr int pixel9_ddr[] = { 421000, 546000, 676000, 845000, 1014000, 1352000, 1539000, 1716000, 2028000, 2288000, 2730000, 3172000, 3744000 };
+
+} // namespace device_table
+
+inline constexpr DeviceDesc BUILTIN_DEVICES[] = {
+    { "S22_Ultra", 3, { { 0, opp_span(device_table::s22u_p0) }, { 4, opp_span(device_table::s22u_p4) }, { 7, opp_span(device_table::s22u_p7) } },
+      opp_span(device_table::s22u_ddr) },
+    { "S24", 4, { { 0, opp_span(device_table::s24_p0) }, { 4, opp_span(device_table::s24_p4) }, { 7, opp_span(device_table::s24_p7) }, { 9, opp_span(device_table::s24_p9) } },
+      opp_span(device_table::s24_ddr) },
+    { "Fold4", 3, { { 0, opp_span(device_table::fold4_p0) }, { 4, opp_span(device_table::fold4_p4) }, { 7, opp_span(device_table::fold4_p7) } },
+      opp_span(device_table::fold4_ddr) },
+    { "Pixel9", 3, { { 0, opp_span(device_table::pixel9_p0) }, { 4, opp_span(device_table::pixel9_p4) }, { 7, opp_span(device_table::pixel9_p7) } },
+      opp_span(device_table::pixel9_ddr) },
+};
+
+// nullptr if the device has no built-in descriptor
+constexpr const DeviceDesc* find_device_desc(std::string_view name) {
+    for (const auto& d : BUILTIN_DEVICES) {
+        if (name == d.name) return &d;
+    }
+    return nullptr;
+}
+
+// compile-time integrity: every table is strictly ascending
+constexpr bool opp_ascending(OppSpan t) {
+    for (int i = 1; i < t.size; ++i) {
+        if (t[i] <= t[i - 1]) return false;
+    }
+    return t.size > 0;
+}
+
+constexpr bool builtin_tables_valid() {
+    for (const auto& d : BUILTIN_DEVICES) {
+        if (d.num_clusters <= 0 || d.num_clusters > MAX_CLUSTERS) return false;
+        if (!opp_ascending(d.ddr)) return false;
+        for (int c = 0; c < d.num_clusters; ++c) {
+            if (!opp_ascending(d.clusters[c].opp)) return false;
+        }
+    }
+    return true;
+}
+static_assert(builtin_tables_valid(), "built-in OPP tables must be non-empty and ascending");
+
+#endif // DEVICE_TABLE_H
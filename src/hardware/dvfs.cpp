@@ -1,38 +1,13 @@
 #include "dvfs.h"
+#include "topology.h"
 
-// DVFS --------------------------------------
-const std::map<std::string, std::map<int, std::vector<int>>> DVFS::cpufreq = {
-    { "S22_Ultra", {
-        { 0, { 307200, 403200, 518400, 614400, 729600, 844800, 960000, 1075200, 1171200, 1267200, 1363200, 1478400, 1574400, 1689600, 1785600 } },
-        { 4, { 633600, 768000, 883200, 998400, 1113600, 1209600, 1324800, 1440000, 1555200, 1651200, 1766400, 1881600, 1996800, 2112000, 2227200, 2342400, 2419200 } },
-        { 7, { 806400, 940800, 1056000, 1171200, 1286400, 1401600, 1497600, 1612800, 1728000, 1843200, 1958400, 2054400, 2169600, 2284800, 2400000, 2515200, 2630400, 2726400, 2822400, 2841600 } }
-    }},
-    { "S24", {
-        { 0, { 400000, 576000, 672000, 768000, 864000, 960000, 1056000, 1152000, 1248000, 1344000, 1440000, 1536000, 1632000, 1728000, 1824000, 1920000, 1959000 } },
-        { 4, { 672000, 768000, 864000, 960000, 1056000, 1152000, 1248000, 1344000, 1440000, 1536000, 1632000, 1728000, 1824000, 1920000, 2016000, 2112000, 2208000, 2304000, 2400000, 2496000, 2592000 } },
-        { 7, { 672000, 768000, 864000, 960000, 1056000, 1152000, 1248000, 1344000, 1440000, 1536000, 1632000, 1728000, 1824000, 1920000, 2016000, 2112000, 2208000, 2304000, 2400000, 2496000, 2592000, 2688000, 2784000, 2880000, 2900000 } },
-        { 9, { 672000, 768000, 864000, 960000, 1056000, 1152000, 1248000, 1344000, 1440000, 1536000, 1632000, 1728000, 1824000, 1920000, 2016000, 2112000, 2208000, 2304000, 2400000, 2496000, 2592000, 2688000, 2784000, 2880000, 2976000, 3072000, 3207000 } }
-    }},
-	{ "Fold4", {
-		{ 0, { 300000, 441600, 556800, 691200, 806400, 940800, 1056000, 1132800, 1228800, 1324800, 1440000, 1555200, 1670400, 1804800, 1920000, 2016000} },
-		{ 4, { 633600, 768000, 883200, 998400, 1113600, 1209600, 1324800, 1440000, 1555200, 1651200, 1766400, 1881600, 1996800, 2112000, 2227200, 2342400, 2457600, 2572800, 2649600, 2745600 } },
-		{ 7, { 787200, 921600, 1036800, 1171200, 1286400, 1401600, 1536000, 1651200, 1766400, 1881600, 1996800, 2131200, 2246400, 2361600, 2476800, 2592000, 2707200, 2822400, 2918400, 2995200 } }
-	}},
-	{ "Pixel9", {
-		{ 0, { 820000, 955000, 1098000, 1197000, 1328000, 1425000, 1548000, 1696000, 1849000, 1950000 } },
-		{ 4, { 357000, 578000, 648000, 787000, 910000, 1065000, 1221000, 1328000, 1418000, 1549000, 1795000, 1945000, 2130000, 2245000, 2367000, 2450000, 2600000 } },
-		{ 7, { 700000, 1164000, 1396000, 1557000, 1745000, 1885000, 1999000, 2147000, 2294000, 2363000, 2499000, 2687000, 2802000, 2914000, 2943000, 2970000, 3015000, 3105000 } }
-	}}
-};
 
-const std::map<std::string, std::vector<int>> DVFS::ddrfreq = {
-    { "S22_Ultra", { 547000, 768000, 1555000, 1708000, 2092000, 2736000, 3196000 } },
-    { "S24", { 421000, 676000, 845000, 1014000, 1352000, 1539000, 1716000, 2028000, 2288000, 2730000, 3172000, 3738000, 4206000 } },
-    { "Fold4", { 547000, 768000, 1555000, 1708000, 2092000, 2736000, 3196000 } },
-    { "Pixel9", { 421000, 546000, 676000, 845000, 1014000, 1352000, 1539000, 1716000, 2028000, 2288000, 2730000, 3172000, 3744000 } }
-};
+#include <chrono>
 
+// MIF(devfreq) node: Pixel 9 and S24 have same base path
+static const std::string MIF_DEVFREQ_BASE = "/sys/devices/platform/17000010.devfreq_mif/devfreq/17000010.devfreq_mif";
 
+// DVFS --------------------------------------
 const std::map<std::string, std::vector<std::string>> DVFS::empty_thermal = {
     { "S22_Ultra", { "sdr0-pa0", "sdr1-pa0", "pm8350b_tz", "pm8350b-ibat-lvl0", "pm8350b-ibat-lvl1", "pm8350b-bcl-lvl0", "pm8350b-bcl-lvl1", "pm8350b-bcl-lvl2", "socd", "pmr735b_tz"}},
     { "Fold4", { "sdr0-pa0", "sdr1-pa0", "pm8350b_tz", "pm8350b-ibat-lvl0", "pm8350b-ibat-lvl1", "pm8350b-bcl-lvl0", "pm8350b-bcl-lvl1", "pm8350b-bcl-lvl2", "socd", "pmr735b_tz", "qcom,secure-non"}},
@@ -42,22 +17,246 @@ const std::map<std::string, std::vector<std::string>> DVFS::empty_thermal = {
 
 
 // consturctor
-DVFS::DVFS(const std::string& device_name) : Device(device_name) { output_filename = ""; }
+DVFS::DVFS(const std::string& device_name) : Device(device_name) {
+    output_filename = "";
+
+    // built-in OPP tables
+    const DeviceDesc* desc = find_device_desc(device_name);
+    if (desc) {
+        for (int c = 0; c < desc->num_clusters; ++c) {
+            const ClusterDesc& cl = desc->clusters[c];
+            cpu_table[cl.policy] = std::vector<int>(cl.opp.begin(), cl.opp.end());
+        }
+        ddr_table.assign(desc->ddr.begin(), desc->ddr.end());
+    }
+    rebuild_slots();
+}
 DVFS::~DVFS() { close_fd_cache(); }
 
 
 const std::map<int, std::vector<int>>& DVFS::get_cpu_freq() const {
-    return cpufreq.at(device);
+    return cpu_table;
 }
 const std::vector<std::string>& DVFS::get_empty_thermal() const {
-    return empty_thermal.at(device);
+    static const std::vector<std::string> none;
+    auto it = empty_thermal.find(device);
+    return it != empty_thermal.end() ? it->second : none;
 }
 
 const std::vector<int>& DVFS::get_ddr_freq() const {
-    return ddrfreq.at(device);
+    return ddr_table;
+}
+
+// compare a discovered table with the built-in one and report the difference
+static void validate_table(const std::string& name, const std::vector<int>& builtin, const std::vector<int>& found) {
+    if (builtin.empty() || builtin == found) return;
+
+    if (builtin.size() != found.size()) {
+        fprintf(stderr, "[DVFS] %s OPP table differs from built-in (%zu vs %zu entries)\n",
+                name.c_str(), found.size(), builtin.size());
+        return;
+    }
+    for (std::size_t i = 0; i < found.size(); ++i) {
+        if (found[i] != builtin[i]) {
+            fprintf(stderr, "[DVFS] %s OPP[%zu] differs from built-in (%d vs %d kHz)\n",
+                    name.c_str(), i, found[i], builtin[i]);
+        }
+    }
+}
+
+int DVFS::load_freq_tables(const std::string& cache_path) {
+    const std::string path = cache_path.empty() ? opp_cache_path(device) : cache_path;
+    const std::string key = opp_cache_key(device);
+
+    // 1) cache hit: no sysfs scan
+    OppTables found;
+    bool cached = load_opp_cache(path, key, found);
+    if (!cached) {
+        scan_opp_tables(cluster_indices, sysfs_root + "/sys/devices/system/cpu/cpufreq", sysfs_root + MIF_DEVFREQ_BASE, found);
+    }
+
+    // 2) validate and adopt (missing entries fall back to built-in)
+    bool discovered = false;
+    for (int policy : cluster_indices) {
+        auto it = found.cpu.find(policy);
+        if (it == found.cpu.end() || it->second.empty()) {
+            fprintf(stderr, "[DVFS] policy%d available frequencies not found, built-in table kept\n", policy);
+            continue;
+        }
+        validate_table("policy" + std::to_string(policy), cpu_table[policy], it->second);
+        cpu_table[policy] = it->second;
+        discovered = true;
+    }
+    if (!found.ddr.empty()) {
+        validate_table("MIF", ddr_table, found.ddr);
+        ddr_table = found.ddr;
+        discovered = true;
+    } else {
+        fprintf(stderr, "[DVFS] MIF available frequencies not found, built-in table kept\n");
+    }
+
+    rebuild_slots();
+
+    // 3) store fresh scan results for the next launch
+    if (!cached && discovered && !save_opp_cache(path, key, found)) {
+        fprintf(stderr, "[DVFS] OPP cache write failed: %s\n", path.c_str());
+    }
+
+    return discovered ? 0 : 1;
+}
+
+void DVFS::rebuild_slots() {
+    std::lock_guard<std::mutex> lk(io_mu);
+
+    cpu_opp.clear();
+    cpu_slots.clear();
+    for (int policy : cluster_indices) {
+        OppSlot slot;
+        slot.begin = (int)cpu_opp.size();
+        auto it = cpu_table.find(policy);
+        if (it != cpu_table.end()) {
+            cpu_opp.insert(cpu_opp.end(), it->second.begin(), it->second.end());
+            slot.size = (int)it->second.size();
+        }
+        cpu_slots.push_back(slot);
+    }
+    mif.set_freqs(ddr_table);
+    rebuild_cpu_map();
+}
+
+int DVFS::rebuild_cpu_map() {
+    std::vector<CpuMapCluster> clusters;
+    const Topology topo = sysfs_root.empty() ? Topology::system() : Topology::detect(sysfs_root + "/sys/devices/system/cpu");
+    for (int policy : cluster_indices) {
+        CpuMapCluster c;
+        auto it = energy_model.find(policy);
+        if (it != energy_model.end()) c = it->second;
+        c.policy = policy;
+        auto t = cpu_table.find(policy);
+        c.opp = (t != cpu_table.end()) ? t->second : std::vector<int>();
+        c.capacity = topo.get_capacity(policy);
+        clusters.push_back(c);
+    }
+    return build_cpu_map(cpu_map, clusters, cpu_map_overrides, cpu_map_lut);
+}
+
+int DVFS::set_cpu_map(CpuMap m, const std::map<int, std::vector<int>>& overrides) {
+    const CpuMap prev_map = cpu_map;
+    const std::map<int, std::vector<int>> prev_overrides = cpu_map_overrides;
+    cpu_map = m;
+    cpu_map_overrides = overrides;
+    int rc = rebuild_cpu_map();
+    if (rc != 0) {
+        // keep the previous mapping
+        cpu_map = prev_map;
+        cpu_map_overrides = prev_overrides;
+        rebuild_cpu_map();
+    }
+    return rc;
+}
+
+int DVFS::load_energy_model() {
+    std::vector<CpuMapCluster> clusters;
+    for (int policy : cluster_indices) {
+        CpuMapCluster c;
+        c.policy = policy;
+        auto t = cpu_table.find(policy);
+        if (t != cpu_table.end()) c.opp = t->second;
+        clusters.push_back(c);
+    }
+    ::load_energy_model(clusters, sysfs_root);
+    int found = 0;
+    for (auto& c : clusters) {
+        if (c.cost.empty() && c.inefficient.empty()) {
+            // no kernel energy model: energy per cycle ~ C x V^2
+            const std::vector<int> uv = get_cpu_volt(c.policy);
+            if (std::none_of(uv.begin(), uv.end(), [](int v) { return v > 0; })) continue;
+            for (int v : uv) c.cost.push_back(v > 0 ? (double)v * v : NAN);
+        }
+        energy_model[c.policy] = c;
+        ++found;
+    }
+    rebuild_cpu_map();
+    return found;
+}
+
+int DVFS::load_voltages(const std::string& path) {
+    cpu_volt.clear();
+    ddr_volt.clear();
+
+    // 1) debugfs opp tree (cpuN, mif device)
+    std::map<std::string, VoltTable> found;
+    load_volt_debugfs(sysfs_root, found);
+    for (const auto& kv : found) {
+        if (kv.first.compare(0, 3, "cpu") == 0) cpu_volt[atoi(kv.first.c_str() + 3)] = kv.second;
+        else if (kv.first.find("mif") != std::string::npos) ddr_volt = kv.second;
+    }
+
+    // 2) devicetree operating-points-v2 (policy = first cpu)
+    const std::string dt_base = sysfs_root + "/sys/firmware/devicetree/base";
+    for (int policy : cluster_indices) {
+        if (cpu_volt.count(policy)) continue;
+        VoltTable t;
+        if (load_volt_devicetree(sysfs_root + "/sys/devices/system/cpu/cpu" + std::to_string(policy) + "/of_node", dt_base, t) > 0) {
+            cpu_volt[policy] = t;
+        }
+    }
+    if (ddr_volt.empty()) {
+        const std::string mif_dev = MIF_DEVFREQ_BASE.substr(0, MIF_DEVFREQ_BASE.find("/devfreq/"));
+        load_volt_devicetree(sysfs_root + mif_dev + "/of_node", dt_base, ddr_volt);
+    }
+
+    // 3) user file (overrides)
+    if (!path.empty()) {
+        std::map<std::string, VoltTable> user;
+        int rc = load_volt_file(path, user);
+        if (rc < 0) {
+            fprintf(stderr, "[DVFS] voltage file %s: %s\n", path.c_str(), rc == -1 ? "not readable" : "syntax error");
+            return -1;
+        }
+        for (const auto& kv : user) {
+            const std::string& d = kv.first;
+            VoltTable* t = nullptr;
+            if (d == "mif" || d == "MIF") t = &ddr_volt;
+            else if (d.compare(0, 6, "policy") == 0) t = &cpu_volt[atoi(d.c_str() + 6)];
+            else if (d.compare(0, 3, "cpu") == 0) t = &cpu_volt[atoi(d.c_str() + 3)];
+            if (!t) {
+                fprintf(stderr, "[DVFS] voltage file: unknown domain %s\n", d.c_str());
+                continue;
+            }
+            for (const auto& fv : kv.second) (*t)[fv.first] = fv.second;
+        }
+    }
+
+    int domains = ddr_volt.empty() ? 0 : 1;
+    for (int policy : cluster_indices) {
+        const std::vector<int> uv = get_cpu_volt(policy);
+        if (std::any_of(uv.begin(), uv.end(), [](int v) { return v > 0; })) ++domains;
+    }
+    return domains;
+}
+
+std::vector<int> DVFS::get_cpu_volt(int policy) const {
+    auto t = cpu_table.find(policy);
+    if (t == cpu_table.end()) return {};
+    auto v = cpu_volt.find(policy);
+    return align_voltages(t->second, v != cpu_volt.end() ? v->second : VoltTable());
+}
+
+std::vector<int> DVFS::get_ddr_volt() const {
+    return align_voltages(ddr_table, ddr_volt);
 }
 
 std::vector<int> DVFS::get_cpu_freqs_conf(int prime_cpu_index){
+    // no table for some cluster (unknown device without OPP discovery)
+    if (this->cluster_indices.empty()) return {};
+    for (auto cluster_idx : this->cluster_indices){
+        if (this->get_cpu_freq().count(cluster_idx) == 0) return {};
+    }
+
+    // resolved mapping (see set_cpu_map)
+    if (prime_cpu_index >= 0 && prime_cpu_index < (int)cpu_map_lut.size()) return cpu_map_lut[prime_cpu_index];
+
     int prime_cluster_id = this->cluster_indices[this->cluster_indices.size()-1];
     int max_prime_cluster_idx = this->get_cpu_freq().at(prime_cluster_id).size()-1;
     
@@ -86,91 +285,32 @@ std::vector<int> DVFS::get_cpu_freqs_conf(int prime_cpu_index){
 // Collector ----------------------------------
 Collector::Collector(const std::string& device_name) : Device(device_name) {}
 
-// pixel9
-// BIG: thermal/thermal_zone0
-// MID: thermal/thermal_zone1
-const std::map<std::string, std::vector<std::string>> Collector::thermal_zones_cpu = {
-    { "Pixel9", { /*BIG*/ "/sys/devices/virtual/thermal/thermal_zone0", /*MID*/ "/sys/devices/virtual/thermal/thermal_zone1" } }
-};
+int Collector::open_thermal(const std::string& root) {
+    thermal.open(device, root);
+    return thermal.count_cpu();
+}
 
 double Collector::collect_high_temp(){
-    if (this->device != "Pixel9") return 0.0;
-
-    std::string command = "su -c \"";
-    for (auto zone_path : this->thermal_zones_cpu.at(this->device)){
-        command += std::string("awk '{print \\$1/1000}' ")+zone_path+std::string("/temp; ");
-    }
-    command += "\""; // closing quote
-
-    std::string output = execute_cmd(command.c_str());
-    std::vector<std::string> temps = split_string(output);
-
-    // print high temperature
-    std::vector<double> temp_vals = {};
-    for (auto t_str : temps){
-        temp_vals.push_back(std::stod(t_str));
-    }
+    if (!thermal.is_scanned()) open_thermal();
+    const double high = thermal.max_cpu();
+    return std::isnan(high) ? 0.0 : high;
+}
 
-    return std::max_element(temp_vals.begin(), temp_vals.end())[0];
+double Collector::collect_temp(ThermalRole role) {
+    if (!thermal.is_scanned()) open_thermal();
+    return thermal.max_of(role);
 }
 
 // -------------------------------------------
 
 
-int DVFS::open_wr(const std::string& path) {
-    // open with O_CLOEXEC to prevent FD leak to child processes
-    int fd = open(path.c_str(), O_WRONLY | O_CLOEXEC);
-    if (fd < 0) {
-        fprintf(stderr, "[DVFS] open failed: %s (%s)\n", path.c_str(), strerror(errno));
-    }
-    return fd;
-}
-
-void DVFS::close_fd(int& fd) {
-    // close fd
-    if (fd >= 0) {
-        close(fd);
-        fd = -1;
-    }
-}
-
-bool DVFS::try_open_first(const std::vector<std::string>& candidates, int& out_fd) {
-    // try open files in candidates sequentially
-    for (const auto& p : candidates) {
-        int fd = open_wr(p);
-        if (fd >= 0) {
-            out_fd = fd;
-            return true;
-        }
-    }
-    out_fd = -1;
-    return false;
-}
+int DVFS::resync_state() {
+    std::lock_guard<std::mutex> lk(io_mu);
+    if (!fd_ready) return 2;
 
-int DVFS::write_fd_int(int fd, long long v) {
-    // write integer status to fd
-    
-    if (fd < 0) return -1;
-
-    char buf[64];
-    int len = snprintf(buf, sizeof(buf), "%lld\n", v);
-    if (len <= 0) return -2;
-
-    // sysfs: offset 0 write is safe
-    (void)lseek(fd, 0, SEEK_SET);
-
-    const char* p = buf;
-    int left = len;
-    while (left > 0) {
-        ssize_t n = write(fd, p, left);
-        if (n < 0) {
-            if (errno == EINTR) continue;
-            fprintf(stderr, "[DVFS] write failed (fd=%d): %s\n", fd, strerror(errno));
-            return -3;
-        }
-        p += n;
-        left -= (int)n;
-    }
+    for (auto& p : cpu_fds) sysfs::sync_range(p.range, io_stats);
+    mif.resync();
+    for (auto& d : devfreq) d.resync();
     return 0;
 }
 
@@ -189,16 +329,18 @@ int DVFS::init_fd_cache() {
         p.policy_idx = idx;
 
         //  Pixel9 and S24 have same path structure
-        const std::string base = "/sys/devices/system/cpu/cpufreq/policy" + std::to_string(idx);
-        p.max_fd = open_wr(base + "/scaling_max_freq");
-        p.min_fd = open_wr(base + "/scaling_min_freq");
+        const std::string base = sysfs_root + "/sys/devices/system/cpu/cpufreq/policy" + std::to_string(idx);
+        p.range.max_fd = sysfs::open_wr(base + "/scaling_max_freq");
+        p.range.min_fd = sysfs::open_wr(base + "/scaling_min_freq");
+        p.cur_fd = sysfs::open_rd(base + "/scaling_cur_freq");
 
-        if (p.max_fd < 0 || p.min_fd < 0) {
+        if (p.range.max_fd < 0 || p.range.min_fd < 0) {
             fprintf(stderr, "[DVFS] policy%d open incomplete (need root?)\n", idx);
-            close_fd(p.max_fd);
-            close_fd(p.min_fd);
+            sysfs::close_fd(p.range.max_fd);
+            sysfs::close_fd(p.range.min_fd);
+            sysfs::close_fd(p.cur_fd);
             // if failure, close all and return error
-            close_fd_cache();
+            close_fd_cache_nolock();
             fd_ready = false;
             return -1;
         }
@@ -206,45 +348,36 @@ int DVFS::init_fd_cache() {
         cpu_fds.push_back(p);
     }
 
-    // MIF(devfreq) fds (RAM)
-    // Pixel 9 and S24 have same base path
-    mif_fds.base = "/sys/devices/platform/17000010.devfreq_mif/devfreq/17000010.devfreq_mif";
-    {
-        // Depending on device and kernel, the min/max path differs
-        std::vector<std::string> min_candidates = {
-            mif_fds.base + "/scaling_devfreq_min", // S24
-            mif_fds.base + "/min_freq", // Pixel9
-            mif_fds.base + "/scaling_min_freq"
-        };
-
-        std::vector<std::string> max_candidates;
-        if (get_device_name() == "Pixel9") {
-            max_candidates = {
-                mif_fds.base + "/max_freq", // Pixel9 preferred
-                mif_fds.base + "/scaling_devfreq_max"
-            };
-        } else {
-            max_candidates = {
-                mif_fds.base + "/scaling_devfreq_max", // S24 preferred
-                mif_fds.base + "/max_freq"
-            };
-        }
+    // MIF(devfreq) domain (RAM)
+    // Depending on device and kernel, the min/max node name differs
+    mif = DevfreqDomain(sysfs_root + MIF_DEVFREQ_BASE);
+    mif.set_freqs(ddr_table); // indices follow the DVFS table
+    mif.set_verify(verify);
+    const std::vector<std::string> min_names = { "scaling_devfreq_min" /*S24*/, "min_freq" /*Pixel9*/, "scaling_min_freq" };
+    const std::vector<std::string> max_names = (get_device_name() == "Pixel9")
+        ? std::vector<std::string>{ "max_freq", "scaling_devfreq_max" }
+        : std::vector<std::string>{ "scaling_devfreq_max", "max_freq" };
+    int rc = mif.open(min_names, max_names);
+    if (rc != 0) {
+        close_fd_cache_nolock();
+        fd_ready = false;
+        return (rc == -1) ? -2 : -3;
+    }
 
-        if (!try_open_first(min_candidates, mif_fds.min_fd)) {
-            fprintf(stderr, "[DVFS] MIF min open failed (need root? path mismatch)\n");
-            close_fd_cache();
-            fd_ready = false;
-            return -2;
-        }
-        if (!try_open_first(max_candidates, mif_fds.max_fd)) {
-            fprintf(stderr, "[DVFS] MIF max open failed (need root? path mismatch)\n");
-            close_fd_cache();
-            fd_ready = false;
-            return -3;
-        }
+    // extra devfreq domains (add_devfreq())
+    for (auto& d : devfreq) {
+        if (d.open() != 0) fprintf(stderr, "[DVFS] devfreq %s not controllable\n", d.get_name().c_str());
     }
 
     fd_ready = true;
+    io_stats = IoStats();
+
+    // seed the state cache with the current min/max
+    for (auto& p : cpu_fds) {
+        long long v;
+        if (sysfs::read_int(p.range.min_fd, v) == 0) p.range.cur_min = (int)v;
+        if (sysfs::read_int(p.range.max_fd, v) == 0) p.range.cur_max = (int)v;
+    }
     return 0;
 }
 
@@ -258,18 +391,139 @@ void DVFS::close_fd_cache_nolock() {
     // close all cached fds with no lock
     // assume io_mu is already locked
     // to avoid deadlock
+    restore_governors_nolock();
     for (auto& p : cpu_fds) {
-        close_fd(p.max_fd);
-        close_fd(p.min_fd);
+        sysfs::close_fd(p.range.max_fd);
+        sysfs::close_fd(p.range.min_fd);
+        sysfs::close_fd(p.cur_fd);
     }
     cpu_fds.clear();
 
-    close_fd(mif_fds.min_fd);
-    close_fd(mif_fds.max_fd);
+    mif.close();
+    for (auto& d : devfreq) d.close();
 
     fd_ready = false;
 }
 
+// userspace governor
+int DVFS::set_userspace(bool on) {
+    std::lock_guard<std::mutex> lk(io_mu);
+
+    if (!fd_ready) {
+        fprintf(stderr, "[DVFS] fd cache not ready. call init_fd_cache() first.\n");
+        return 2;
+    }
+    if (!on) return restore_governors_nolock();
+    if (userspace) return 0;
+
+    std::vector<std::string> bases;
+    for (const auto& p : cpu_fds) {
+        const std::string base = sysfs_root + "/sys/devices/system/cpu/cpufreq/policy" + std::to_string(p.policy_idx);
+        std::string avail;
+        if (!sysfs::read_text(base + "/scaling_available_governors", avail) ||
+            (" " + avail + " ").find(" userspace ") == std::string::npos) {
+            fprintf(stderr, "[DVFS] policy%d: no userspace governor\n", p.policy_idx);
+            return 1;
+        }
+        bases.push_back(base);
+    }
+
+    userspace = true; // restore_governors_nolock() undoes a partial switch
+    for (std::size_t i = 0; i < cpu_fds.size(); ++i) {
+        CpuPolicyFD& p = cpu_fds[i];
+        const OppSlot& slot = cpu_slots[i];
+        int set_fd = sysfs::open_wr(bases[i] + "/scaling_setspeed");
+        p.gov_fd = sysfs::open_wr(bases[i] + "/scaling_governor");
+        bool ok = set_fd >= 0 && p.gov_fd >= 0 && slot.size > 0 &&
+                  sysfs::read_text(bases[i] + "/scaling_governor", p.saved_gov) && !p.saved_gov.empty();
+        // full range first: scaling_setspeed is clamped by min/max
+        ok = ok && sysfs::write_range(p.range, cpu_opp[slot.begin], cpu_opp[slot.begin + slot.size - 1], false, io_stats) == 0;
+        ok = ok && sysfs::write_text(p.gov_fd, "userspace") == 0;
+        if (!ok) {
+            sysfs::close_fd(set_fd);
+            restore_governors_nolock();
+            return 5;
+        }
+        io_stats.writes++;
+        p.range.set_fd = set_fd;
+        p.range.cur_min = p.range.cur_max = -1; // first setspeed always written
+    }
+    return 0;
+}
+
+int DVFS::restore_governors_nolock() {
+    if (!userspace) return 0;
+
+    int rc = 0;
+    for (auto& p : cpu_fds) {
+        if (p.gov_fd < 0) continue;
+        if (!p.saved_gov.empty() && sysfs::write_text(p.gov_fd, p.saved_gov) != 0) {
+            fprintf(stderr, "[DVFS] policy%d: %s governor not restored\n", p.policy_idx, p.saved_gov.c_str());
+            rc = 5;
+        }
+        sysfs::close_fd(p.range.set_fd);
+        sysfs::close_fd(p.gov_fd);
+        p.saved_gov.clear();
+        sysfs::sync_range(p.range, io_stats);
+    }
+    userspace = false;
+    return rc;
+}
+
+// extra devfreq domains
+int DVFS::add_devfreq(const std::string& name) {
+    std::lock_guard<std::mutex> lk(io_mu);
+    for (const auto& d : devfreq) {
+        if (d.get_name() == name) return 0;
+    }
+
+    DevfreqDomain d(DevfreqDomain::class_path(name, sysfs_root));
+    if (d.get_freqs().empty()) {
+        fprintf(stderr, "[DVFS] devfreq %s not found (no available_frequencies)\n", name.c_str());
+        return 1;
+    }
+    d.set_verify(verify);
+    if (fd_ready && d.open() != 0) return 2;
+    devfreq.push_back(std::move(d));
+    return 0;
+}
+
+const DevfreqDomain* DVFS::find_devfreq(const std::string& name) const {
+    for (const auto& d : devfreq) {
+        if (d.get_name() == name) return &d;
+    }
+    return nullptr;
+}
+
+std::vector<DevfreqReading> DVFS::read_devfreq() const {
+    std::lock_guard<std::mutex> lk(io_mu);
+    std::vector<DevfreqReading> out;
+    out.reserve(devfreq.size());
+    for (const auto& d : devfreq) {
+        DevfreqReading r;
+        r.name = d.get_name();
+        r.min_khz = d.get_min();
+        r.max_khz = d.get_max();
+        r.cur_khz = d.get_cur();
+        out.push_back(r);
+    }
+    return out;
+}
+
+void DVFS::set_verify(bool on) {
+    std::lock_guard<std::mutex> lk(io_mu);
+    verify = on;
+    mif.set_verify(on);
+    for (auto& d : devfreq) d.set_verify(on);
+}
+
+DVFS::IoStats DVFS::get_io_stats() const {
+    IoStats total = io_stats;
+    total += mif.get_io_stats();
+    for (const auto& d : devfreq) total += d.get_io_stats();
+    return total;
+}
+
 // 3) set/unset: directly write if FD cache is ready
 int DVFS::set_cpu_freq(const std::vector<int>& freq_indices) {
     if ((int)cluster_indices.size() != (int)freq_indices.size()) return 1;
@@ -281,28 +535,60 @@ int DVFS::set_cpu_freq(const std::vector<int>& freq_indices) {
         return 2;
     }
 
-    // max first, min last (protect min > max being set)
-    for (int i = 0; i < (int)cluster_indices.size(); ++i) {
-        int policy = cluster_indices[i];
-        int freq_idx = freq_indices[i];
-
-        const auto& table = cpufreq.at(device).at(policy);
-        if (freq_idx < 0 || freq_idx >= (int)table.size()) return 3;
+    for (std::size_t i = 0; i < freq_indices.size(); ++i) {
+        if (freq_indices[i] < 0 || freq_indices[i] >= cpu_slots[i].size) return 3;
+    }
+    // every cluster is written, even after a failed one: a clamped little
+    // cluster must not leave the prime at its old clock
+    int rc = 0;
+    for (std::size_t i = 0; i < freq_indices.size(); ++i) {
+        const int r = set_cluster_freq_nolock((int)i, freq_indices[i]);
+        // a write failure outranks a mismatch (7), a mismatch a clamp (6)
+        rc = (rc == 5 || r == 5) ? 5 : std::max(rc, r);
+    }
+    return rc;
+}
 
-        int clk = table[freq_idx];
+int DVFS::set_cluster_freq(int slot, int freq_idx) {
+    if (slot < 0 || slot >= (int)cluster_indices.size()) return 1;
 
-        // search corresponding policy fd (if sequence is identical, cpu_fds[i] can be used directly)
-        // safe policy match
-        CpuPolicyFD* fdp = nullptr;
-        for (auto& p : cpu_fds) if (p.policy_idx == policy) { fdp = &p; break; }
-        if (!fdp) return 4;
+    std::lock_guard<std::mutex> lk(io_mu);
 
-        if (write_fd_int(fdp->max_fd, clk) != 0) return 5;
-        if (write_fd_int(fdp->min_fd, clk) != 0) return 6;
+    if (!fd_ready) {
+        fprintf(stderr, "[DVFS] fd cache not ready. call init_fd_cache() first.\n");
+        return 2;
     }
+    return set_cluster_freq_nolock(slot, freq_idx);
+}
+
+int DVFS::set_cluster_freq_nolock(int slot, int freq_idx) {
+    // slot i: cluster_indices[i], cpu_slots[i] and cpu_fds[i] (same order as init_fd_cache())
+    const OppSlot& s = cpu_slots[slot];
+    if (freq_idx < 0 || freq_idx >= s.size) return 3;
+
+    int clk = cpu_opp[s.begin + freq_idx];
+    CpuPolicyFD& fdp = cpu_fds[slot];
+
+    // min = max = clk (ordered by direction, no-op writes skipped)
+    int rc = sysfs::write_range(fdp.range, clk, clk, verify, io_stats);
+    if (rc == -1) return 5;
+    if (rc == -3) return 6;
+    if (rc == -2) return 7;
     return 0;
 }
 
+int DVFS::get_cur_cpu_freq(int slot) {
+    // no lock: read-only fd, never closed while fd_ready
+    if (!fd_ready || slot < 0 || slot >= (int)cpu_fds.size()) return -1;
+    long long v;
+    return (sysfs::read_int(cpu_fds[slot].cur_fd, v) == 0) ? (int)v : -1;
+}
+
+int DVFS::get_cur_ram_freq() {
+    if (!fd_ready) return -1;
+    return mif.get_cur();
+}
+
 int DVFS::unset_cpu_freq() {
     // unset to default (min: lowest, max: highest)
 
@@ -313,19 +599,30 @@ int DVFS::unset_cpu_freq() {
         return 2;
     }
 
-    for (int policy : cluster_indices) {
-        const auto& table = cpufreq.at(device).at(policy);
-        int min_clk = table.front();
-        int max_clk = table.back();
-
-        CpuPolicyFD* fdp = nullptr;
-        for (auto& p : cpu_fds) if (p.policy_idx == policy) { fdp = &p; break; }
-        if (!fdp) return 4;
+    // every cluster is released, even after a failed one
+    int rc = 0;
+    for (std::size_t i = 0; i < cpu_fds.size(); ++i) {
+        const OppSlot& slot = cpu_slots[i];
+        if (slot.size == 0) {
+            if (rc == 0) rc = 3;
+            continue;
+        }
+        int min_clk = cpu_opp[slot.begin];
+        int max_clk = cpu_opp[slot.begin + slot.size - 1];
 
-        if (write_fd_int(fdp->max_fd, max_clk) != 0) return 5;
-        if (write_fd_int(fdp->min_fd, min_clk) != 0) return 6;
+        const int w = sysfs::write_range(cpu_fds[i].range, min_clk, max_clk, verify, io_stats);
+        if (w == -1) rc = 5;
+        else if (w == -2 && rc != 5) rc = 7;
+        else if (w == -3 && rc == 0) rc = 6;
     }
-    return 0;
+    return rc;
+}
+
+// DevfreqDomain::set_range() codes to the cpu ones (3 -> 5 write failed, 5 -> 7 mismatch, 6 clamped)
+static int ram_rc(int rc) {
+    if (rc == 3) return 5;
+    if (rc == 5) return 7;
+    return rc;
 }
 
 int DVFS::set_ram_freq(const int freq_idx) {
@@ -340,11 +637,7 @@ int DVFS::set_ram_freq(const int freq_idx) {
     if (freq_idx < 0 || freq_idx >= (int)table.size()) return 1;
 
     int clk = table[freq_idx];
-
-    // max first, min last (policy-dependent, but this form is generally safe)
-    if (write_fd_int(mif_fds.max_fd, clk) != 0) return 3;
-    if (write_fd_int(mif_fds.min_fd, clk) != 0) return 4;
-    return 0;
+    return ram_rc(mif.set_range(clk, clk));
 }
 
 int DVFS::unset_ram_freq() {
@@ -356,10 +649,158 @@ int DVFS::unset_ram_freq() {
     }
 
     const auto& table = get_ddr_freq();
-    int min_clk = table.front();
-    int max_clk = table.back();
+    if (table.empty()) return 1;
+    return ram_rc(mif.set_range(table.front(), table.back()));
+}
+// 4) transactions
+DvfsState DVFS::make_state(int prime_cpu_index, int ram_idx) {
+    DvfsState st;
+    if (prime_cpu_index < 0) st.cpu_idx.assign(cluster_indices.size(), -1);
+    else st.cpu_idx = get_cpu_freqs_conf(prime_cpu_index);
+    st.ram_idx = ram_idx;
+    return st;
+}
 
-    if (write_fd_int(mif_fds.max_fd, max_clk) != 0) return 3;
-    if (write_fd_int(mif_fds.min_fd, min_clk) != 0) return 4;
-    return 0;
-}
\ No newline at end of file
+DvfsState DVFS::get_state() {
+    std::lock_guard<std::mutex> lk(io_mu);
+
+    // pinned (min == max) domains map back to their OPP index
+    auto index_of = [](const int* first, int size, const sysfs::RangeFd& r) {
+        if (r.cur_min < 0 || r.cur_min != r.cur_max) return -1;
+        const int* it = std::lower_bound(first, first + size, r.cur_min);
+        return (it != first + size && *it == r.cur_min) ? (int)(it - first) : -1;
+    };
+
+    DvfsState st;
+    st.cpu_idx.assign(cluster_indices.size(), -1);
+    for (std::size_t i = 0; i < cpu_fds.size() && i < cpu_slots.size(); ++i) {
+        const OppSlot& s = cpu_slots[i];
+        st.cpu_idx[i] = index_of(cpu_opp.data() + s.begin, s.size, cpu_fds[i].range);
+    }
+    st.ram_idx = mif.get_pinned_index();
+    for (const auto& d : devfreq) st.devfreq_idx[d.get_name()] = d.get_pinned_index();
+    return st;
+}
+
+int DVFS::apply_state(const DvfsState& target, DvfsTxResult* result) {
+    using clock = std::chrono::steady_clock;
+    const auto t0 = clock::now();
+    auto elapsed_ns = [&t0] {
+        return (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - t0).count();
+    };
+
+    DvfsTxResult res;
+    auto finish = [&](int rc) {
+        res.rc = rc;
+        res.elapsed_ns = elapsed_ns();
+        if (result) *result = res;
+        return rc;
+    };
+
+    if (target.cpu_idx.size() != cluster_indices.size()) return finish(1);
+
+    std::lock_guard<std::mutex> lk(io_mu);
+
+    if (!fd_ready) {
+        fprintf(stderr, "[DVFS] fd cache not ready. call init_fd_cache() first.\n");
+        return finish(2);
+    }
+
+    // resolve every domain before the first write (no partial apply on a bad index)
+    // a domain is a cpufreq slot (range != nullptr) or a devfreq node (dom != nullptr)
+    struct Op {
+        int domain;
+        sysfs::RangeFd* range;
+        DevfreqDomain* dom;
+        int new_min, new_max;
+        int old_min, old_max;   // prior state (-1: unknown)
+        int full_min, full_max; // released range (rollback of an unknown state)
+    };
+    std::vector<Op> ops;
+    ops.reserve(cpu_fds.size() + 1 + devfreq.size());
+
+    auto plan = [&](int domain, int idx, const int* table, int size,
+                    sysfs::RangeFd* range, DevfreqDomain* dom) {
+        if (size == 0 || idx < -1 || idx >= size) return false;
+        const int lo = (idx < 0) ? table[0] : table[idx];
+        const int hi = (idx < 0) ? table[size - 1] : table[idx];
+        const int old_min = range ? range->cur_min : dom->get_min();
+        const int old_max = range ? range->cur_max : dom->get_max();
+        if (lo == old_min && hi == old_max) return true; // unchanged
+        ops.push_back({ domain, range, dom, lo, hi, old_min, old_max, table[0], table[size - 1] });
+        return true;
+    };
+
+    const int n_cpu = (int)cpu_fds.size();
+    for (int i = 0; i < n_cpu; ++i) {
+        const OppSlot& s = cpu_slots[i];
+        if (!plan(i, target.cpu_idx[i], cpu_opp.data() + s.begin, s.size, &cpu_fds[i].range, nullptr)) {
+            res.failed_domain = i;
+            return finish(3);
+        }
+    }
+    if (!plan(n_cpu, target.ram_idx, ddr_table.data(), (int)ddr_table.size(), nullptr, &mif)) {
+        res.failed_domain = n_cpu;
+        return finish(3);
+    }
+    for (const auto& kv : target.devfreq_idx) {
+        auto it = std::find_if(devfreq.begin(), devfreq.end(),
+                               [&kv](const DevfreqDomain& d) { return d.get_name() == kv.first; });
+        const int domain = n_cpu + 1 + (int)(it - devfreq.begin());
+        if (it == devfreq.end() || !it->is_open() ||
+            !plan(domain, kv.second, it->get_freqs().data(), (int)it->get_freqs().size(), nullptr, &*it)) {
+            res.failed_domain = domain;
+            return finish(3);
+        }
+    }
+
+    // 0 on success, -1 write failed, -2 read-back mismatch, -3 clamped by a kernel limit
+    auto write = [this](Op& o, int lo, int hi) {
+        if (o.range) return sysfs::write_range(*o.range, lo, hi, verify, io_stats);
+        int rc = o.dom->set_range(lo, hi);
+        return rc == 0 ? 0 : (rc == 6 ? -3 : (rc == 5 ? -2 : -1));
+    };
+
+    // safe order: every domain going down before any domain going up
+    std::stable_partition(ops.begin(), ops.end(),
+                          [](const Op& o) { return o.old_max >= 0 && o.new_max < o.old_max; });
+
+    int rc = 0;
+    std::size_t done = 0; // ops[0, done) touched
+    for (; done < ops.size(); ++done) {
+        Op& o = ops[done];
+        if (done > 0 && tx_timeout_ns > 0 && elapsed_ns() > tx_timeout_ns) {
+            rc = 9;
+            res.failed_domain = o.domain;
+            break;
+        }
+        int w = write(o, o.new_min, o.new_max);
+        if (w == -3) {
+            res.clamped++; // the request stands, the limit decides until it lifts
+            continue;
+        }
+        if (w != 0) {
+            rc = (w == -1) ? 5 : 7;
+            res.failed_domain = o.domain;
+            ++done; // partially written
+            break;
+        }
+    }
+    res.domains_changed = (int)done;
+    if (rc == 0) return finish(0);
+
+    // rollback in reverse order (raised domains come down first)
+    bool rollback_ok = true;
+    for (std::size_t i = done; i-- > 0;) {
+        Op& o = ops[i];
+        const bool known = (o.old_min >= 0 && o.old_max >= 0);
+        const int w = write(o, known ? o.old_min : o.full_min, known ? o.old_max : o.full_max);
+        if (w != 0 && w != -3) rollback_ok = false;
+    }
+    if (!rollback_ok) {
+        fprintf(stderr, "[DVFS] rollback failed: domains left in a mixed state\n");
+        return finish(11);
+    }
+    res.rolled_back = true;
+    return finish(rc);
+}
@@ -2,6 +2,13 @@
 #define DVFS_H
 
 #include "device.h"
+#include "device_table.h"
+#include "opp_table.h"
+#include "opp_volt.h"
+#include "cpu_map.h"
+#include "thermal.h"
+#include "devfreq.h"
+#include "sysfs_fd.h"
 #include "utils.h"
 
 #include <fcntl.h>
@@ -9,6 +16,7 @@
 #include <errno.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdint.h>
 
 #include <map>
 #include <cmath>
@@ -22,82 +30,224 @@ class Collector;
 
 class Collector : public Device {
 private:
-    // pixel9
-    // BIG: thermal/thermal_zone0
-    // MID: thermal/thermal_zone1
-    static const std::map<std::string, std::vector<std::string>> thermal_zones_cpu;
+    ThermalRegistry thermal; // zones by role, cached temp fds
 public:
     explicit Collector(const std::string& device_name);
+
+    Collector(const Collector&) = delete;
+    Collector& operator=(const Collector&) = delete;
+    Collector(Collector&& o) noexcept : Device(o), thermal(std::move(o.thermal)) {}
+
+    // scan the thermal zones (see thermal.h); return the number of cpu zones
+    int open_thermal(const std::string& root = "");
+    // highest cpu temperature in degC (0 if none; zones scanned on the first call)
     double collect_high_temp();
+    // highest temperature of a role in degC (NAN if none)
+    double collect_temp(ThermalRole role);
+    const ThermalRegistry& get_thermal() const { return thermal; }
 
 };
 
 
+/* ** DVFS transaction **
+ *
+ * A full target state: one OPP index per cpu slot (cluster_indices order),
+ * one for MIF, and one per extra devfreq domain (DVFS::add_devfreq(), by
+ * name; domains not listed are left unchanged). -1 releases the domain to
+ * its full OPP range (as unset_*).
+ *
+ * apply_state() validates every index before the first write, lowers
+ * domains before raising any, and restores the prior state of every touched
+ * domain when a write fails or the transaction runs past its timeout.
+ * A read-back clamped by a kernel limit (thermal freq_qos) is not a failure:
+ * the request is kept and counted in DvfsTxResult::clamped.
+ */
+struct DvfsState {
+    std::vector<int> cpu_idx;
+    int ram_idx = -1;
+    std::map<std::string, int> devfreq_idx;
+};
+
+struct DvfsTxResult {
+    int rc = 0;
+    int failed_domain = -1;   // cpu slot, cpu_idx.size() for MIF, then extra devfreq domains
+    int domains_changed = 0;  // domains written (no-op domains are skipped)
+    int clamped = 0;          // domains clamped by a kernel limit (freq_qos), request kept
+    int64_t elapsed_ns = 0;   // whole transaction, rollback included
+    bool rolled_back = false;
+};
+
+// one devfreq domain as seen at one instant (kHz, -1: unknown)
+struct DevfreqReading {
+    std::string name;
+    int min_khz = -1; // last programmed
+    int max_khz = -1;
+    int cur_khz = -1; // cur_freq
+};
+
+
 /* ** Example of DVFS class **
 
 DVFS dvfs("Pixel9");
+dvfs.load_freq_tables(); // optional: replace built-in OPP tables by the device ones
 if (dvfs.init_fd_cache() != 0) {
     fprintf(stderr, "FD cache initialization failed. Are you root or authorized?\n");
 }
+if (dvfs.apply_state(dvfs.make_state(12, 11)) != 0) {
+    fprintf(stderr, "DVFS transition failed (prior state restored)\n");
+}
 
 */
 class DVFS : public Device {
 private:
-    static const std::map<std::string, std::map<int, std::vector<int>>> cpufreq;
-    static const std::map<std::string, std::vector<int>> ddrfreq;
     static const std::map<std::string, std::vector<std::string>> empty_thermal;
 
+    // active OPP tables (built-in by default, replaced by load_freq_tables())
+    std::map<int, std::vector<int>> cpu_table;
+    std::vector<int> ddr_table;
+
+    // flat view of cpu_table for the write path
+    // slot i <-> cluster_indices[i] <-> cpu_fds[i]
+    struct OppSlot {
+        int begin = 0; // offset in cpu_opp
+        int size = 0;
+    };
+    std::vector<int> cpu_opp;
+    std::vector<OppSlot> cpu_slots;
+
+    std::string sysfs_root; // prefix of every sysfs path ("" = real sysfs)
+
+    // cluster frequency mapping: lut[prime_idx] = per-slot indices
+    CpuMap cpu_map = CpuMap::INDEX;
+    std::map<int, std::vector<int>> cpu_map_overrides;
+    std::vector<std::vector<int>> cpu_map_lut;
+    std::map<int, CpuMapCluster> energy_model; // policy -> EM cost/inefficient per OPP
+
+    // OPP voltages by frequency (load_voltages())
+    std::map<int, VoltTable> cpu_volt;
+    VoltTable ddr_volt;
+
 private:
     // ---- FD cache structure ----
     struct CpuPolicyFD {
         int policy_idx = -1;
-        int min_fd = -1; // scaling_min_freq
-        int max_fd = -1; // scaling_max_freq
-    };
-
-    struct MifFD {
-        int min_fd = -1; // scaling_devfreq_min (or min_freq)
-        int max_fd = -1; // scaling_devfreq_max (or max_freq)
-        std::string base;
+        sysfs::RangeFd range; // scaling_min_freq / scaling_max_freq (+ last programmed)
+        int cur_fd = -1;      // scaling_cur_freq (read-only, optional)
+        int gov_fd = -1;      // scaling_governor (userspace mode only)
+        std::string saved_gov; // governor to restore
     };
 
     std::vector<CpuPolicyFD> cpu_fds;
-    MifFD mif_fds;
+    DevfreqDomain mif;                 // RAM (indices follow ddr_table)
+    std::vector<DevfreqDomain> devfreq; // extra devfreq domains (GPU, bus, ...)
     bool fd_ready = false;
-    std::mutex io_mu; // mutex lock guard for fd cache I/O
+    bool verify = true; // read back after every write
+    bool userspace = false; // policies on the userspace governor (scaling_setspeed writes)
+    int64_t tx_timeout_ns = 0; // apply_state() budget (0: none)
+    mutable std::mutex io_mu; // mutex lock guard for fd cache I/O (and state cache reads)
+
+public:
+    // sysfs I/O counters (since init_fd_cache())
+    using IoStats = sysfs::IoStats;
+
+private:
+    IoStats io_stats;
 
 public:
     std::string output_filename;
 
 public:
     explicit DVFS(const std::string& device_name);
-    explicit ~DVFS();
+    ~DVFS();
 
     const std::map<int, std::vector<int>>& get_cpu_freq() const;
     const std::vector<int>& get_ddr_freq() const;
 	const std::vector<std::string>& get_empty_thermal() const;
 
+    // return 0 on success (3: bad index, 5: write failed, 6: clamped by a kernel limit, request kept,
+    // 7: read-back mismatch); every cluster is written before the rc is returned (5, then 7, then 6)
 	int set_cpu_freq(const std::vector<int>&);
     int unset_cpu_freq();
+    // return 0 on success (1: bad index, 5: write failed, 6: kernel clamp, 7: read-back mismatch)
     int set_ram_freq(const int freq_idx);
     int unset_ram_freq();
 
+    // single cluster (slot: position in cluster_indices)
+    int set_cluster_freq(int slot, int freq_idx);
+    // current clocks through cached fds (kHz, -1 if unavailable)
+    int get_cur_cpu_freq(int slot);
+    int get_cur_ram_freq();
+
     std::vector<int> get_cpu_freqs_conf(int prime_cpu_index);
 
+    // cluster frequency mapping of get_cpu_freqs_conf (see cpu_map.h), resolved into a table
+    // return 0 on success (1: unknown policy, 2: wrong list length, 3: bad index)
+    int set_cpu_map(CpuMap m, const std::map<int, std::vector<int>>& overrides = {});
+    CpuMap get_cpu_map() const { return cpu_map; }
+    const std::vector<std::vector<int>>& get_cpu_map_lut() const { return cpu_map_lut; }
+    // kernel energy model (debugfs) for CpuMap::EFFICIENT; clusters without one get
+    // cost = V^2 when their voltages are loaded; return the number of clusters modelled
+    int load_energy_model();
+
+    // OPP voltages (see opp_volt.h): debugfs, else devicetree, then the user file on top
+    // (domains policyN / cpuN / mif); return the number of domains with voltages (-1: bad file)
+    int load_voltages(const std::string& path = "");
+    // uV per OPP of get_cpu_freq() / get_ddr_freq() (-1: unknown)
+    std::vector<int> get_cpu_volt(int policy) const;
+    std::vector<int> get_ddr_volt() const;
+
+    // transactions (see DvfsState)
+    // return 0 on success (1: size mismatch, 2: not ready, 3: bad index,
+    // 5: write failed, 7: read-back mismatch, 9: timeout, 11: rollback failed)
+    // on 5/7/9 every touched domain is back to its prior state
+    int apply_state(const DvfsState& target, DvfsTxResult* result = nullptr);
+    DvfsState make_state(int prime_cpu_index, int ram_idx); // -1: released
+    DvfsState get_state(); // from the state cache (-1: not pinned to one OPP)
+    void set_tx_timeout_us(int us) { tx_timeout_ns = (int64_t)us * 1000; }
+
+    // OPP discovery (sysfs scan or on-disk cache, validated against built-in tables)
+    // return 0 if discovered, 1 if built-in tables are kept
+    int load_freq_tables(const std::string& cache_path = "");
+
     Collector get_collector() { return Collector(this->get_device_name()); }
 
+    // redirect sysfs paths (ex. fake tree for benchmarks); call before init_fd_cache()
+    void set_sysfs_root(const std::string& root) { sysfs_root = root; }
+
     // FD cache
     int init_fd_cache();    // sysfs open
     void close_fd_cache();  // sysfs close
     bool fd_cache_enabled() const { return fd_ready; }
 
+    // extra devfreq domains under /sys/class/devfreq (GPU, bus, cache, ...)
+    // opened with the fd cache; return 0 on success (1: not found, 2: open failed)
+    int add_devfreq(const std::string& name);
+    const std::vector<DevfreqDomain>& get_devfreq_domains() const { return devfreq; }
+    const DevfreqDomain* find_devfreq(const std::string& name) const;
+    // locked snapshot of every extra domain (safe against concurrent apply_state())
+    std::vector<DevfreqReading> read_devfreq() const;
+
+    // cpufreq userspace governor: a pinned policy costs one scaling_setspeed write
+    // instead of the min/max squeeze, and the stock governor stops re-evaluating.
+    // nothing scales in this mode: a released policy (-1) runs at the top of its range.
+    // call after init_fd_cache(); the saved governors come back with set_userspace(false)
+    // or close_fd_cache() (destructor)
+    // return 0 on success (1: userspace governor unavailable, 2: not ready, 5: write failed)
+    int set_userspace(bool on);
+    bool userspace_enabled() const { return userspace; }
+
+    // state cache: last programmed min/max are tracked per policy and devfreq domain
+    void set_verify(bool on); // read-back after writes (default: on)
+    int resync_state();       // re-read min/max (after external changes)
+    IoStats get_io_stats() const;
+
 private:
     // internal helper
-    static int open_wr(const std::string& path);
-    static int write_fd_int(int fd, long long v);
-    static void close_fd(int& fd);
-    static bool try_open_first(const std::vector<std::string>& candidates, int& out_fd);
+    int set_cluster_freq_nolock(int slot, int freq_idx);
     void close_fd_cache_nolock();
+    int restore_governors_nolock();
+    void rebuild_slots();
+    int rebuild_cpu_map();
 };
 
 #endif //DVFS_H
\ No newline at end of file
@@ -0,0 +1,305 @@
+#include "governor.h"
+#include "topology.h"
+#include "utils/clock.h"
+
+#include <stdlib.h>
+#include <time.h>
+
+#include <chrono>
+#include <memory>
+
+static int64_t thread_cpu_ns() {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0;
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// ---- policies ----
+int opp_ceil_index(const std::vector<int>& table, double khz) {
+    auto it = std::lower_bound(table.begin(), table.end(), khz,
+                               [](int f, double v) { return (double)f < v; });
+    if (it == table.end()) return (int)table.size() - 1;
+    return (int)(it - table.begin());
+}
+
+static int schedutil_with(const GovInput& in, double margin) {
+    const std::vector<int>& t = *in.table;
+    // util is measured at the current clock: scale to a frequency-invariant demand
+    const double f_cur = (in.cur_idx >= 0) ? t[in.cur_idx] : t.back();
+    return opp_ceil_index(t, margin * in.util * f_cur);
+}
+
+static int ondemand_with(const GovInput& in, double up) {
+    const std::vector<int>& t = *in.table;
+    if (in.util > up) return (int)t.size() - 1;
+    return opp_ceil_index(t, t.front() + in.util * (t.back() - t.front()));
+}
+
+int gov_schedutil(const GovInput& in) { return schedutil_with(in, 1.25); }
+
+int gov_ondemand(const GovInput& in) { return ondemand_with(in, 0.80); }
+
+int gov_performance(const GovInput& in) { return (int)in.table->size() - 1; }
+
+int gov_powersave(const GovInput&) { return 0; }
+
+GovPolicy gov_schedutil_margin(double margin) {
+    return [margin](const GovInput& in) { return schedutil_with(in, margin); };
+}
+
+GovPolicy gov_ondemand_threshold(double up) {
+    return [up](const GovInput& in) { return ondemand_with(in, up); };
+}
+
+GovPolicy gov_policy_by_name(const std::string& name) {
+    const std::size_t colon = name.find(':');
+    if (colon != std::string::npos) {
+        char* end;
+        const std::string arg = name.substr(colon + 1);
+        const double v = strtod(arg.c_str(), &end);
+        if (arg.empty() || *end != '\0' || !(v > 0.0)) return GovPolicy();
+        if (name.compare(0, colon, "schedutil") == 0) return gov_schedutil_margin(v);
+        if (name.compare(0, colon, "ondemand") == 0) return gov_ondemand_threshold(v);
+        return GovPolicy();
+    }
+    if (name == "schedutil") return gov_schedutil;
+    if (name == "ondemand") return gov_ondemand;
+    if (name == "performance") return gov_performance;
+    if (name == "powersave") return gov_powersave;
+    return GovPolicy();
+}
+
+
+// ---- utilization sampler ----
+UtilSampler::UtilSampler(UtilSource source, int num_cpus) : source(source) {
+    if (num_cpus <= 0) num_cpus = Topology::system().num_cpus();
+    if (num_cpus <= 0) num_cpus = 1;
+    prev_busy.assign(num_cpus, 0);
+    prev_total.assign(num_cpus, 0);
+    util.assign(num_cpus, 0.0);
+
+    if (source == UtilSource::PROC_STAT) {
+        stat_fd = sysfs::open_rd("/proc/stat");
+        buf.resize(16384);
+        long hz = sysconf(_SC_CLK_TCK);
+        if (hz > 0) tick_ns = 1000000000LL / hz;
+    } else {
+        idle_fds.resize(num_cpus);
+        for (int cpu = 0; cpu < num_cpus; ++cpu) {
+            const std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/cpuidle/state";
+            for (int k = 0;; ++k) {
+                int fd = sysfs::open_rd(base + std::to_string(k) + "/time");
+                if (fd < 0) break;
+                idle_fds[cpu].push_back(fd);
+            }
+        }
+    }
+    std::vector<double> dummy;
+    sample(dummy); // prime the counters
+}
+
+UtilSampler::~UtilSampler() {
+    sysfs::close_fd(stat_fd);
+    for (auto& fds : idle_fds) {
+        for (int& fd : fds) sysfs::close_fd(fd);
+    }
+}
+
+bool UtilSampler::ok() const {
+    if (source == UtilSource::PROC_STAT) return stat_fd >= 0;
+    for (const auto& fds : idle_fds) {
+        if (!fds.empty()) return true;
+    }
+    return false;
+}
+
+int UtilSampler::sample(std::vector<double>& out) {
+    int rc = (source == UtilSource::PROC_STAT) ? sample_proc_stat() : sample_cpuidle();
+    out = util;
+    return rc;
+}
+
+int UtilSampler::sample_proc_stat() {
+    if (stat_fd < 0) return -1;
+
+    // nothing moves within a tick: skip the (kernel-side expensive) read
+    const int64_t t = now_ns();
+    if (t - last_read_ns < tick_ns) return 0;
+    last_read_ns = t;
+
+    ssize_t n;
+    do {
+        n = pread(stat_fd, buf.data(), buf.size() - 1, 0);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) return -2;
+    buf[n] = '\0';
+
+    // "cpuN user nice system idle iowait irq softirq steal ..."
+    const char* p = buf.data();
+    while (*p) {
+        if (p[0] == 'c' && p[1] == 'p' && p[2] == 'u' && p[3] >= '0' && p[3] <= '9') {
+            char* end;
+            long cpu = strtol(p + 3, &end, 10);
+            unsigned long long v[8] = { 0 };
+            for (int i = 0; i < 8; ++i) v[i] = strtoull(end, &end, 10);
+
+            if (cpu >= 0 && cpu < (long)util.size()) {
+                unsigned long long total = 0;
+                for (unsigned long long x : v) total += x;
+                unsigned long long busy = total - v[3] - v[4]; // minus idle, iowait
+
+                unsigned long long dt = total - prev_total[cpu];
+                // counters tick at USER_HZ: hold the last value until they move
+                if (dt > 0 && prev_total[cpu] > 0) util[cpu] = (double)(busy - prev_busy[cpu]) / (double)dt;
+                prev_total[cpu] = total;
+                prev_busy[cpu] = busy;
+            }
+            p = end;
+        }
+        while (*p && *p != '\n') ++p;
+        if (*p) ++p;
+    }
+    return 0;
+}
+
+int UtilSampler::sample_cpuidle() {
+    const unsigned long long wall_us = (unsigned long long)(now_ns() / 1000);
+
+    for (std::size_t cpu = 0; cpu < idle_fds.size(); ++cpu) {
+        if (idle_fds[cpu].empty()) continue;
+        unsigned long long idle_us = 0;
+        for (int fd : idle_fds[cpu]) {
+            long long v;
+            if (sysfs::read_int(fd, v) == 0) idle_us += (unsigned long long)v;
+        }
+
+        // prev_busy: idle residency, prev_total: wall clock (us)
+        unsigned long long dt = wall_us - prev_total[cpu];
+        if (dt > 0 && prev_total[cpu] > 0) {
+            double idle = (double)(idle_us - prev_busy[cpu]) / (double)dt;
+            util[cpu] = std::min(1.0, std::max(0.0, 1.0 - idle));
+        }
+        prev_total[cpu] = wall_us;
+        prev_busy[cpu] = idle_us;
+    }
+    return ok() ? 0 : -1;
+}
+
+
+// ---- governor loop ----
+Governor::Governor(DVFS& dvfs, GovPolicy policy, GovernorConfig cfg)
+    : dvfs(dvfs), policy(std::move(policy)), cfg(cfg) {
+    const Topology& topo = Topology::system();
+    for (int p : dvfs.get_cluster_indices()) {
+        int ci = topo.cluster_of(p);
+        policy_cpus.push_back(ci >= 0 ? topo.get_clusters()[ci].cpus : std::vector<int>{ p });
+    }
+    last_change_ns.assign(policy_cpus.size(), 0);
+}
+
+Governor::~Governor() { stop(); }
+
+void Governor::start() {
+    if (running.exchange(true)) return;
+    th = std::thread(&Governor::run, this);
+}
+
+void Governor::stop() {
+    if (!running.exchange(false)) return;
+    if (th.joinable()) th.join();
+}
+
+void Governor::run() {
+    if (!dvfs.fd_cache_enabled() && dvfs.init_fd_cache() != 0) {
+        fprintf(stderr, "[Governor] FD cache initialization failed. Are you root or authorized?\n");
+    }
+
+    const std::vector<int> clusters = dvfs.get_cluster_indices();
+    std::vector<const std::vector<int>*> tables;
+    for (int p : clusters) {
+        auto it = dvfs.get_cpu_freq().find(p);
+        tables.push_back(it != dvfs.get_cpu_freq().end() && !it->second.empty() ? &it->second : nullptr);
+    }
+    cur_idx = dvfs.get_state().cpu_idx;
+
+    // /proc/stat moves once per USER_HZ tick: a shorter period needs cpuidle residency
+    std::unique_ptr<UtilSampler> sampler(new UtilSampler(cfg.source));
+    if (cfg.source == UtilSource::PROC_STAT && cfg.period_us < 10000) {
+        std::unique_ptr<UtilSampler> idle(new UtilSampler(UtilSource::CPUIDLE));
+        if (idle->ok()) {
+            fprintf(stderr, "[Governor] %d us period is under the /proc/stat tick: cpuidle residency used\n",
+                    cfg.period_us);
+            sampler = std::move(idle);
+        } else {
+            fprintf(stderr, "[Governor] %d us period is under the /proc/stat tick and cpuidle is unavailable: "
+                    "utilization refreshes every 10 ms\n", cfg.period_us);
+        }
+    }
+    if (!sampler->ok()) fprintf(stderr, "[Governor] utilization source unavailable\n");
+    std::vector<double> util;
+
+    stats = GovernorStats();
+    const int64_t period_ns = (int64_t)cfg.period_us * 1000;
+    const int64_t rate_limit_ns = (int64_t)cfg.rate_limit_us * 1000;
+    const int64_t wall0 = now_ns(), cpu0 = thread_cpu_ns();
+
+    int64_t next = wall0 + period_ns;
+    while (running.load(std::memory_order_relaxed)) {
+        std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::nanoseconds(next)));
+        const int64_t t = now_ns();
+        next += period_ns;
+        if (next < t) next = t + period_ns; // overrun: skip missed periods
+
+        sampler->sample(util);
+        for (std::size_t slot = 0; slot < clusters.size(); ++slot) {
+            if (!tables[slot]) continue;
+
+            GovInput in;
+            in.slot = (int)slot;
+            in.table = tables[slot];
+            in.cur_idx = cur_idx[slot];
+            in.now_ns = t;
+            for (int cpu : policy_cpus[slot]) {
+                if (cpu >= 0 && cpu < (int)util.size()) in.util = std::max(in.util, util[cpu]);
+            }
+
+            int idx = std::min((int)tables[slot]->size() - 1, std::max(0, policy(in)));
+            if (idx == cur_idx[slot]) continue;
+            if (t - last_change_ns[slot] < rate_limit_ns) {
+                stats.rate_limited++;
+                continue;
+            }
+            // 6: clamped by a kernel limit, the request stands (retrying would not lift it)
+            const int rc = dvfs.set_cluster_freq((int)slot, idx);
+            if (rc == 6) stats.clamped++;
+            else if (rc != 0) {
+                if (rc == 5) stats.write_errors++;
+                else stats.mismatches++;
+                continue;
+            }
+            cur_idx[slot] = idx;
+            last_change_ns[slot] = t;
+            stats.changes++;
+        }
+        stats.samples++;
+        stats.max_iter_ns = std::max(stats.max_iter_ns, now_ns() - t);
+    }
+
+    stats.wall_ns = now_ns() - wall0;
+    stats.cpu_ns = thread_cpu_ns() - cpu0;
+    if (stats.overhead() >= 0.01) {
+        fprintf(stderr, "[Governor] loop cost %.2f%% of a core (>= 1%%) at %d us: use a longer period\n",
+                100.0 * stats.overhead(), cfg.period_us);
+    }
+}
+
+std::string Governor::report() const {
+    char line[256];
+    snprintf(line, sizeof(line),
+             "governor: %ld samples @ %d us, %ld changes (%ld rate-limited, %ld clamped, %ld errors, "
+             "%ld mismatches), loop cpu %.3f%% of a core, max iteration %.1f us",
+             stats.samples, cfg.period_us, stats.changes, stats.rate_limited, stats.clamped, stats.write_errors,
+             stats.mismatches,
+             100.0 * stats.overhead(), stats.max_iter_ns / 1e3);
+    return line;
+}
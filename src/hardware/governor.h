@@ -0,0 +1,149 @@
+#ifndef GOVERNOR_H
+#define GOVERNOR_H
+
+#include "dvfs.h"
+
+#include <stdint.h>
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* ** Userspace governor **
+ *
+ * A periodic loop (1-10 ms, default 10) that samples per-cpu utilization, runs a policy
+ * per cpufreq policy and drives DVFS through the fd cache.
+ *
+ * Utilization sources:
+ * - PROC_STAT: /proc/stat through a cached fd. Counters tick at USER_HZ
+ *   (usually 10 ms): the file is re-read at most once per tick and cpus
+ *   keep their last value in between.
+ * - CPUIDLE:   cpuidle state residency (us resolution), when exposed.
+ *
+ * Policies are pure functions of a GovInput, so the same code runs offline
+ * on recorded utilization traces.
+ *
+ * ex)
+ *   Governor gov(dvfs, gov_schedutil);
+ *   gov.start();
+ *   ...
+ *   gov.stop();
+ *   printf("%s\n", gov.report().c_str());
+ */
+
+// one cpufreq policy at one sample
+struct GovInput {
+    int slot = 0;                      // position in cluster_indices
+    double util = 0.0;                 // busiest cpu of the policy, [0, 1] at the current clock
+    int cur_idx = -1;                  // current OPP index (-1: unknown)
+    const std::vector<int>* table = nullptr; // OPP table (kHz, ascending)
+    int64_t now_ns = 0;
+};
+
+// returns the next OPP index
+using GovPolicy = std::function<int(const GovInput&)>;
+
+// built-in policies
+int gov_schedutil(const GovInput& in);   // f = 1.25 * util * f_cur (frequency-invariant util with headroom)
+int gov_ondemand(const GovInput& in);    // max above 80% load, else f = f_min + util * (f_max - f_min)
+int gov_performance(const GovInput& in); // highest OPP
+int gov_powersave(const GovInput& in);   // lowest OPP
+// tunable variants: schedutil headroom (1.25 above), ondemand up threshold (0.80 above)
+GovPolicy gov_schedutil_margin(double margin);
+GovPolicy gov_ondemand_threshold(double up);
+// "name" or "name:param" (schedutil:1.1, ondemand:0.7); empty if unknown
+GovPolicy gov_policy_by_name(const std::string& name);
+
+// lowest OPP index >= khz (highest if none)
+int opp_ceil_index(const std::vector<int>& table, double khz);
+
+
+enum class UtilSource { PROC_STAT, CPUIDLE };
+
+class UtilSampler {
+private:
+    UtilSource source;
+    int stat_fd = -1;
+    std::vector<char> buf;
+    int64_t tick_ns = 10000000;  // USER_HZ period
+    int64_t last_read_ns = 0;
+
+    // per cpu counters of the previous sample
+    std::vector<unsigned long long> prev_busy, prev_total; // PROC_STAT (jiffies), CPUIDLE (us)
+    std::vector<std::vector<int>> idle_fds;                // CPUIDLE: cpuN/cpuidle/stateK/time
+    std::vector<double> util;
+
+public:
+    explicit UtilSampler(UtilSource source = UtilSource::PROC_STAT, int num_cpus = 0);
+    ~UtilSampler();
+
+    UtilSampler(const UtilSampler&) = delete;
+    UtilSampler& operator=(const UtilSampler&) = delete;
+
+    bool ok() const;
+    // per cpu busy fraction since the previous call (0 on success)
+    int sample(std::vector<double>& out);
+
+private:
+    int sample_proc_stat();
+    int sample_cpuidle();
+};
+
+
+// period_us below the USER_HZ tick: PROC_STAT would act on stale samples,
+// so the governor takes CPUIDLE when the cpus expose it.
+// A loop costing >= 1% of a core is reported on stderr at stop().
+struct GovernorConfig {
+    int period_us = 10000;      // sampling period (1-10 ms; one USER_HZ tick)
+    int rate_limit_us = 10000;  // min interval between two changes of one policy
+    UtilSource source = UtilSource::PROC_STAT;
+};
+
+struct GovernorStats {
+    long samples = 0;
+    long changes = 0;
+    long rate_limited = 0;  // changes held back by the rate limit
+    long clamped = 0;       // changes clamped by a kernel limit (kept as applied)
+    long write_errors = 0;  // rc 5
+    long mismatches = 0;    // read-back of another clock (rc 7), retried next period
+    int64_t wall_ns = 0;    // loop lifetime
+    int64_t cpu_ns = 0;     // governor thread cpu time (CLOCK_THREAD_CPUTIME_ID)
+    int64_t max_iter_ns = 0; // slowest iteration (wall)
+
+    double overhead() const { return wall_ns > 0 ? (double)cpu_ns / (double)wall_ns : 0.0; } // fraction of a core
+};
+
+class Governor {
+private:
+    DVFS& dvfs;
+    GovPolicy policy;
+    GovernorConfig cfg;
+
+    std::vector<std::vector<int>> policy_cpus; // per slot
+    std::vector<int> cur_idx;                  // per slot
+    std::vector<int64_t> last_change_ns;       // per slot
+
+    std::thread th;
+    std::atomic<bool> running{false};
+    GovernorStats stats;
+
+public:
+    Governor(DVFS& dvfs, GovPolicy policy, GovernorConfig cfg = GovernorConfig());
+    ~Governor();
+
+    Governor(const Governor&) = delete;
+    Governor& operator=(const Governor&) = delete;
+
+    void start();
+    void stop();
+
+    GovernorStats get_stats() const { return stats; } // valid after stop()
+    std::string report() const;
+
+private:
+    void run();
+};
+
+#endif // GOVERNOR_H
@@ -0,0 +1,135 @@
+#include "hotplug.h"
+#include "sysfs_fd.h"
+#include "topology.h"
+#include "utils/clock.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+
+Hotplug::Hotplug(const std::string& root) : base(root + "/sys/devices/system/cpu") {}
+
+Hotplug::~Hotplug() {
+    restore();
+    close();
+}
+
+int Hotplug::open(bool control) {
+    close();
+    this->control = control;
+
+    // cpuN directories (possible cpus)
+    int max_cpu = -1;
+    if (DIR* dir = opendir(base.c_str())) {
+        while (dirent* e = readdir(dir)) {
+            if (strncmp(e->d_name, "cpu", 3) != 0) continue;
+            char* end;
+            long n = strtol(e->d_name + 3, &end, 10);
+            if (end != e->d_name + 3 && *end == '\0') max_cpu = std::max(max_cpu, (int)n);
+        }
+        closedir(dir);
+    }
+
+    int count = 0;
+    online_fds.assign(max_cpu + 1, -1);
+    initial.assign(max_cpu + 1, -1);
+    for (int cpu = 0; cpu <= max_cpu; ++cpu) {
+        const std::string path = base + "/cpu" + std::to_string(cpu) + "/online";
+        if (access(path.c_str(), F_OK) != 0) continue; // boot cpu: no online node
+        int fd = control ? sysfs::open_wr(path) : sysfs::open_rd(path);
+        if (fd < 0) continue;
+        online_fds[cpu] = fd;
+        initial[cpu] = is_online(cpu);
+        ++count;
+    }
+
+    mask_fd = sysfs::open_rd(base + "/online");
+    refresh();
+    return count;
+}
+
+void Hotplug::close() {
+    for (int& fd : online_fds) sysfs::close_fd(fd);
+    sysfs::close_fd(mask_fd);
+}
+
+int Hotplug::is_online(int cpu) const {
+    if (!hotpluggable(cpu)) return (cpu >= 0 && cpu < num_cpus()) ? 1 : -1; // not hotpluggable: always on
+    long long v;
+    if (sysfs::read_int(online_fds[cpu], v) != 0) return -1;
+    return v ? 1 : 0;
+}
+
+int Hotplug::set_online(int cpu, bool on) {
+    HotplugEvent ev;
+    ev.cpu = cpu;
+    ev.online = on;
+    if (!hotpluggable(cpu)) {
+        ev.rc = 1;
+    } else if (!control) {
+        ev.rc = 2;
+    } else {
+        // the write blocks until the cpu is up (or down)
+        const int64_t t0 = now_ns();
+        ev.rc = (sysfs::write_int(online_fds[cpu], on ? 1 : 0) == 0) ? 0 : 2;
+        ev.latency_ns = now_ns() - t0;
+    }
+    events.push_back(ev);
+    return ev.rc;
+}
+
+int Hotplug::set_cpus(const std::vector<int>& cpus, bool on) {
+    int failed = 0;
+    for (int cpu : cpus) {
+        if (is_online(cpu) == (on ? 1 : 0)) continue; // already there
+        if (set_online(cpu, on) != 0) ++failed;
+    }
+    return failed;
+}
+
+int Hotplug::restore() {
+    if (!control) return 0;
+    int failed = 0;
+    for (int cpu = 0; cpu < num_cpus(); ++cpu) {
+        if (!hotpluggable(cpu) || initial[cpu] < 0) continue;
+        if (is_online(cpu) == initial[cpu]) continue;
+        if (set_online(cpu, initial[cpu] == 1) != 0) ++failed;
+    }
+    return failed;
+}
+
+bool Hotplug::refresh() {
+    std::vector<int> now;
+    char buf[256];
+    ssize_t n = (mask_fd >= 0) ? pread(mask_fd, buf, sizeof(buf) - 1, 0) : -1;
+    if (n > 0) {
+        buf[n] = '\0';
+        now = parse_cpu_list(buf);
+    } else {
+        for (int cpu = 0; cpu < num_cpus(); ++cpu) {
+            if (is_online(cpu) == 1) now.push_back(cpu);
+        }
+    }
+    if (now == mask) return false;
+    mask = now;
+    ++generation;
+    return true;
+}
+
+std::string Hotplug::report() const {
+    std::string out = "hotplug:";
+    char item[64];
+    for (const auto& ev : events) {
+        if (ev.rc == 0) snprintf(item, sizeof(item), " cpu%d %s %.2f ms,", ev.cpu, ev.online ? "up" : "down", ev.latency_ns / 1e6);
+        else snprintf(item, sizeof(item), " cpu%d %s failed (%d),", ev.cpu, ev.online ? "up" : "down", ev.rc);
+        out += item;
+    }
+    if (events.empty()) out += " no transitions";
+    else out.pop_back();
+    return out;
+}
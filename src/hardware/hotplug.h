@@ -0,0 +1,75 @@
+#ifndef HOTPLUG_H
+#define HOTPLUG_H
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+/* ** CPU hotplug **
+ *
+ * cpuN/online through cached fds. A write returns once the kernel has
+ * finished the transition, so its wall time is the hotplug latency.
+ * The state found at open() is restored by restore() (and the destructor).
+ * open(false) only watches (read-only nodes, no root needed).
+ * refresh() re-reads the online mask (cpu/online) and reports changes,
+ * whoever made them, so callers can re-place their threads.
+ *
+ * ex)
+ *   Hotplug hp;
+ *   if (hp.open() > 0) {
+ *       hp.set_cpus({ 1, 2, 3 }, false);  // silver cores off
+ *       ...
+ *       hp.restore();
+ *       printf("%s\n", hp.report().c_str());
+ *   }
+ */
+struct HotplugEvent {
+    int cpu = -1;
+    bool online = false;
+    int64_t latency_ns = 0;
+    int rc = 0;
+};
+
+class Hotplug {
+private:
+    std::string base;              // <root>/sys/devices/system/cpu
+    std::vector<int> online_fds;   // per cpu (-1: not hotpluggable, ex. cpu0)
+    std::vector<int> initial;      // per cpu at open() (1, 0, -1: unknown)
+    bool control = false;          // nodes opened for writing
+    int mask_fd = -1;              // cpu/online
+    std::vector<int> mask;         // last read online cpus
+    uint64_t generation = 0;       // bumped on every mask change seen by refresh()
+    std::vector<HotplugEvent> events;
+
+public:
+    explicit Hotplug(const std::string& root = "");
+    ~Hotplug();
+
+    Hotplug(const Hotplug&) = delete;
+    Hotplug& operator=(const Hotplug&) = delete;
+
+    // return the number of hotpluggable cpus (0: none found or not opened)
+    int open(bool control = true);
+    void close();
+
+    int num_cpus() const { return (int)online_fds.size(); }
+    bool hotpluggable(int cpu) const { return cpu >= 0 && cpu < num_cpus() && online_fds[cpu] >= 0; }
+    int is_online(int cpu) const; // 1, 0 (-1: unknown)
+
+    // return 0 on success (1: not hotpluggable, 2: write failed or watch only)
+    int set_online(int cpu, bool on);
+    // return the number of failures (every cpu is attempted)
+    int set_cpus(const std::vector<int>& cpus, bool on);
+    int restore(); // state at open(); return the number of failures
+
+    // online cpus (cpu/online)
+    const std::vector<int>& get_online() const { return mask; }
+    bool refresh();                // true if the mask changed since the last call
+    uint64_t get_generation() const { return generation; }
+
+    const std::vector<HotplugEvent>& get_events() const { return events; }
+    std::string report() const;    // per-transition latencies
+};
+
+#endif // HOTPLUG_H
@@ -0,0 +1,135 @@
+#include "opp_table.h"
+
+#include <sys/utsname.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+// cache file header (bump the version when the layout changes)
+static const char OPP_CACHE_MAGIC[8] = { 'D', 'D', 'S', 'O', 'P', 'P', '0', '1' };
+
+std::vector<int> read_freq_list(const std::string& path) {
+    std::vector<int> freqs;
+    std::ifstream file(path);
+    if (!file) return freqs;
+
+    std::vector<long long> raw;
+    long long v;
+    while (file >> v) {
+        if (v > 0) raw.push_back(v);
+    }
+    if (raw.empty()) return freqs;
+
+    // devfreq drivers may report Hz instead of kHz: one unit per file, from the
+    // highest entry (no clock reaches 100 GHz), so low Hz entries convert too
+    const long long unit = (*std::max_element(raw.begin(), raw.end()) > 100000000LL) ? 1000 : 1;
+    for (long long f : raw) {
+        if (f / unit > 0) freqs.push_back(static_cast<int>(f / unit));
+    }
+
+    // some kernels list frequencies in descending order
+    std::sort(freqs.begin(), freqs.end());
+    freqs.erase(std::unique(freqs.begin(), freqs.end()), freqs.end());
+    return freqs;
+}
+
+void scan_opp_tables(const std::vector<int>& policies, const std::string& cpufreq_base,
+                     const std::string& devfreq_base, OppTables& out) {
+    out.cpu.clear();
+    for (int policy : policies) {
+        const std::string base = cpufreq_base + "/policy" + std::to_string(policy);
+        std::vector<int> table = read_freq_list(base + "/scaling_available_frequencies");
+        if (!table.empty()) out.cpu[policy] = table;
+    }
+    out.ddr = read_freq_list(devfreq_base + "/available_frequencies");
+}
+
+std::string opp_cache_key(const std::string& device_name) {
+    std::string key = device_name;
+    struct utsname u;
+    if (uname(&u) == 0) {
+        key += std::string("|") + u.release + "|" + u.version;
+    }
+    return key;
+}
+
+std::string opp_cache_path(const std::string& device_name) {
+    const char* dir = getenv("DDS_CACHE_DIR");
+    if (!dir || !*dir) dir = getenv("HOME");
+    std::string base = (dir && *dir) ? std::string(dir) : std::string(".");
+    if (base.back() != '/') base += "/";
+    return base + ".dds_opp_" + device_name + ".bin";
+}
+
+// little helpers for fixed-width binary fields
+static void put_u32(std::ofstream& f, uint32_t v) { f.write(reinterpret_cast<const char*>(&v), sizeof(v)); }
+static void put_i32(std::ofstream& f, int32_t v) { f.write(reinterpret_cast<const char*>(&v), sizeof(v)); }
+static bool get_u32(std::ifstream& f, uint32_t& v) { return (bool)f.read(reinterpret_cast<char*>(&v), sizeof(v)); }
+static bool get_i32(std::ifstream& f, int32_t& v) { return (bool)f.read(reinterpret_cast<char*>(&v), sizeof(v)); }
+
+static bool get_table(std::ifstream& f, std::vector<int>& table) {
+    uint32_t n = 0;
+    if (!get_u32(f, n) || n > 4096) return false;
+    table.resize(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        int32_t v;
+        if (!get_i32(f, v)) return false;
+        table[i] = v;
+    }
+    return true;
+}
+
+static void put_table(std::ofstream& f, const std::vector<int>& table) {
+    put_u32(f, static_cast<uint32_t>(table.size()));
+    for (int v : table) put_i32(f, v);
+}
+
+bool load_opp_cache(const std::string& path, const std::string& key, OppTables& out) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    char magic[sizeof(OPP_CACHE_MAGIC)];
+    if (!file.read(magic, sizeof(magic))) return false;
+    if (!std::equal(magic, magic + sizeof(magic), OPP_CACHE_MAGIC)) return false;
+
+    // key check (device + kernel build)
+    uint32_t key_len = 0;
+    if (!get_u32(file, key_len) || key_len > 4096) return false;
+    std::string stored(key_len, '\0');
+    if (!file.read(&stored[0], key_len)) return false;
+    if (stored != key) return false;
+
+    OppTables tables;
+    uint32_t n_policy = 0;
+    if (!get_u32(file, n_policy) || n_policy > 64) return false;
+    for (uint32_t i = 0; i < n_policy; ++i) {
+        int32_t policy;
+        if (!get_i32(file, policy)) return false;
+        if (!get_table(file, tables.cpu[policy])) return false;
+    }
+    if (!get_table(file, tables.ddr)) return false;
+
+    out = tables;
+    return true;
+}
+
+bool save_opp_cache(const std::string& path, const std::string& key, const OppTables& tables) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+
+    file.write(OPP_CACHE_MAGIC, sizeof(OPP_CACHE_MAGIC));
+    put_u32(file, static_cast<uint32_t>(key.size()));
+    file.write(key.data(), key.size());
+
+    put_u32(file, static_cast<uint32_t>(tables.cpu.size()));
+    for (const auto& kv : tables.cpu) {
+        put_i32(file, kv.first);
+        put_table(file, kv.second);
+    }
+    put_table(file, tables.ddr);
+
+    return (bool)file;
+}
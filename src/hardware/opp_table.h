@@ -0,0 +1,39 @@
+#ifndef OPP_TABLE_H
+#define OPP_TABLE_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+/* ** OPP table discovery **
+ *
+ * Frequencies are kept in kHz, sorted ascending.
+ * - cpu: policy index (ex. 0, 4, 7) -> scaling_available_frequencies
+ * - ddr: devfreq available_frequencies of MIF
+ *
+ * Discovered tables are cached in a small binary file keyed by
+ * device name and kernel build (uname release + version), so repeated
+ * launches skip the sysfs scan.
+ */
+struct OppTables {
+    std::map<int, std::vector<int>> cpu;
+    std::vector<int> ddr;
+};
+
+// read a whitespace separated frequency list (Hz values are converted to kHz)
+std::vector<int> read_freq_list(const std::string& path);
+
+// scan sysfs for the given policies (under cpufreq_base) and devfreq node
+// (missing entries are left empty in out)
+void scan_opp_tables(const std::vector<int>& policies, const std::string& cpufreq_base,
+                     const std::string& devfreq_base, OppTables& out);
+
+// cache key and default cache path
+std::string opp_cache_key(const std::string& device_name);
+std::string opp_cache_path(const std::string& device_name);
+
+// binary cache I/O (false on missing file, broken file or key mismatch)
+bool load_opp_cache(const std::string& path, const std::string& key, OppTables& out);
+bool save_opp_cache(const std::string& path, const std::string& key, const OppTables& tables);
+
+#endif // OPP_TABLE_H
@@ -0,0 +1,152 @@
+#include "opp_volt.h"
+#include "sysfs_fd.h"
+
+#include <dirent.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+// devicetree cells are big-endian
+static bool read_be(const std::string& path, std::vector<uint8_t>& out) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return false;
+    out.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    return !out.empty();
+}
+
+static uint64_t be_cell(const std::vector<uint8_t>& b, std::size_t off, int bytes) {
+    uint64_t v = 0;
+    for (int i = 0; i < bytes; ++i) v = (v << 8) | b[off + i];
+    return v;
+}
+
+static int read_uv(const std::string& dir) {
+    std::string text;
+    for (const char* node : { "/supply-0/u_volt_target", "/u_volt_target" }) {
+        if (sysfs::read_text(dir + node, text)) return atoi(text.c_str());
+    }
+    return -1;
+}
+
+int load_volt_debugfs(const std::string& root, std::map<std::string, VoltTable>& out) {
+    const std::string base = root + "/sys/kernel/debug/opp";
+    DIR* dir = opendir(base.c_str());
+    if (!dir) return 0;
+
+    int found = 0;
+    while (dirent* e = readdir(dir)) {
+        if (e->d_name[0] == '.') continue;
+        const std::string dev = base + "/" + e->d_name;
+        DIR* dd = opendir(dev.c_str());
+        if (!dd) continue;
+
+        VoltTable t;
+        while (dirent* o = readdir(dd)) {
+            if (strncmp(o->d_name, "opp:", 4) != 0) continue;
+            const long long hz = atoll(o->d_name + 4);
+            const int uv = read_uv(dev + "/" + o->d_name);
+            if (hz > 0 && uv > 0) t[(int)(hz / 1000)] = uv;
+        }
+        closedir(dd);
+        if (!t.empty()) {
+            out[e->d_name] = t;
+            ++found;
+        }
+    }
+    closedir(dir);
+    return found;
+}
+
+// directory under base whose phandle matches (depth-first)
+static bool find_phandle(const std::string& base, uint32_t phandle, int depth, std::string& found) {
+    std::vector<uint8_t> b;
+    if (read_be(base + "/phandle", b) && b.size() >= 4 && (uint32_t)be_cell(b, 0, 4) == phandle) {
+        found = base;
+        return true;
+    }
+    if (depth == 0) return false;
+
+    DIR* dir = opendir(base.c_str());
+    if (!dir) return false;
+    bool hit = false;
+    while (!hit) {
+        dirent* e = readdir(dir);
+        if (!e) break;
+        if (e->d_name[0] == '.' || (e->d_type != DT_DIR && e->d_type != DT_UNKNOWN)) continue;
+        hit = find_phandle(base + "/" + e->d_name, phandle, depth - 1, found);
+    }
+    closedir(dir);
+    return hit;
+}
+
+int load_volt_devicetree(const std::string& of_node, const std::string& dt_base, VoltTable& out) {
+    std::vector<uint8_t> b;
+    if (!read_be(of_node + "/operating-points-v2", b) || b.size() < 4) return 0;
+
+    std::string table;
+    if (!find_phandle(dt_base, (uint32_t)be_cell(b, 0, 4), 8, table)) return 0;
+
+    DIR* dir = opendir(table.c_str());
+    if (!dir) return 0;
+    int n = 0;
+    while (dirent* e = readdir(dir)) {
+        if (strncmp(e->d_name, "opp", 3) != 0) continue;
+        const std::string opp = table + "/" + e->d_name;
+        std::vector<uint8_t> hz, uv;
+        if (!read_be(opp + "/opp-hz", hz) || hz.size() < 8) continue;
+        if (!read_be(opp + "/opp-microvolt", uv) || uv.size() < 4) continue;
+        out[(int)(be_cell(hz, 0, 8) / 1000)] = (int)be_cell(uv, 0, 4); // target of target/min/max
+        ++n;
+    }
+    closedir(dir);
+    return n;
+}
+
+int load_volt_file(const std::string& path, std::map<std::string, VoltTable>& out) {
+    std::ifstream f(path);
+    if (!f) return -1;
+
+    int n = 0;
+    std::string line;
+    while (std::getline(f, line)) {
+        const std::size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        std::istringstream ss(line);
+        std::string domain;
+        long long khz, uv;
+        if (!(ss >> domain)) continue; // blank
+        if (!(ss >> khz >> uv) || khz <= 0 || uv <= 0) return -2;
+        out[domain][(int)khz] = (int)uv;
+        ++n;
+    }
+    return n;
+}
+
+std::vector<int> align_voltages(const std::vector<int>& freqs, const VoltTable& volts) {
+    std::vector<int> uv(freqs.size(), -1);
+    if (volts.empty()) return uv;
+    for (std::size_t i = 0; i < freqs.size(); ++i) {
+        const int f = freqs[i];
+        auto hi = volts.lower_bound(f);
+        auto best = volts.end();
+        if (hi != volts.end()) best = hi;
+        if (hi != volts.begin()) {
+            auto lo = std::prev(hi);
+            if (best == volts.end() || f - lo->first < best->first - f) best = lo;
+        }
+        if (best != volts.end() && std::abs(best->first - f) <= f / 100) uv[i] = best->second;
+    }
+    return uv;
+}
+
+double v2f(int khz, int uv) {
+    if (uv < 0) return NAN;
+    const double v = uv / 1e6;
+    return v * v * (khz / 1e6);
+}
@@ -0,0 +1,39 @@
+#ifndef OPP_VOLT_H
+#define OPP_VOLT_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+/* ** OPP voltage tables **
+ *
+ * Voltage per OPP (uV) for power models (C x V^2 x f), from:
+ * - debugfs:    <root>/sys/kernel/debug/opp/<dev>/opp:<Hz>/supply-0/u_volt_target
+ *               (older kernels: opp:<Hz>/u_volt_target), <dev> = cpuN or device name
+ * - devicetree: the operating-points-v2 table referenced by a device of_node
+ *               (opp-hz: u64 big-endian, opp-microvolt: u32 big-endian target[, min, max])
+ * - user file:  "domain kHz uV" lines, # comments (domain: policyN, cpuN, mif, ...)
+ * Voltages are kept by frequency and aligned to an OPP table on demand.
+ *
+ * ex)
+ *   std::map<std::string, VoltTable> dbg;
+ *   load_volt_debugfs("", dbg);
+ *   std::vector<int> uv = align_voltages(dvfs.get_cpu_freq().at(4), dbg["cpu4"]);
+ *   double term = v2f(khz, uv[i]);   // V^2 GHz
+ */
+using VoltTable = std::map<int, int>; // kHz -> uV
+
+// return the number of tables found (keyed by debugfs directory name)
+int load_volt_debugfs(const std::string& root, std::map<std::string, VoltTable>& out);
+// of_node: sysfs of_node link of the device, dt_base: devicetree root it points into
+// return the number of OPPs read
+int load_volt_devicetree(const std::string& of_node, const std::string& dt_base, VoltTable& out);
+// return the number of entries (-1: unreadable, -2: syntax error)
+int load_volt_file(const std::string& path, std::map<std::string, VoltTable>& out);
+
+// uV per OPP of freqs (kHz), nearest entry within 1 % (-1: unknown)
+std::vector<int> align_voltages(const std::vector<int>& freqs, const VoltTable& volts);
+// V^2 x f in V^2 GHz (dynamic power up to the switched capacitance); NAN if uv < 0
+double v2f(int khz, int uv);
+
+#endif // OPP_VOLT_H
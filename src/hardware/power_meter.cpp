@@ -0,0 +1,45 @@
+#include "power_meter.h"
+#include "sysfs_fd.h"
+#include "utils/clock.h"
+
+#include <chrono>
+#include <cmath>
+
+PowerMeter::PowerMeter(const std::string& supply, int window_ms, const std::string& root)
+    : path(root + "/sys/class/power_supply/" + supply), window_ns((int64_t)window_ms * 1000000) {}
+
+PowerMeter::~PowerMeter() { close(); }
+
+int PowerMeter::open() {
+    close();
+    current_fd = sysfs::open_rd(path + "/current_now");
+    if (current_fd < 0) return -1;
+    voltage_fd = sysfs::open_rd(path + "/voltage_now");
+    if (voltage_fd < 0) {
+        close();
+        return -2;
+    }
+    return 0;
+}
+
+void PowerMeter::close() {
+    sysfs::close_fd(current_fd);
+    sysfs::close_fd(voltage_fd);
+}
+
+int PowerMeter::sample() {
+    long long ua, uv;
+    if (sysfs::read_int(current_fd, ua) != 0 || sysfs::read_int(voltage_fd, uv) != 0) return -1;
+
+    // sign of current_now is vendor specific (charging vs discharging)
+    last = std::fabs((double)ua) * (double)uv * 1e-12;
+
+    const int64_t t = now_ns();
+    window.emplace_back(t, last);
+    sum += last;
+    while (window.size() > 1 && t - window.front().first > window_ns) {
+        sum -= window.front().second;
+        window.pop_front();
+    }
+    return 0;
+}
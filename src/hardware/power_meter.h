@@ -0,0 +1,55 @@
+#ifndef POWER_METER_H
+#define POWER_METER_H
+
+#include <stdint.h>
+
+#include <deque>
+#include <string>
+#include <utility>
+
+/* ** Battery power meter **
+ *
+ * Instantaneous power = |current_now| x voltage_now of a power_supply node
+ * (uA x uV), read through cached fds and averaged over a sliding time
+ * window. Fuel gauges refresh every few hundred ms, so the window should
+ * span several refreshes.
+ *
+ * ex)
+ *   PowerMeter pm;                 // /sys/class/power_supply/battery
+ *   if (pm.open() == 0) {
+ *       pm.sample();               // call periodically
+ *       printf("%.2f W\n", pm.get_watts());
+ *   }
+ */
+class PowerMeter {
+private:
+    std::string path;
+    int current_fd = -1;
+    int voltage_fd = -1;
+    int64_t window_ns;
+    std::deque<std::pair<int64_t, double>> window; // (time, W)
+    double sum = 0.0;
+    double last = 0.0;
+
+public:
+    explicit PowerMeter(const std::string& supply = "battery", int window_ms = 2000, const std::string& root = "");
+    ~PowerMeter();
+
+    PowerMeter(const PowerMeter&) = delete;
+    PowerMeter& operator=(const PowerMeter&) = delete;
+
+    // return 0 on success (-1: current_now, -2: voltage_now not readable)
+    int open();
+    void close();
+    bool is_open() const { return current_fd >= 0 && voltage_fd >= 0; }
+
+    // read one instantaneous value into the window (0 on success)
+    int sample();
+    double get_instant() const { return last; }                                       // W, last sample
+    double get_watts() const { return window.empty() ? 0.0 : sum / window.size(); }   // W, window average
+    void set_window_ms(int ms) { window_ns = (int64_t)ms * 1000000; }
+    int get_window_ms() const { return (int)(window_ns / 1000000); }
+    void reset() { window.clear(); sum = 0.0; }
+};
+
+#endif // POWER_METER_H
@@ -1,4 +1,6 @@
 #include "record.h"
+#include "governor.h"
+#include "topology.h"
 #include <algorithm>
 
 std::vector<std::string> split_string(const std::string& str){
@@ -83,6 +85,16 @@ const std::string get_records_names(const DVFS& dvfs) {
     // RAM clock info
     names += "scaling_devfreq_max,scaling_devfreq_min,cur_freq,";
 
+    // extra devfreq domains (DVFS::add_devfreq())
+    for (const auto& d : dvfs.get_devfreq_domains()) {
+        names += d.get_name() + "_min_freq," + d.get_name() + "_max_freq," + d.get_name() + "_cur_freq,";
+    }
+
+    // cpu utilization per cluster (record_hard(): mean busy fraction of its cpus)
+    for (const auto index : dvfs.get_cluster_indices()) {
+        names += std::string("cpu") + std::to_string(index) + "_util,";
+    }
+
     // remove emptyThermal 
 	for (std::string empty : dvfs.get_empty_thermal()){
 		if (empty == "qcom,secure-non"){
@@ -168,7 +180,16 @@ std::vector<std::string> get_hard_records(const DVFS& dvfs) {
 
 	//std::cout << command << std::endl; // test
     // string post-processing
-    return split_string(output);
+    std::vector<std::string> records = split_string(output);
+
+    // extra devfreq domains: programmed min/max and cur_freq through cached fds (MHz),
+    // snapshot under the DVFS lock (transitions update them from other threads)
+    for (const auto& d : dvfs.read_devfreq()) {
+        for (int khz : { d.min_khz, d.max_khz, d.cur_khz }) {
+            records.push_back(khz < 0 ? std::string("-1") : std::to_string(khz / 1000.0));
+        }
+    }
+    return records;
 }
 
 
@@ -310,6 +331,16 @@ void record_hard(std::atomic<bool>& sigterm, const DVFS& dvfs){
 	
 	int test_index = 0;
 	std::vector<std::string> records;
+
+	// utilization columns: mean over the cpus of each cluster since the previous row
+	const Topology& topo = Topology::system();
+	std::vector<std::vector<int>> cluster_cpus;
+	for (int p : dvfs.get_cluster_indices()) {
+		int ci = topo.cluster_of(p);
+		cluster_cpus.push_back(ci >= 0 ? topo.get_clusters()[ci].cpus : std::vector<int>{ p });
+	}
+	UtilSampler sampler;
+	std::vector<double> util;
     auto start_sys_time = std::chrono::system_clock::now();
     do{
         // get records
@@ -317,6 +348,15 @@ void record_hard(std::atomic<bool>& sigterm, const DVFS& dvfs){
         auto now = std::chrono::system_clock::now();
 		auto sys_time = std::chrono::duration_cast<std::chrono::milliseconds>(now-start_sys_time).count(); // ms base
 		records.insert(records.begin(), std::to_string((double)sys_time/(double)1000)); // insert systime into firstrecord element
+		sampler.sample(util);
+		for (const auto& cpus : cluster_cpus) {
+			double sum = 0.0;
+			int n = 0;
+			for (int cpu : cpus) {
+				if (cpu >= 0 && cpu < (int)util.size()) { sum += util[cpu]; ++n; }
+			}
+			records.push_back(std::to_string(n > 0 ? sum / n : 0.0));
+		}
 		
 		// File write record
 		write_file(records, filename);
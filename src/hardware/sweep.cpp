@@ -0,0 +1,277 @@
+#include "sweep.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+FreqSweep::FreqSweep(DVFS& dvfs, Collector& collector, PowerMeter* meter, SweepConfig cfg)
+    : dvfs(dvfs), collector(collector), meter(meter), cfg(cfg) {}
+
+void FreqSweep::cool_down(const std::atomic<bool>* stop) {
+    // idle at the lowest OPPs
+    dvfs.apply_state(dvfs.make_state(0, dvfs.get_ddr_freq().empty() ? -1 : 0));
+
+    using clock = std::chrono::steady_clock;
+    const auto t0 = clock::now();
+    const double limit = (cfg.cooldown_temp_c > 0.0) ? cfg.cooldown_max_sec : cfg.cooldown_sec;
+    while (std::chrono::duration<double>(clock::now() - t0).count() < limit) {
+        if (stop && stop->load(std::memory_order_relaxed)) return;
+        if (cfg.cooldown_temp_c > 0.0 && collector.collect_high_temp() <= cfg.cooldown_temp_c &&
+            std::chrono::duration<double>(clock::now() - t0).count() >= cfg.cooldown_sec) return;
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+}
+
+SweepPoint FreqSweep::measure(int cpu, int ram, const SweepWorkload& workload, const std::atomic<bool>* stop) {
+    const std::vector<int>& clusters = dvfs.get_cluster_indices();
+    const std::vector<int>& ddr = dvfs.get_ddr_freq();
+
+    SweepPoint p;
+    p.cpu_idx = cpu;
+    p.ram_idx = ram;
+    DvfsState st = dvfs.make_state(cpu, ram);
+    p.cpu_conf = st.cpu_idx;
+    if (!clusters.empty() && !st.cpu_idx.empty()) {
+        auto it = dvfs.get_cpu_freq().find(clusters.back());
+        const int i = st.cpu_idx.back();
+        if (it != dvfs.get_cpu_freq().end() && i >= 0 && i < (int)it->second.size()) p.cpu_khz = it->second[i];
+    }
+    if (ram >= 0 && ram < (int)ddr.size()) p.ram_khz = ddr[ram];
+
+    DvfsTxResult tx;
+    p.rc = dvfs.apply_state(st, &tx);
+    if (p.rc != 0) {
+        fprintf(stderr, "[Sweep] cpu %d ram %d: DVFS transition failed (rc=%d), skipped\n", cpu, ram, p.rc);
+        return p;
+    }
+    if (tx.clamped > 0) {
+        fprintf(stderr, "[Sweep] cpu %d ram %d: %d domain(s) clamped by a kernel limit, measured as is\n", cpu, ram,
+                tx.clamped);
+    }
+
+    workload(cfg.warmup_sec, stop);
+
+    // side sampler: power and temperature while the workload runs
+    std::atomic<bool> measuring{true};
+    double w_sum = 0.0, t_sum = 0.0;
+    long w_n = 0, t_n = 0;
+    p.temp_start_c = p.temp_max_c = collector.collect_high_temp();
+    if (meter) meter->reset();
+    std::thread sampler([&] {
+        while (measuring.load(std::memory_order_relaxed)) {
+            if (meter && meter->sample() == 0) {
+                w_sum += meter->get_instant();
+                ++w_n;
+            }
+            const double t = collector.collect_high_temp();
+            p.temp_max_c = std::max(p.temp_max_c, t);
+            t_sum += t;
+            ++t_n;
+            std::this_thread::sleep_for(std::chrono::milliseconds(std::max(1, cfg.sample_ms)));
+        }
+    });
+    p.throughput = workload(cfg.measure_sec, stop);
+    measuring.store(false, std::memory_order_relaxed);
+    sampler.join();
+
+    p.power_w = w_n ? w_sum / w_n : 0.0;
+    p.temp_mean_c = t_n ? t_sum / t_n : p.temp_start_c;
+    p.perf_per_watt = p.power_w > 0.0 ? p.throughput / p.power_w : 0.0;
+    return p;
+}
+
+std::vector<SweepPoint> FreqSweep::run(const SweepWorkload& workload, const std::atomic<bool>* stop) {
+    std::vector<SweepPoint> points;
+    std::vector<int> ram_points = cfg.ram_points.empty() ? std::vector<int>{ -1 } : cfg.ram_points;
+
+    const std::size_t total = cfg.cpu_points.size() * ram_points.size();
+    for (int cpu : cfg.cpu_points) {
+        for (int ram : ram_points) {
+            if (stop && stop->load(std::memory_order_relaxed)) return points;
+
+            SweepPoint p = measure(cpu, ram, workload, stop);
+            points.push_back(p);
+            if (p.rc != 0) continue;
+
+            printf("[Sweep] %zu/%zu cpu %d ram %d: %.3f/s, %.2f W, %.1f C\n",
+                   points.size(), total, cpu, ram, p.throughput, p.power_w, p.temp_max_c);
+            fflush(stdout);
+
+            if (points.size() < total) cool_down(stop);
+        }
+    }
+    mark_pareto(points);
+    return points;
+}
+
+int mark_pareto(std::vector<SweepPoint>& points) {
+    // without power, the front is the fastest point(s) only
+    int n = 0;
+    for (auto& p : points) {
+        p.pareto = false;
+        if (p.rc != 0) continue;
+        bool dominated = false;
+        for (const auto& q : points) {
+            if (&q == &p || q.rc != 0) continue;
+            const bool no_worse = q.throughput >= p.throughput && q.power_w <= p.power_w;
+            const bool better = q.throughput > p.throughput || q.power_w < p.power_w;
+            if (no_worse && better) {
+                dominated = true;
+                break;
+            }
+        }
+        p.pareto = !dominated;
+        if (p.pareto) ++n;
+    }
+    return n;
+}
+
+int parse_sweep_points(const std::string& spec, int max_idx, bool allow_released, std::vector<int>& out) {
+    out.clear();
+    // a whole decimal integer, nothing else
+    auto to_int = [](const std::string& t, int& v) {
+        char* end = nullptr;
+        errno = 0;
+        const long l = strtol(t.c_str(), &end, 10);
+        if (t.empty() || *end != '\0' || errno == ERANGE || l < INT_MIN || l > INT_MAX) return false;
+        v = (int)l;
+        return true;
+    };
+
+    if (spec == "all") {
+        for (int i = 0; i <= max_idx; ++i) out.push_back(i);
+        return 0;
+    }
+    if (allow_released && spec == "-1") {
+        out.push_back(-1);
+        return 0;
+    }
+    if (spec.find(':') != std::string::npos) {
+        std::vector<std::string> f;
+        std::stringstream ss(spec);
+        std::string t;
+        while (std::getline(ss, t, ':')) f.push_back(t);
+        int a = 0, b = 0, step = 1;
+        if (f.size() < 2 || f.size() > 3 || !to_int(f[0], a) || !to_int(f[1], b) ||
+            (f.size() == 3 && !to_int(f[2], step)) || a < 0 || b < a || step <= 0) {
+            return -1;
+        }
+        for (int i = a; i <= std::min(b, max_idx); i += step) out.push_back(i);
+        return 0;
+    }
+    std::stringstream ss(spec);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        int i = 0;
+        if (!to_int(item, i) || i < 0) {
+            out.clear();
+            return -1;
+        }
+        out.push_back(std::min(i, max_idx));
+    }
+    return out.empty() ? -1 : 0;
+}
+
+std::string sweep_table(const std::vector<SweepPoint>& points, const std::string& unit) {
+    std::string out;
+    char line[256];
+    snprintf(line, sizeof(line), "%4s %4s %9s %9s %14s %8s %8s %8s %12s %s\n",
+             "cpu", "ram", "cpu_mhz", "ram_mhz", unit.c_str(), "power_w", "temp_c", "max_c", "perf/W", "pareto");
+    out += line;
+    for (const auto& p : points) {
+        if (p.rc != 0) {
+            snprintf(line, sizeof(line), "%4d %4d   (DVFS transition failed: rc=%d)\n", p.cpu_idx, p.ram_idx, p.rc);
+        } else {
+            snprintf(line, sizeof(line), "%4d %4d %9d %9d %14.3f %8.2f %8.1f %8.1f %12.3f %s\n",
+                     p.cpu_idx, p.ram_idx, p.cpu_khz / 1000, p.ram_khz / 1000, p.throughput, p.power_w,
+                     p.temp_mean_c, p.temp_max_c, p.perf_per_watt, p.pareto ? "*" : "");
+        }
+        out += line;
+    }
+
+    // Pareto set, cheapest first
+    std::vector<const SweepPoint*> front;
+    for (const auto& p : points) {
+        if (p.pareto) front.push_back(&p);
+    }
+    std::sort(front.begin(), front.end(), [](const SweepPoint* a, const SweepPoint* b) { return a->power_w < b->power_w; });
+    out += "pareto (throughput vs power):";
+    for (const SweepPoint* p : front) {
+        snprintf(line, sizeof(line), " (%d,%d)", p->cpu_idx, p->ram_idx);
+        out += line;
+    }
+    out += "\n";
+    return out;
+}
+
+int write_sweep_csv(const std::string& path, const std::vector<SweepPoint>& points) {
+    std::ofstream file(path);
+    if (!file) {
+        fprintf(stderr, "[Sweep] cannot write: %s\n", path.c_str());
+        return -1;
+    }
+    file << "cpu_idx,ram_idx,cpu_conf,cpu_khz,ram_khz,rc,throughput,power_w,temp_start_c,temp_mean_c,temp_max_c,perf_per_watt,pareto\n";
+    for (const auto& p : points) {
+        std::string conf;
+        for (std::size_t i = 0; i < p.cpu_conf.size(); ++i) conf += (i ? ":" : "") + std::to_string(p.cpu_conf[i]);
+        file << p.cpu_idx << "," << p.ram_idx << "," << conf << "," << p.cpu_khz << "," << p.ram_khz << ","
+             << p.rc << "," << p.throughput << "," << p.power_w << "," << p.temp_start_c << ","
+             << p.temp_mean_c << "," << p.temp_max_c << "," << p.perf_per_watt << "," << (p.pareto ? 1 : 0) << "\n";
+    }
+    return 0;
+}
+
+std::vector<SweepPoint> load_sweep_csv(const std::string& path) {
+    std::vector<SweepPoint> points;
+    std::ifstream file(path);
+    if (!file) {
+        fprintf(stderr, "[Sweep] cannot open: %s\n", path.c_str());
+        return points;
+    }
+
+    std::string line;
+    std::getline(file, line); // header
+    while (std::getline(file, line)) {
+        if (line.empty()) continue;
+        std::vector<std::string> f;
+        std::stringstream ss(line);
+        std::string item;
+        while (std::getline(ss, item, ',')) f.push_back(item);
+        if (f.size() < 13) {
+            fprintf(stderr, "[Sweep] %s: malformed row: %s\n", path.c_str(), line.c_str());
+            return {};
+        }
+
+        SweepPoint p;
+        try {
+            p.cpu_idx = std::stoi(f[0]);
+            p.ram_idx = std::stoi(f[1]);
+            std::stringstream conf(f[2]);
+            while (std::getline(conf, item, ':')) {
+                if (!item.empty()) p.cpu_conf.push_back(std::stoi(item));
+            }
+            p.cpu_khz = std::stoi(f[3]);
+            p.ram_khz = std::stoi(f[4]);
+            p.rc = std::stoi(f[5]);
+            p.throughput = std::stod(f[6]);
+            p.power_w = std::stod(f[7]);
+            p.temp_start_c = std::stod(f[8]);
+            p.temp_mean_c = std::stod(f[9]);
+            p.temp_max_c = std::stod(f[10]);
+            p.perf_per_watt = std::stod(f[11]);
+            p.pareto = std::stoi(f[12]) != 0;
+        } catch (const std::exception&) {
+            fprintf(stderr, "[Sweep] %s: bad number in row: %s\n", path.c_str(), line.c_str());
+            return {};
+        }
+        points.push_back(p);
+    }
+    return points;
+}
@@ -0,0 +1,92 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include "dvfs.h"
+#include "power_meter.h"
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+/* ** Frequency sweep **
+ *
+ * Runs one workload over (prime cpu index x ram index) points in one
+ * process: one DVFS init, one fd cache, one transaction per point.
+ * Per point:
+ *   apply -> warm-up -> measure (workload throughput, power, temperature) -> cool down
+ * Power and temperature are sampled every sample_ms on a side thread
+ * while the workload runs. Cool-down holds the lowest OPPs idle for
+ * cooldown_sec, or until the temperature falls below cooldown_temp_c.
+ * Points on the (throughput, power) Pareto front are flagged: no other
+ * point is both faster and cheaper.
+ *
+ * ex)
+ *   SweepConfig cfg;
+ *   cfg.cpu_points = { 0, 4, 8, 12 };
+ *   cfg.ram_points = { 0, 5, 11 };
+ *   FreqSweep sweep(dvfs, collector, &meter, cfg);
+ *   const BurnKernel* k = find_burn_kernel("auto");
+ *   auto points = sweep.run([k](double sec, const std::atomic<bool>* stop) { return kernel_flops_for(*k, 4, sec, {}, stop); });
+ *   printf("%s", sweep_table(points).c_str());
+ */
+struct SweepConfig {
+    std::vector<int> cpu_points;   // prime cpu indices (mapped by get_cpu_freqs_conf)
+    std::vector<int> ram_points;   // ram indices (-1: released)
+    double warmup_sec = 1.0;       // run before measuring (caches, governors, fuel gauge)
+    double measure_sec = 5.0;
+    double cooldown_sec = 10.0;
+    double cooldown_temp_c = -1.0; // > 0: cool down until below (at most cooldown_max_sec)
+    double cooldown_max_sec = 120.0;
+    int sample_ms = 100;
+};
+
+struct SweepPoint {
+    int cpu_idx = -1;              // prime
+    int ram_idx = -1;
+    std::vector<int> cpu_conf;     // per cluster
+    int cpu_khz = 0;               // prime cluster
+    int ram_khz = 0;
+    int rc = 0;                    // apply_state
+    double throughput = 0.0;       // workload units/s
+    double power_w = 0.0;          // mean over the measurement (0: no meter)
+    double temp_start_c = 0.0;
+    double temp_max_c = 0.0;
+    double temp_mean_c = 0.0;
+    double perf_per_watt = 0.0;
+    bool pareto = false;
+};
+
+// measure for `seconds` (or until *stop), return throughput
+using SweepWorkload = std::function<double(double seconds, const std::atomic<bool>* stop)>;
+
+class FreqSweep {
+private:
+    DVFS& dvfs;
+    Collector& collector;
+    PowerMeter* meter;             // optional
+    SweepConfig cfg;
+
+public:
+    FreqSweep(DVFS& dvfs, Collector& collector, PowerMeter* meter, SweepConfig cfg);
+
+    // points in cpu-major order; stops early on *stop
+    std::vector<SweepPoint> run(const SweepWorkload& workload, const std::atomic<bool>* stop = nullptr);
+
+    // one point: apply, warm up, measure (no cool-down)
+    SweepPoint measure(int cpu, int ram, const SweepWorkload& workload, const std::atomic<bool>* stop = nullptr);
+    void cool_down(const std::atomic<bool>* stop = nullptr);
+};
+
+// flag the (max throughput, min power) front; return the number of points on it
+int mark_pareto(std::vector<SweepPoint>& points);
+
+// "all" | "a:b[:step]" | "i,j,k" -> indices, those above max_idx clamped to it
+// return 0 on success (-1: syntax or negative index; -1 alone is kept when allow_released)
+int parse_sweep_points(const std::string& spec, int max_idx, bool allow_released, std::vector<int>& out);
+
+std::string sweep_table(const std::vector<SweepPoint>& points, const std::string& unit = "units/s");
+int write_sweep_csv(const std::string& path, const std::vector<SweepPoint>& points); // 0 on success
+std::vector<SweepPoint> load_sweep_csv(const std::string& path);                      // empty on error
+
+#endif // SWEEP_H
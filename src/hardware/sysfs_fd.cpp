@@ -0,0 +1,222 @@
+#include "sysfs_fd.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <charconv>
+#include <fstream>
+#include <sstream>
+
+namespace sysfs {
+
+int open_wr(const std::string& path) {
+    // open with O_CLOEXEC to prevent FD leak to child processes
+    // read-write if allowed (read-back), write-only otherwise
+    int fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0) fd = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fprintf(stderr, "[DVFS] open failed: %s (%s)\n", path.c_str(), strerror(errno));
+    }
+    return fd;
+}
+
+int open_rd(const std::string& path) {
+    // optional read-only node: no error message
+    return open(path.c_str(), O_RDONLY | O_CLOEXEC);
+}
+
+void close_fd(int& fd) {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+bool try_open_first(const std::string& dir, const char* const* names, int count, int& out_fd) {
+    // try nodes in order, skip missing ones silently
+    for (int i = 0; i < count; ++i) {
+        const std::string path = dir + "/" + names[i];
+        if (access(path.c_str(), F_OK) != 0) continue;
+        int fd = open_wr(path);
+        if (fd >= 0) {
+            out_fd = fd;
+            return true;
+        }
+    }
+    out_fd = -1;
+    return false;
+}
+
+int write_int(int fd, long long v) {
+    if (fd < 0) return -1;
+
+    char buf[32];
+    auto res = std::to_chars(buf, buf + sizeof(buf) - 1, v);
+    if (res.ec != std::errc()) return -2;
+    *res.ptr++ = '\n';
+    const int len = (int)(res.ptr - buf);
+
+    // sysfs: offset 0 write is safe (pwrite: no separate lseek)
+    const char* p = buf;
+    int left = len;
+    while (left > 0) {
+        ssize_t n = pwrite(fd, p, left, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "[DVFS] write failed (fd=%d): %s\n", fd, strerror(errno));
+            return -3;
+        }
+        p += n;
+        left -= (int)n;
+    }
+    return 0;
+}
+
+int write_text(int fd, const std::string& s) {
+    if (fd < 0) return -1;
+    ssize_t n;
+    do {
+        n = pwrite(fd, s.c_str(), s.size(), 0);
+    } while (n < 0 && errno == EINTR);
+    if (n != (ssize_t)s.size()) {
+        fprintf(stderr, "[DVFS] write failed (fd=%d): %s\n", fd, n < 0 ? strerror(errno) : "short write");
+        return -3;
+    }
+    return 0;
+}
+
+int read_int(int fd, long long& v) {
+    if (fd < 0) return -1;
+
+    char buf[32];
+    ssize_t n;
+    do {
+        n = pread(fd, buf, sizeof(buf) - 1, 0);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) return -2;
+    buf[n] = '\0';
+
+    char* end = nullptr;
+    v = strtoll(buf, &end, 10);
+    return (end == buf) ? -3 : 0;
+}
+
+bool read_text(const std::string& path, std::string& out) {
+    std::ifstream file(path);
+    if (!file) return false;
+    std::stringstream ss;
+    ss << file.rdbuf();
+    out = ss.str();
+    while (!out.empty() && (out.back() == '\n' || out.back() == ' ')) out.pop_back();
+    return true;
+}
+
+// userspace governor: one scaling_setspeed write of the range top
+static int write_setspeed(RangeFd& r, int new_min, int new_max, bool verify, IoStats& stats, int unit) {
+    if (new_max == r.cur_max) {
+        stats.skipped++;
+        r.cur_min = new_min;
+        return 0;
+    }
+    stats.writes++;
+    if (write_int(r.set_fd, (long long)new_max * unit) != 0) {
+        r.cur_min = r.cur_max = -1;
+        return -1;
+    }
+    r.cur_min = new_min;
+    r.cur_max = new_max;
+    if (!verify) return 0;
+
+    // scaling_setspeed reads back the request itself (the transition is
+    // asynchronous, scaling_cur_freq may still show the old clock)
+    long long rb = -1;
+    stats.reads++;
+    if (read_int(r.set_fd, rb) != 0) return 0;
+    rb /= unit;
+    if (rb != new_max) {
+        fprintf(stderr, "[DVFS] read-back mismatch: setspeed %d, got %lld\n", new_max, rb);
+        r.cur_min = r.cur_max = (int)rb;
+        return -2;
+    }
+    // a freq_qos limit (thermal, power HAL) lowers scaling_max_freq below the
+    // request: the policy runs at the limit, the request stays cached
+    long long lim = -1;
+    stats.reads++;
+    if (read_int(r.max_fd, lim) != 0) return 0;
+    lim /= unit;
+    if (lim > 0 && lim < new_max) {
+        fprintf(stderr, "[DVFS] clamped by a kernel limit: setspeed %d, scaling_max_freq %lld\n", new_max, lim);
+        return -3;
+    }
+    return 0;
+}
+
+int write_range(RangeFd& r, int new_min, int new_max, bool verify, IoStats& stats, int unit) {
+    if (r.set_fd >= 0) return write_setspeed(r, new_min, new_max, verify, stats, unit);
+
+    const bool write_min = (new_min != r.cur_min);
+    const bool write_max = (new_max != r.cur_max);
+    stats.skipped += (write_min ? 0 : 1) + (write_max ? 0 : 1);
+    if (!write_min && !write_max) return 0;
+
+    auto put = [&](int fd, int v, int& cur) {
+        stats.writes++;
+        if (write_int(fd, (long long)v * unit) != 0) {
+            r.cur_min = r.cur_max = -1; // state unknown after a failed write
+            return false;
+        }
+        cur = v;
+        return true;
+    };
+
+    // direction-aware order: never pass through min > max
+    // - lowering: min first, then max
+    // - raising (or unknown state): max first, then min
+    const bool lowering = (r.cur_min >= 0 && new_min < r.cur_min);
+    if (lowering) {
+        if (write_min && !put(r.min_fd, new_min, r.cur_min)) return -1;
+        if (write_max && !put(r.max_fd, new_max, r.cur_max)) return -1;
+    } else {
+        if (write_max && !put(r.max_fd, new_max, r.cur_max)) return -1;
+        if (write_min && !put(r.min_fd, new_min, r.cur_min)) return -1;
+    }
+
+    if (!verify) return 0;
+
+    // read-back: the kernel may reject or clamp a value without write error
+    long long rb_min = -1, rb_max = -1;
+    stats.reads += 2;
+    if (read_int(r.min_fd, rb_min) != 0 || read_int(r.max_fd, rb_max) != 0) return 0; // write-only node
+    rb_min /= unit;
+    rb_max /= unit;
+    if (rb_min != new_min || rb_max != new_max) {
+        r.cur_min = (int)rb_min;
+        r.cur_max = (int)rb_max;
+        // a freq_qos limit (thermal, power HAL) clamps the request into its own
+        // [lo, hi] without a write error: the written values are kept
+        const bool clamped = rb_min <= rb_max && (rb_max <= new_max || rb_min == rb_max) &&
+                             (rb_min >= new_min || rb_min == rb_max);
+        fprintf(stderr, "[DVFS] %s: set [%d, %d], got [%lld, %lld]\n",
+                clamped ? "clamped by a kernel limit" : "read-back mismatch", new_min, new_max, rb_min, rb_max);
+        return clamped ? -3 : -2;
+    }
+    return 0;
+}
+
+void sync_range(RangeFd& r, IoStats& stats, int unit) {
+    long long v;
+    if (r.set_fd >= 0) {
+        r.cur_min = r.cur_max = (read_int(r.set_fd, v) == 0) ? (int)(v / unit) : -1;
+        stats.reads++;
+        return;
+    }
+    r.cur_min = (read_int(r.min_fd, v) == 0) ? (int)(v / unit) : -1;
+    r.cur_max = (read_int(r.max_fd, v) == 0) ? (int)(v / unit) : -1;
+    stats.reads += 2;
+}
+
+} // namespace sysfs
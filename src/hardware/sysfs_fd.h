@@ -0,0 +1,60 @@
+#ifndef SYSFS_FD_H
+#define SYSFS_FD_H
+
+#include <string>
+
+/* ** sysfs fd helpers **
+ *
+ * Shared by the cpufreq (DVFS) and devfreq (DevfreqDomain) write paths:
+ * cached fds, integer pread/pwrite at offset 0, and the direction-aware
+ * min/max range write with a state cache of the last programmed values.
+ */
+namespace sysfs {
+
+// sysfs I/O counters
+struct IoStats {
+    long writes = 0;
+    long reads = 0;
+    long skipped = 0; // no-op writes avoided by the state cache
+
+    IoStats& operator+=(const IoStats& o) {
+        writes += o.writes;
+        reads += o.reads;
+        skipped += o.skipped;
+        return *this;
+    }
+};
+
+// a min/max node pair and its last programmed values (-1: unknown)
+// set_fd >= 0 (cpufreq userspace governor): the range is only kept in the cache
+// and its top goes to scaling_setspeed in one write, verified on scaling_setspeed
+// (the request) and scaling_max_freq (a kernel limit below it is a clamp)
+struct RangeFd {
+    int min_fd = -1;
+    int max_fd = -1;
+    int cur_min = -1;
+    int cur_max = -1;
+    int set_fd = -1;
+};
+
+int open_wr(const std::string& path); // read-write if allowed, write-only otherwise (logs failure)
+int open_rd(const std::string& path); // optional read-only node (silent)
+void close_fd(int& fd);
+bool try_open_first(const std::string& dir, const char* const* names, int count, int& out_fd);
+
+int write_int(int fd, long long v);
+int write_text(int fd, const std::string& s);
+int read_int(int fd, long long& v);
+bool read_text(const std::string& path, std::string& out); // whole file, trailing newline stripped
+
+// write [new_min, new_max] (values / unit: node scale, 1000 for Hz nodes fed with kHz)
+// skips no-op writes; lowering writes min first, raising writes max first
+// return 0 on success, -1 on write failure, -2 on read-back mismatch,
+// -3 when the read-back is the request clamped by a kernel limit (freq_qos)
+int write_range(RangeFd& r, int new_min, int new_max, bool verify, IoStats& stats, int unit = 1);
+// re-read min/max into the state cache
+void sync_range(RangeFd& r, IoStats& stats, int unit = 1);
+
+} // namespace sysfs
+
+#endif // SYSFS_FD_H
@@ -0,0 +1,150 @@
+#include "thermal.h"
+#include "sysfs_fd.h"
+
+#include <dirent.h>
+#include <fnmatch.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <map>
+
+// per-device zone types (lower-cased)
+// Tensor / Exynos: BIG, MID, LITTLE, G3D
+// Snapdragon 8 Gen 1: cpu-0-N-usr (silver), cpu-1-N-usr (gold + prime), gpuss-N-usr
+static const std::map<std::string, std::vector<ThermalPattern>> device_patterns = {
+    { "Pixel9", { { "big", ThermalRole::BIG }, { "mid", ThermalRole::MID }, { "little", ThermalRole::LITTLE },
+                  { "g3d", ThermalRole::GPU }, { "virtual-skin*", ThermalRole::SKIN } } },
+    { "S24", { { "big", ThermalRole::BIG }, { "mid", ThermalRole::MID }, { "little", ThermalRole::LITTLE },
+               { "g3d", ThermalRole::GPU } } },
+    { "S22_Ultra", { { "cpu-0-*", ThermalRole::LITTLE }, { "cpu-1-*", ThermalRole::BIG },
+                     { "gpuss-*", ThermalRole::GPU } } },
+    { "Fold4", { { "cpu-0-*", ThermalRole::LITTLE }, { "cpu-1-*", ThermalRole::BIG },
+                 { "gpuss-*", ThermalRole::GPU } } },
+};
+
+static const std::vector<ThermalPattern> generic_patterns = {
+    { "*big*", ThermalRole::BIG }, { "*mid*", ThermalRole::MID }, { "*little*", ThermalRole::LITTLE },
+    { "*cpu*", ThermalRole::CPU }, { "*gpu*", ThermalRole::GPU }, { "g3d*", ThermalRole::GPU },
+    { "*skin*", ThermalRole::SKIN }, { "*batt*", ThermalRole::BATTERY },
+};
+
+const char* thermal_role_name(ThermalRole r) {
+    switch (r) {
+    case ThermalRole::BIG: return "BIG";
+    case ThermalRole::MID: return "MID";
+    case ThermalRole::LITTLE: return "LITTLE";
+    case ThermalRole::CPU: return "CPU";
+    case ThermalRole::GPU: return "GPU";
+    case ThermalRole::SKIN: return "SKIN";
+    case ThermalRole::BATTERY: return "BATTERY";
+    default: return "OTHER";
+    }
+}
+
+bool is_cpu_role(ThermalRole r) {
+    return r == ThermalRole::BIG || r == ThermalRole::MID || r == ThermalRole::LITTLE || r == ThermalRole::CPU;
+}
+
+ThermalRole thermal_role_of(const std::string& device, const std::string& type) {
+    std::string t = type;
+    std::transform(t.begin(), t.end(), t.begin(), ::tolower);
+
+    auto it = device_patterns.find(device);
+    if (it != device_patterns.end()) {
+        for (const auto& p : it->second) {
+            if (fnmatch(p.glob, t.c_str(), 0) == 0) return p.role;
+        }
+    }
+    for (const auto& p : generic_patterns) {
+        if (fnmatch(p.glob, t.c_str(), 0) == 0) return p.role;
+    }
+    return ThermalRole::OTHER;
+}
+
+ThermalRegistry::~ThermalRegistry() { close(); }
+
+int ThermalRegistry::open(const std::string& device, const std::string& root) {
+    close();
+    scanned = true;
+
+    std::string base = root + "/sys/class/thermal";
+    if (access(base.c_str(), F_OK) != 0) base = root + "/sys/devices/virtual/thermal";
+
+    DIR* dir = opendir(base.c_str());
+    if (!dir) return 0;
+    while (dirent* e = readdir(dir)) {
+        if (strncmp(e->d_name, "thermal_zone", 12) != 0) continue;
+        char* end;
+        long id = strtol(e->d_name + 12, &end, 10);
+        if (end == e->d_name + 12 || *end != '\0') continue;
+
+        ThermalZone z;
+        z.id = (int)id;
+        const std::string dir_path = base + "/" + e->d_name;
+        if (!sysfs::read_text(dir_path + "/type", z.type)) continue;
+        z.fd = sysfs::open_rd(dir_path + "/temp");
+        if (z.fd < 0) continue;
+        z.role = thermal_role_of(device, z.type);
+        zones.push_back(std::move(z));
+    }
+    closedir(dir);
+
+    std::sort(zones.begin(), zones.end(), [](const ThermalZone& a, const ThermalZone& b) { return a.id < b.id; });
+    return (int)zones.size();
+}
+
+void ThermalRegistry::close() {
+    for (auto& z : zones) sysfs::close_fd(z.fd);
+    zones.clear();
+    scanned = false;
+}
+
+int ThermalRegistry::count(ThermalRole r) const {
+    return (int)std::count_if(zones.begin(), zones.end(), [r](const ThermalZone& z) { return z.role == r; });
+}
+
+int ThermalRegistry::count_cpu() const {
+    return (int)std::count_if(zones.begin(), zones.end(), [](const ThermalZone& z) { return is_cpu_role(z.role); });
+}
+
+double ThermalRegistry::read(const ThermalZone& z) const {
+    long long v;
+    if (sysfs::read_int(z.fd, v) != 0) return NAN;
+    return (v > 1000 || v < -1000) ? v / 1000.0 : (double)v; // mdegC
+}
+
+double ThermalRegistry::max_of(ThermalRole r) const {
+    double high = NAN;
+    for (const auto& z : zones) {
+        if (z.role != r) continue;
+        double t = read(z);
+        if (!std::isnan(t) && !(t <= high)) high = t;
+    }
+    return high;
+}
+
+double ThermalRegistry::max_cpu() const {
+    double high = NAN;
+    for (const auto& z : zones) {
+        if (!is_cpu_role(z.role)) continue;
+        double t = read(z);
+        if (!std::isnan(t) && !(t <= high)) high = t;
+    }
+    return high;
+}
+
+std::string ThermalRegistry::describe() const {
+    std::string out;
+    for (ThermalRole r : { ThermalRole::BIG, ThermalRole::MID, ThermalRole::LITTLE, ThermalRole::CPU,
+                           ThermalRole::GPU, ThermalRole::SKIN, ThermalRole::BATTERY, ThermalRole::OTHER }) {
+        int n = count(r);
+        if (n == 0) continue;
+        if (!out.empty()) out += " ";
+        out += std::string(thermal_role_name(r)) + ":" + std::to_string(n);
+    }
+    return out.empty() ? "no thermal zone" : out;
+}
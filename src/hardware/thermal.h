@@ -0,0 +1,71 @@
+#ifndef THERMAL_H
+#define THERMAL_H
+
+#include <string>
+#include <vector>
+
+/* ** Thermal zone registry **
+ *
+ * Enumerates thermal_zoneN/type once (/sys/class/thermal, else
+ * /sys/devices/virtual/thermal), assigns every zone a role from the pattern
+ * table of the device (then the generic one; first match wins) and keeps a
+ * read-only fd on every temp node. A read is one pread per zone.
+ * Patterns are fnmatch globs on the lower-cased type.
+ *
+ * ex)
+ *   ThermalRegistry reg;
+ *   reg.open("Pixel9");
+ *   double cpu = reg.max_cpu();                       // BIG/MID/LITTLE/CPU zones
+ *   double gpu = reg.max_of(ThermalRole::GPU);        // NAN if the device has none
+ */
+enum class ThermalRole { BIG, MID, LITTLE, CPU, GPU, SKIN, BATTERY, OTHER };
+
+const char* thermal_role_name(ThermalRole r);
+
+struct ThermalZone {
+    int id = -1;               // thermal_zoneN
+    std::string type;
+    ThermalRole role = ThermalRole::OTHER;
+    int fd = -1;               // temp
+};
+
+struct ThermalPattern {
+    const char* glob;
+    ThermalRole role;
+};
+
+class ThermalRegistry {
+private:
+    std::vector<ThermalZone> zones;  // by zone id
+    bool scanned = false;
+
+public:
+    ThermalRegistry() = default;
+    ~ThermalRegistry();
+
+    ThermalRegistry(const ThermalRegistry&) = delete;
+    ThermalRegistry& operator=(const ThermalRegistry&) = delete;
+    ThermalRegistry(ThermalRegistry&& o) noexcept : zones(std::move(o.zones)), scanned(o.scanned) { o.zones.clear(); }
+
+    // return the number of zones opened
+    int open(const std::string& device, const std::string& root = "");
+    void close();
+    bool is_scanned() const { return scanned; }
+
+    const std::vector<ThermalZone>& get_zones() const { return zones; }
+    int count(ThermalRole r) const;
+    int count_cpu() const;
+
+    // degC (NAN if unreadable or no zone)
+    double read(const ThermalZone& z) const;
+    double max_of(ThermalRole r) const;
+    double max_cpu() const;
+
+    std::string describe() const; // ex. "BIG:1 MID:1 LITTLE:1 GPU:1 ..."
+};
+
+bool is_cpu_role(ThermalRole r);
+// role of a zone type for a device (generic table for unknown devices)
+ThermalRole thermal_role_of(const std::string& device, const std::string& type);
+
+#endif // THERMAL_H
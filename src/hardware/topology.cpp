@@ -0,0 +1,173 @@
+#include "topology.h"
+
+#include <dirent.h>
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+
+// read the whole first line of a sysfs file ("" if missing)
+static std::string read_line(const std::string& path) {
+    std::ifstream file(path);
+    std::string line;
+    if (file) std::getline(file, line);
+    return line;
+}
+
+std::vector<int> parse_cpu_list(const std::string& s) {
+    std::vector<int> cpus;
+
+    std::size_t i = 0;
+    while (i < s.size()) {
+        if (!isdigit((unsigned char)s[i])) { ++i; continue; }
+
+        // read a, then optional "-b"
+        int a = 0, b = -1;
+        while (i < s.size() && isdigit((unsigned char)s[i])) { a = a*10 + (s[i]-'0'); ++i; }
+        if (i < s.size() && s[i] == '-') {
+            ++i;
+            b = 0;
+            while (i < s.size() && isdigit((unsigned char)s[i])) { b = b*10 + (s[i]-'0'); ++i; }
+        }
+        if (b < a) b = a;
+        for (int c = a; c <= b; ++c) cpus.push_back(c);
+    }
+
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+// "32K", "1024K", "8M" -> kB
+static long parse_size_kb(const std::string& s) {
+    if (s.empty()) return 0;
+    long v = std::atol(s.c_str());
+    char unit = s.back();
+    if (unit == 'M' || unit == 'm') v *= 1024;
+    else if (unit == 'G' || unit == 'g') v *= 1024 * 1024;
+    else if (isdigit((unsigned char)unit)) v /= 1024; // plain bytes
+    return v;
+}
+
+static std::vector<CacheInfo> read_caches(const std::string& root, int cpu) {
+    std::vector<CacheInfo> caches;
+    for (int k = 0; ; ++k) {
+        const std::string base = root + "/cpu" + std::to_string(cpu) + "/cache/index" + std::to_string(k);
+        std::string level = read_line(base + "/level");
+        if (level.empty()) break;
+
+        CacheInfo c;
+        c.level = std::atoi(level.c_str());
+        c.type = read_line(base + "/type");
+        c.size_kb = parse_size_kb(read_line(base + "/size"));
+        c.shared_cpus = parse_cpu_list(read_line(base + "/shared_cpu_list"));
+        caches.push_back(c);
+    }
+    return caches;
+}
+
+Topology Topology::detect(const std::string& root) {
+    Topology topo;
+
+    std::vector<int> possible = parse_cpu_list(read_line(root + "/possible"));
+    if (possible.empty()) possible = parse_cpu_list(read_line(root + "/present"));
+
+    // per-cpu capacity (missing on symmetric systems)
+    int max_cpu = possible.empty() ? -1 : possible.back();
+    topo.capacities.assign(max_cpu + 1, 1024);
+    for (int cpu : possible) {
+        std::string cap = read_line(root + "/cpu" + std::to_string(cpu) + "/cpu_capacity");
+        if (!cap.empty()) topo.capacities[cpu] = std::atoi(cap.c_str());
+    }
+
+    // clusters from cpufreq policies
+    DIR* dir = opendir((root + "/cpufreq").c_str());
+    if (dir) {
+        struct dirent* ent;
+        while ((ent = readdir(dir)) != nullptr) {
+            std::string name = ent->d_name;
+            if (name.rfind("policy", 0) != 0) continue;
+
+            ClusterInfo c;
+            c.policy = std::atoi(name.c_str() + 6);
+            c.cpus = parse_cpu_list(read_line(root + "/cpufreq/" + name + "/related_cpus"));
+            if (c.cpus.empty()) c.cpus = { c.policy };
+            topo.clusters.push_back(c);
+        }
+        closedir(dir);
+    }
+
+    // no cpufreq: one cluster of all cpus
+    if (topo.clusters.empty() && !possible.empty()) {
+        ClusterInfo c;
+        c.policy = possible.front();
+        c.cpus = possible;
+        topo.clusters.push_back(c);
+    }
+
+    std::sort(topo.clusters.begin(), topo.clusters.end(),
+              [](const ClusterInfo& a, const ClusterInfo& b) { return a.policy < b.policy; });
+
+    for (auto& c : topo.clusters) {
+        c.capacity = topo.get_capacity(c.cpus.front());
+        c.caches = read_caches(root, c.cpus.front());
+    }
+
+    return topo;
+}
+
+const Topology& Topology::system() {
+    static const Topology topo = Topology::detect();
+    return topo;
+}
+
+std::vector<int> Topology::get_policies() const {
+    std::vector<int> policies;
+    for (const auto& c : clusters) policies.push_back(c.policy);
+    return policies;
+}
+
+int Topology::cluster_of(int cpu) const {
+    for (std::size_t i = 0; i < clusters.size(); ++i) {
+        const auto& cpus = clusters[i].cpus;
+        if (std::find(cpus.begin(), cpus.end(), cpu) != cpus.end()) return (int)i;
+    }
+    return -1;
+}
+
+int Topology::get_capacity(int cpu) const {
+    if (cpu < 0 || cpu >= (int)capacities.size()) return 1024;
+    return capacities[cpu];
+}
+
+long Topology::get_cache_kb(int cpu, int level) const {
+    int ci = cluster_of(cpu);
+    if (ci < 0) return 0;
+    for (const auto& c : clusters[ci].caches) {
+        if (c.level == level && c.type != "Instruction") return c.size_kb;
+    }
+    return 0;
+}
+
+std::vector<int> Topology::cpus_by_capacity() const {
+    std::vector<int> cpus;
+    for (const auto& c : clusters) cpus.insert(cpus.end(), c.cpus.begin(), c.cpus.end());
+    std::stable_sort(cpus.begin(), cpus.end(),
+                     [this](int a, int b) { return get_capacity(a) > get_capacity(b); });
+    return cpus;
+}
+
+std::string Topology::describe() const {
+    std::ostringstream oss;
+    for (const auto& c : clusters) {
+        oss << "policy" << c.policy << "[cpu" << c.cpus.front() << "-" << c.cpus.back()
+            << ", cap=" << c.capacity;
+        for (const auto& cache : c.caches) {
+            if (cache.type == "Instruction") continue;
+            oss << ", L" << cache.level << "=" << cache.size_kb << "K";
+        }
+        oss << "] ";
+    }
+    return oss.str();
+}
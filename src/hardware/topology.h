@@ -0,0 +1,62 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <string>
+#include <vector>
+
+/* ** CPU topology descriptor **
+ *
+ * Discovered once from sysfs:
+ * - cpufreq/policyN/related_cpus     -> clusters (policy index = first cpu)
+ * - cpuN/cpu_capacity                -> relative capacity (1024 = biggest core)
+ * - cpuN/cache/indexK/{level,type,size,shared_cpu_list} -> cache sizes
+ *
+ * Without cpufreq (ordinary servers, VMs), all possible cpus form one cluster.
+ *
+ * ex)
+ *   const Topology& topo = Topology::system();
+ *   for (const auto& c : topo.get_clusters()) { ... c.policy, c.cpus, c.capacity ... }
+ */
+struct CacheInfo {
+    int level = 0;
+    std::string type;           // Data | Instruction | Unified
+    long size_kb = 0;
+    std::vector<int> shared_cpus;
+};
+
+struct ClusterInfo {
+    int policy = -1;            // cpufreq policy index
+    std::vector<int> cpus;      // related cpus
+    int capacity = 1024;        // capacity of the first cpu
+    std::vector<CacheInfo> caches;
+};
+
+class Topology {
+private:
+    std::vector<ClusterInfo> clusters; // sorted by policy index
+    std::vector<int> capacities;       // per cpu (index = cpu id)
+
+    Topology() = default;
+
+public:
+    // detect from the given sysfs cpu root
+    static Topology detect(const std::string& root = "/sys/devices/system/cpu");
+    // detected once per process
+    static const Topology& system();
+
+    const std::vector<ClusterInfo>& get_clusters() const { return clusters; }
+    std::vector<int> get_policies() const;
+    int num_cpus() const { return (int)capacities.size(); }
+
+    int cluster_of(int cpu) const;              // position in get_clusters() (-1 if unknown)
+    int get_capacity(int cpu) const;            // 1024 if unknown
+    long get_cache_kb(int cpu, int level) const; // data/unified cache size (0 if unknown)
+    std::vector<int> cpus_by_capacity() const;  // biggest cores first
+
+    std::string describe() const;
+};
+
+// "0-3,6,8-9" -> {0,1,2,3,6,8,9} (also accepts space separated lists)
+std::vector<int> parse_cpu_list(const std::string& s);
+
+#endif // TOPOLOGY_H
@@ -0,0 +1,155 @@
+#include "trace_player.h"
+#include "utils/clock.h"
+
+#include <chrono>
+#include <thread>
+
+// "3,5,7" -> {3,5,7}
+static std::vector<int> split_ints(const std::string& s) {
+    std::vector<int> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) out.push_back(std::stoi(item));
+    }
+    return out;
+}
+
+std::vector<TraceStep> load_trace(const std::string& path) {
+    std::vector<TraceStep> steps;
+    std::ifstream file(path);
+    if (!file) {
+        fprintf(stderr, "[Trace] cannot open schedule: %s\n", path.c_str());
+        return steps;
+    }
+
+    std::string line;
+    int line_no = 0;
+    while (std::getline(file, line)) {
+        ++line_no;
+        std::size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+
+        std::istringstream iss(line);
+        std::string t_str, cpu_str, ram_str;
+        if (!(iss >> t_str)) continue; // blank line
+        if (!(iss >> cpu_str)) {
+            fprintf(stderr, "[Trace] %s:%d: missing cpu field\n", path.c_str(), line_no);
+            return {};
+        }
+        iss >> ram_str;
+
+        try {
+            TraceStep step;
+            step.time_sec = std::stod(t_str);
+            if (cpu_str.find(',') != std::string::npos) step.cpu_idx = split_ints(cpu_str);
+            else if (cpu_str != "-") step.prime_idx = std::stoi(cpu_str);
+            if (!ram_str.empty() && ram_str != "-") step.ram_idx = std::stoi(ram_str);
+            steps.push_back(step);
+        } catch (const std::exception&) {
+            fprintf(stderr, "[Trace] %s:%d: parse error\n", path.c_str(), line_no);
+            return {};
+        }
+    }
+
+    std::stable_sort(steps.begin(), steps.end(),
+                     [](const TraceStep& a, const TraceStep& b) { return a.time_sec < b.time_sec; });
+    return steps;
+}
+
+std::vector<TraceStep> square_wave_trace(int lo_idx, int hi_idx, double hz, double duration_sec, int ram_idx) {
+    std::vector<TraceStep> steps;
+    if (hz <= 0.0) return steps;
+
+    const double half = 0.5 / hz;
+    bool high = true;
+    for (int k = 0; k * half < duration_sec; ++k) {
+        TraceStep step;
+        step.time_sec = k * half;
+        step.prime_idx = high ? hi_idx : lo_idx;
+        if (k == 0) step.ram_idx = ram_idx;
+        steps.push_back(step);
+        high = !high;
+    }
+    return steps;
+}
+
+std::vector<TraceStep> chirp_trace(int lo_idx, int hi_idx, double f0_hz, double f1_hz, double duration_sec, int ram_idx) {
+    std::vector<TraceStep> steps;
+    if (f0_hz <= 0.0 || f1_hz <= 0.0 || duration_sec <= 0.0) return steps;
+
+    // linear chirp: phase(t) = 2pi (f0 t + (f1 - f0) t^2 / 2T), step on sign change
+    const double k = (f1_hz - f0_hz) / duration_sec;
+    const double dt = 1.0 / (50.0 * std::max(f0_hz, f1_hz));
+    int level = -1;
+    for (double t = 0.0; t < duration_sec; t += dt) {
+        double phase = 2.0 * M_PI * (f0_hz * t + 0.5 * k * t * t);
+        int now = std::sin(phase) >= 0.0 ? 1 : 0;
+        if (now == level) continue;
+
+        TraceStep step;
+        step.time_sec = t;
+        step.prime_idx = now ? hi_idx : lo_idx;
+        if (level < 0) step.ram_idx = ram_idx;
+        steps.push_back(step);
+        level = now;
+    }
+    return steps;
+}
+
+TracePlayer::TracePlayer(DVFS& dvfs) : dvfs(dvfs) {}
+
+int TracePlayer::play(const std::vector<TraceStep>& steps, const std::string& log_path, const std::atomic<bool>* stop) {
+    // resolve every step into a full state before playback (no mapping on the timed path)
+    // unchanged domains carry the previous step over, starting from the current state
+    std::vector<DvfsState> states(steps.size());
+    DvfsState cur = dvfs.get_state();
+    for (std::size_t i = 0; i < steps.size(); ++i) {
+        if (steps[i].prime_idx >= 0) cur.cpu_idx = dvfs.get_cpu_freqs_conf(steps[i].prime_idx);
+        else if (!steps[i].cpu_idx.empty()) cur.cpu_idx = steps[i].cpu_idx;
+        if (steps[i].ram_idx >= 0) cur.ram_idx = steps[i].ram_idx;
+        states[i] = cur;
+    }
+
+    std::vector<StepLog> logs;
+    logs.reserve(steps.size());
+
+    int failed = 0;
+    const int64_t t0 = now_ns() + 10000000; // 10 ms lead
+    for (std::size_t i = 0; i < steps.size(); ++i) {
+        if (stop && stop->load(std::memory_order_relaxed)) break;
+
+        const int64_t deadline = t0 + (int64_t)(steps[i].time_sec * 1e9);
+
+        // absolute deadline: coarse sleep, then spin
+        int64_t left = deadline - now_ns();
+        if (left > spin_ns) std::this_thread::sleep_for(std::chrono::nanoseconds(left - spin_ns));
+        while (now_ns() < deadline) {}
+
+        StepLog log;
+        log.target_ns = deadline;
+        log.start_ns = now_ns();
+        DvfsTxResult tx;
+        log.rc = dvfs.apply_state(states[i], &tx); // all domains or none
+        log.applied_ns = now_ns();
+        log.rolled_back = tx.rolled_back;
+
+        if (log.rc != 0) ++failed;
+        logs.push_back(log);
+    }
+
+    // log after playback (no file I/O on the timed path)
+    std::ofstream file(log_path);
+    if (!file) {
+        fprintf(stderr, "[Trace] cannot write log: %s\n", log_path.c_str());
+        return -1;
+    }
+    file << "step,target_s,start_s,applied_s,lateness_us,write_us,rc,rolled_back\n";
+    for (std::size_t i = 0; i < logs.size(); ++i) {
+        const StepLog& l = logs[i];
+        file << i << "," << (l.target_ns - t0) / 1e9 << "," << (l.start_ns - t0) / 1e9 << ","
+             << (l.applied_ns - t0) / 1e9 << "," << (l.start_ns - l.target_ns) / 1e3 << ","
+             << (l.applied_ns - l.start_ns) / 1e3 << "," << l.rc << "," << (l.rolled_back ? 1 : 0) << "\n";
+    }
+    return failed;
+}
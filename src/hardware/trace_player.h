@@ -0,0 +1,63 @@
+#ifndef TRACE_PLAYER_H
+#define TRACE_PLAYER_H
+
+#include "dvfs.h"
+
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+/* ** Frequency trace player **
+ *
+ * Schedule file (one step per line, '#' comments):
+ *   # time_sec  cpu        ram
+ *   0.000       12         11     <- prime cpu index (mapped by get_cpu_freqs_conf)
+ *   0.005       3,5,7      -1     <- per-cluster indices, ram unchanged
+ *   0.010       -          4      <- cpu unchanged
+ *
+ * Steps are applied at absolute deadlines from the start of playback:
+ * sleep until shortly before the deadline, then spin. Each step is one
+ * DVFS transaction (DVFS::apply_state), so a failed step leaves the previous
+ * configuration in place. The actual application time of each step is
+ * logged as csv.
+ */
+struct TraceStep {
+    double time_sec = 0.0;
+    int prime_idx = -1;          // single cpu index (-1: unused)
+    std::vector<int> cpu_idx;    // per-cluster indices (empty: unchanged)
+    int ram_idx = -1;            // -1: unchanged
+};
+
+// parse a schedule file (empty on error)
+std::vector<TraceStep> load_trace(const std::string& path);
+
+// synthetic patterns between two prime cpu indices
+std::vector<TraceStep> square_wave_trace(int lo_idx, int hi_idx, double hz, double duration_sec, int ram_idx = -1);
+std::vector<TraceStep> chirp_trace(int lo_idx, int hi_idx, double f0_hz, double f1_hz, double duration_sec, int ram_idx = -1);
+
+class TracePlayer {
+private:
+    DVFS& dvfs;
+    int64_t spin_ns = 200000; // spin before each deadline
+
+    struct StepLog {
+        int64_t target_ns;
+        int64_t start_ns;
+        int64_t applied_ns;
+        int rc;
+        bool rolled_back;
+    };
+
+public:
+    explicit TracePlayer(DVFS& dvfs);
+
+    void set_spin_us(int us) { spin_ns = (int64_t)us * 1000; }
+
+    // play steps in order (stop: optional early termination)
+    // return the number of failed steps, -1 if the log could not be written
+    int play(const std::vector<TraceStep>& steps, const std::string& log_path, const std::atomic<bool>* stop = nullptr);
+};
+
+#endif // TRACE_PLAYER_H
@@ -0,0 +1,147 @@
+#include "freq_search.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static constexpr double INFEASIBLE = 1e6; // cost floor of points violating the bound
+
+double search_cost(const SweepPoint& p, double min_throughput) {
+    if (p.rc != 0 || p.throughput <= 0.0) return std::numeric_limits<double>::infinity();
+    if (min_throughput > 0.0 && p.throughput < min_throughput) {
+        return INFEASIBLE * (1.0 + (min_throughput - p.throughput) / min_throughput);
+    }
+    return (p.power_w > 0.0 ? p.power_w : 1.0) / p.throughput;
+}
+
+FreqSearch::FreqSearch(std::vector<int> cpu_axis, std::vector<int> ram_axis, PointEval eval, double min_throughput)
+    : cpu_axis(std::move(cpu_axis)), ram_axis(std::move(ram_axis)), eval(std::move(eval)), min_throughput(min_throughput) {
+    if (this->ram_axis.empty()) this->ram_axis = { -1 };
+}
+
+double FreqSearch::cost(int ci, int ri) {
+    auto key = std::make_pair(ci, ri);
+    auto it = cache.find(key);
+    if (it != cache.end()) return it->second;
+
+    SweepPoint p = eval(cpu_axis[ci], ram_axis[ri]);
+    const double c = search_cost(p, min_throughput);
+    cache[key] = c;
+    visited.push_back(p);
+    return c;
+}
+
+int FreqSearch::golden(int lo, int hi, const std::function<double(int)>& f) {
+    // integer golden-section: shrink [lo, hi] around the minimum of a unimodal f
+    const double inv_phi = 0.6180339887498949;
+    while (hi - lo > 3) {
+        int c = hi - (int)std::lround((hi - lo) * inv_phi);
+        int d = lo + (int)std::lround((hi - lo) * inv_phi);
+        if (c >= d) d = c + 1;
+        if (f(c) <= f(d)) hi = d;
+        else lo = c;
+    }
+    int best = lo;
+    for (int i = lo + 1; i <= hi; ++i) {
+        if (f(i) < f(best)) best = i;
+    }
+    return best;
+}
+
+SearchResult FreqSearch::run(int max_rounds) {
+    cache.clear();
+    visited.clear();
+    SearchResult r;
+    if (cpu_axis.empty()) return r;
+
+    const int cpu_n = (int)cpu_axis.size(), ram_n = (int)ram_axis.size();
+    int cpu = cpu_n - 1, ram = ram_n - 1;
+    for (int round = 0; round < max_rounds; ++round) {
+        const int prev_cpu = cpu, prev_ram = ram;
+        cpu = golden(0, cpu_n - 1, [&](int i) { return cost(i, ram); });
+        if (ram_n > 1) ram = golden(0, ram_n - 1, [&](int j) { return cost(cpu, j); });
+        if (cpu == prev_cpu && ram == prev_ram && round > 0) break;
+    }
+
+    // neighbour pass: the axes are not independent (ex. memory-bound work)
+    for (bool moved = true; moved;) {
+        moved = false;
+        double best = cost(cpu, ram);
+        int bc = cpu, br = ram;
+        for (int dc = -1; dc <= 1; ++dc) {
+            for (int dr = -1; dr <= 1; ++dr) {
+                const int c = cpu + dc, r = ram + dr;
+                if ((dc == 0 && dr == 0) || c < 0 || c >= cpu_n || r < 0 || r >= ram_n) continue;
+                const double v = cost(c, r);
+                if (v < best) {
+                    best = v;
+                    bc = c;
+                    br = r;
+                }
+            }
+        }
+        if (bc != cpu || br != ram) {
+            cpu = bc;
+            ram = br;
+            moved = true;
+        }
+    }
+
+    r.cost = cost(cpu, ram);
+    r.feasible = r.cost < INFEASIBLE;
+    r.evaluations = (int)visited.size();
+    r.grid_size = cpu_n * ram_n;
+    r.visited = visited;
+    for (const auto& p : visited) {
+        if (p.cpu_idx == cpu_axis[cpu] && p.ram_idx == ram_axis[ram]) r.best = p;
+    }
+    return r;
+}
+
+SweepPoint exhaustive_best(const std::vector<SweepPoint>& grid, double min_throughput, bool* feasible) {
+    SweepPoint best;
+    double best_cost = std::numeric_limits<double>::infinity();
+    for (const auto& p : grid) {
+        const double c = search_cost(p, min_throughput);
+        if (c < best_cost) {
+            best_cost = c;
+            best = p;
+        }
+    }
+    if (feasible) *feasible = best_cost < INFEASIBLE;
+    return best;
+}
+
+std::vector<int> grid_axis(const std::vector<SweepPoint>& grid, bool cpu) {
+    std::vector<int> axis;
+    for (const auto& p : grid) axis.push_back(cpu ? p.cpu_idx : p.ram_idx);
+    std::sort(axis.begin(), axis.end());
+    axis.erase(std::unique(axis.begin(), axis.end()), axis.end());
+    return axis;
+}
+
+PointEval replay_eval(const std::vector<SweepPoint>& grid) {
+    std::map<std::pair<int, int>, SweepPoint> index;
+    for (const auto& p : grid) index[{ p.cpu_idx, p.ram_idx }] = p;
+    return [index](int cpu, int ram) {
+        auto it = index.find({ cpu, ram });
+        if (it != index.end()) return it->second;
+        SweepPoint missing;
+        missing.cpu_idx = cpu;
+        missing.ram_idx = ram;
+        missing.rc = -1;
+        return missing;
+    };
+}
+
+std::string search_report(const SearchResult& r, double min_throughput) {
+    char line[256];
+    snprintf(line, sizeof(line),
+             "search: best (cpu %d, ram %d) %.3f/s at %.2f W -> %.4g J/unit%s, %d of %d points measured (%.1f%%)",
+             r.best.cpu_idx, r.best.ram_idx, r.best.throughput, r.best.power_w, search_cost(r.best, 0.0),
+             r.feasible ? "" : (min_throughput > 0.0 ? " [bound not met]" : " [no valid point]"),
+             r.evaluations, r.grid_size, r.grid_size ? 100.0 * r.evaluations / r.grid_size : 0.0);
+    return line;
+}
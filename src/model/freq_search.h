@@ -0,0 +1,77 @@
+#ifndef FREQ_SEARCH_H
+#define FREQ_SEARCH_H
+
+#include "sweep.h"
+
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* ** Optimal frequency search **
+ *
+ * Finds the (prime cpu index, ram index) minimizing energy per unit of work
+ * (power / throughput, J per unit) subject to a minimum throughput
+ * (a latency bound L is a throughput bound 1 / L), measuring only a few
+ * grid points:
+ * - coordinate descent: golden-section search over the cpu index with the
+ *   ram index fixed, then over the ram index, until the point repeats
+ * - a final neighbour pass (8-neighbourhood) until no neighbour is better
+ * Infeasible points cost more than any feasible one, and less the closer
+ * they are to the bound, so the search walks back into the feasible set.
+ * The axes are lists of indices (ex. every other OPP); the search moves
+ * over positions in them. Every point is measured at most once (cached).
+ * Without power readings the cost falls back to time per unit of work.
+ *
+ * ex)
+ *   auto grid = load_sweep_csv("output/freq_sweep_decode.csv");
+ *   FreqSearch search(grid_axis(grid, true), grid_axis(grid, false), replay_eval(grid), 20.0); // >= 20 tok/s
+ *   SearchResult r = search.run();
+ *   SweepPoint opt = exhaustive_best(grid, 20.0);
+ */
+using PointEval = std::function<SweepPoint(int cpu, int ram)>;
+
+struct SearchResult {
+    SweepPoint best;
+    double cost = 0.0;
+    bool feasible = false;
+    int evaluations = 0;              // distinct points measured
+    int grid_size = 0;
+    std::vector<SweepPoint> visited;  // in measurement order
+};
+
+// energy per unit of work with the throughput bound as a penalty (lower is better)
+double search_cost(const SweepPoint& p, double min_throughput);
+
+class FreqSearch {
+private:
+    std::vector<int> cpu_axis, ram_axis; // indices ({ -1 }: ram released)
+    PointEval eval;
+    double min_throughput;
+    std::map<std::pair<int, int>, double> cache;
+    std::vector<SweepPoint> visited;
+
+public:
+    FreqSearch(std::vector<int> cpu_axis, std::vector<int> ram_axis, PointEval eval, double min_throughput = 0.0);
+
+    // start: highest OPPs (most likely feasible)
+    SearchResult run(int max_rounds = 4);
+
+private:
+    double cost(int ci, int ri); // positions on the axes
+    int golden(int lo, int hi, const std::function<double(int)>& f);
+};
+
+// best feasible point of a full grid (*feasible false: lowest-cost infeasible one)
+SweepPoint exhaustive_best(const std::vector<SweepPoint>& grid, double min_throughput, bool* feasible = nullptr);
+
+// distinct cpu (or ram) indices of a grid, ascending
+std::vector<int> grid_axis(const std::vector<SweepPoint>& grid, bool cpu);
+
+// evaluator over replayed sweep data (points missing from the grid get rc -1)
+PointEval replay_eval(const std::vector<SweepPoint>& grid);
+
+std::string search_report(const SearchResult& r, double min_throughput);
+
+#endif // FREQ_SEARCH_H
@@ -0,0 +1,188 @@
+#include "gov_sim.h"
+#include "work_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+// ---- traces ----
+UtilTrace util_trace_from_obs(const std::vector<PowerObs>& obs, const DVFS& dvfs, double step_s) {
+    UtilTrace tr;
+    tr.step_s = step_s;
+    const std::vector<int> clusters = dvfs.get_cluster_indices();
+
+    for (std::size_t k = 0; k + 1 < obs.size(); ++k) {
+        const double dt = obs[k + 1].t_s - obs[k].t_s;
+        if (!(dt > 0.0 && dt <= 5.0) || obs[k].cpu_idx.size() != clusters.size()) continue; // gap: next run
+        std::vector<double> w(clusters.size());
+        for (std::size_t s = 0; s < clusters.size(); ++s) {
+            const std::vector<int>& t = dvfs.get_cpu_freq().at(clusters[s]);
+            const int idx = std::min((int)t.size() - 1, std::max(0, obs[k].cpu_idx[s]));
+            w[s] = obs[k].util[s] * t[idx];
+        }
+        for (long n = std::lround(dt / step_s); n > 0; --n) tr.work.push_back(w);
+    }
+    return tr;
+}
+
+UtilTrace synth_util_trace(const DVFS& dvfs, const std::string& kind, double seconds, double step_s, unsigned seed) {
+    UtilTrace tr;
+    tr.step_s = step_s;
+    std::vector<double> f_max;
+    for (int p : dvfs.get_cluster_indices()) f_max.push_back(dvfs.get_cpu_freq().at(p).back());
+    const int nc = (int)f_max.size();
+    const long steps = std::max(1L, std::lround(seconds / step_s));
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> U(0.0, 1.0);
+
+    if (kind == "frames") {
+        // 60 fps: every frame arrives at once and is due within the frame;
+        // the prime cluster renders, the others carry lighter work, 1 frame in 10 is heavy
+        const double frame_s = 1.0 / 60.0;
+        tr.work.assign(steps, std::vector<double>(nc, 0.0));
+        for (double t = 0.0; t < seconds; t += frame_s) {
+            const long k = std::min(steps - 1, (long)(t / step_s));
+            const bool heavy = U(rng) < 0.1;
+            for (int s = 0; s < nc; ++s) {
+                double load = (s == nc - 1) ? 0.3 + 0.6 * U(rng) : 0.1 + 0.3 * U(rng);
+                if (heavy) load *= 1.2;
+                tr.work[k][s] += load * f_max[s] * frame_s / step_s;
+            }
+        }
+    } else if (kind == "bursty") {
+        // on/off per cluster: exponential phases (200 ms on, 300 ms off on average)
+        tr.work.assign(steps, std::vector<double>(nc, 0.0));
+        for (int s = 0; s < nc; ++s) {
+            std::exponential_distribution<double> on_len(1.0 / 0.2), off_len(1.0 / 0.3);
+            long k = 0;
+            while (k < steps) {
+                const long on = std::max(1L, std::lround(on_len(rng) / step_s));
+                const double rate = (0.2 + 0.8 * U(rng)) * f_max[s];
+                for (long i = 0; i < on && k < steps; ++i, ++k) tr.work[k][s] = rate;
+                k += std::lround(off_len(rng) / step_s);
+            }
+        }
+    } else if (kind == "ramp") {
+        for (long k = 0; k < steps; ++k) {
+            std::vector<double> w(nc);
+            for (int s = 0; s < nc; ++s) w[s] = f_max[s] * k / steps;
+            tr.work.push_back(w);
+        }
+    }
+    return tr;
+}
+
+
+// ---- simulator ----
+GovSim::GovSim(const DVFS& dvfs, const PowerModel& model, const ThermalNetwork* net)
+    : dvfs(dvfs), model(model), net(net) {
+    for (int p : dvfs.get_cluster_indices()) {
+        auto it = dvfs.get_cpu_freq().find(p);
+        tables.push_back(it != dvfs.get_cpu_freq().end() && !it->second.empty() ? &it->second : nullptr);
+    }
+}
+
+GovSimResult GovSim::run(const UtilTrace& trace, const GovSimConfig& cfg) const {
+    GovSimResult r;
+    const int nc = (int)tables.size();
+    const double dt = trace.step_s;
+    const long steps = (long)trace.work.size();
+    if (steps == 0 || nc == 0 || !cfg.policy) return r;
+
+    const long period = std::max(1L, std::lround(cfg.period_us / 1e6 / dt));
+    const long rate_limit = std::lround(cfg.rate_limit_us / 1e6 / dt);
+    const long deadline = std::max(1L, std::lround(cfg.deadline_ms / 1e3 / dt));
+    const long trace_every = trace_every_s > 0.0 ? std::max(1L, std::lround(trace_every_s / dt)) : 0;
+
+    // per slot: clock, FIFO backlog (kHz x s) and the work of the last `deadline` steps
+    std::vector<int> idx(nc, 0);
+    std::vector<long> last_change(nc, -rate_limit);
+    std::vector<double> backlog(nc, 0.0), recent(nc, 0.0), busy(nc, 0.0), busy_sum(nc, 0.0);
+    std::vector<std::vector<double>> ring(nc, std::vector<double>(deadline, 0.0));
+    for (int s = 0; s < nc; ++s) idx[s] = tables[s] ? (int)tables[s]->size() - 1 : -1;
+
+    std::vector<double> temp, power;
+    const ThermalStepper* stepper = nullptr;
+    ThermalStepper st(net ? *net : ThermalNetwork(), dt);
+    if (net && st.ok()) {
+        stepper = &st;
+        temp.assign(net->nodes.size(), net->ambient_c);
+    }
+    const double ambient = net ? net->ambient_c : 25.0;
+    r.peak_c = r.end_c = ambient;
+
+    long active = 0;
+    double prime_khz = 0.0;
+    for (long k = 0; k < steps; ++k) {
+        const std::vector<double>& w = trace.work[k];
+        for (int s = 0; s < nc; ++s) {
+            if (!tables[s]) continue;
+            const double in = (s < (int)w.size() ? w[s] : 0.0) * dt;
+            double& slot = ring[s][k % deadline];
+            recent[s] += in - slot;
+            slot = in;
+
+            const double had = backlog[s] + in;
+            const double cap = (*tables[s])[idx[s]] * dt;
+            const double served = std::min(had, cap);
+            backlog[s] = had - served;
+            busy[s] = served / cap;
+            busy_sum[s] += busy[s];
+            if (had > 0.0) ++active;
+            if (backlog[s] > recent[s] * (1.0 + 1e-9) + 1e-9) ++r.misses; // older work still queued
+        }
+        prime_khz += tables[nc - 1] ? (*tables[nc - 1])[idx[nc - 1]] : 0.0;
+
+        // power and temperature of this step
+        double watts;
+        if (stepper) {
+            node_power(*net, model, idx, busy, cfg.ram_idx, temp, power);
+            watts = 0.0;
+            for (double p : power) watts += p;
+            stepper->step(temp, power);
+            const double hot = temp[net->hottest_cpu(temp)];
+            r.peak_c = std::max(r.peak_c, hot);
+            r.end_c = hot;
+        } else {
+            watts = model.predict(idx, busy, cfg.ram_idx, ambient);
+        }
+        r.energy_j += watts * dt;
+        if (trace_every > 0 && k % trace_every == 0) r.temp_trace.push_back((float)r.end_c);
+
+        // governor: busy fraction averaged over its period, at its own clock
+        if ((k + 1) % period != 0) continue;
+        for (int s = 0; s < nc; ++s) {
+            if (!tables[s]) continue;
+            GovInput gi;
+            gi.slot = s;
+            gi.table = tables[s];
+            gi.cur_idx = idx[s];
+            gi.util = busy_sum[s] / period;
+            gi.now_ns = (int64_t)((k + 1) * dt * 1e9);
+            busy_sum[s] = 0.0;
+
+            const int next = std::min((int)tables[s]->size() - 1, std::max(0, cfg.policy(gi)));
+            if (next == idx[s] || k + 1 - last_change[s] < rate_limit) continue;
+            idx[s] = next;
+            last_change[s] = k + 1;
+            r.changes++;
+        }
+    }
+
+    r.avg_w = r.energy_j / (steps * dt);
+    r.miss_ratio = active > 0 ? (double)r.misses / active : 0.0;
+    r.mean_mhz = prime_khz / steps / 1000.0;
+    return r;
+}
+
+std::vector<GovSimResult> GovSim::sweep(const UtilTrace& trace, const std::vector<GovSimConfig>& cfgs,
+                                        int threads, long* steals) const {
+    std::vector<GovSimResult> results(cfgs.size());
+    WorkStealingPool pool(threads);
+    for (std::size_t i = 0; i < cfgs.size(); ++i) {
+        pool.submit([this, &trace, &cfgs, &results, i] { results[i] = run(trace, cfgs[i]); });
+    }
+    pool.wait();
+    if (steals) *steals = pool.steals();
+    return results;
+}
@@ -0,0 +1,80 @@
+#ifndef GOV_SIM_H
+#define GOV_SIM_H
+
+#include "governor.h"
+#include "power_model.h"
+#include "thermal_sim.h"
+
+#include <string>
+#include <vector>
+
+/* ** Offline governor evaluation **
+ *
+ * Replays a utilization trace through governor policies (governor.h) on the
+ * OPP tables of a device:
+ * - the trace is frequency-invariant work per step and cpu slot (kHz of
+ *   busy clock), queued FIFO and served at the simulated clock
+ * - the policy sees the busy fraction at its own clock every period_us,
+ *   with the rate limit of the Governor loop
+ * - work older than deadline_ms is a deadline miss (one per step and slot)
+ * - power from a PowerModel, temperatures from a ThermalNetwork (optional)
+ * Configurations are independent and run on a work-stealing pool.
+ *
+ * ex)
+ *   UtilTrace tr = synth_util_trace(dvfs, "frames", 60.0);
+ *   GovSim sim(dvfs, model, &net);
+ *   std::vector<GovSimConfig> cfgs = { { "schedutil", gov_schedutil }, { "ondemand", gov_ondemand } };
+ *   std::vector<GovSimResult> res = sim.sweep(tr, cfgs);
+ */
+struct UtilTrace {
+    double step_s = 0.001;
+    std::vector<std::vector<double>> work; // per step, per slot: kHz x busy fraction
+};
+
+// kernel_hard observations (load_hard_log()) held at a constant step: work = util x cur_freq
+UtilTrace util_trace_from_obs(const std::vector<PowerObs>& obs, const DVFS& dvfs, double step_s = 0.001);
+// kind: frames (60 fps bursts), bursty (random on/off), ramp (0 -> full load on every slot)
+// return an empty trace for an unknown kind
+UtilTrace synth_util_trace(const DVFS& dvfs, const std::string& kind, double seconds,
+                           double step_s = 0.001, unsigned seed = 1);
+
+struct GovSimConfig {
+    std::string name;          // label
+    GovPolicy policy;
+    int period_us = 10000;     // sampling period (the live Governor default)
+    int rate_limit_us = 10000; // min interval between two changes of one policy
+    int ram_idx = -1;          // fixed ram index (-1: highest observed by the model)
+    double deadline_ms = 16.7;
+};
+
+struct GovSimResult {
+    double energy_j = 0.0;
+    double avg_w = 0.0;
+    long misses = 0;           // steps x slots with overdue work
+    double miss_ratio = 0.0;   // of the steps x slots with work
+    long changes = 0;          // OPP changes
+    double mean_mhz = 0.0;     // prime cluster, time average
+    double peak_c = 0.0;       // hottest cluster (ambient without a network)
+    double end_c = 0.0;
+    std::vector<float> temp_trace; // hottest cluster every trace_every_s (if > 0)
+};
+
+class GovSim {
+private:
+    const DVFS& dvfs;
+    const PowerModel& model;
+    const ThermalNetwork* net;
+    std::vector<const std::vector<int>*> tables; // per slot
+
+public:
+    double trace_every_s = 0.0;
+
+    GovSim(const DVFS& dvfs, const PowerModel& model, const ThermalNetwork* net = nullptr);
+
+    GovSimResult run(const UtilTrace& trace, const GovSimConfig& cfg) const;
+    // one result per config (same order); steals: tasks taken from another worker
+    std::vector<GovSimResult> sweep(const UtilTrace& trace, const std::vector<GovSimConfig>& cfgs,
+                                    int threads = 0, long* steals = nullptr) const;
+};
+
+#endif // GOV_SIM_H
@@ -0,0 +1,101 @@
+#include "least_squares.h"
+
+#include <algorithm>
+#include <cmath>
+
+LeastSquares::LeastSquares(int num_params, int batch_rows)
+    : p(num_params), batch_rows(std::max(1, batch_rows)) {
+    ata.assign((std::size_t)p * p, 0.0);
+    aty.assign(p, 0.0);
+    buf.assign((std::size_t)p * this->batch_rows, 0.0);
+    ybuf.assign(this->batch_rows, 0.0);
+}
+
+void LeastSquares::add(const std::vector<double>& x, double y) {
+    if ((int)x.size() == p) add(x.data(), y);
+}
+
+void LeastSquares::add(const double* x, double y) {
+    for (int j = 0; j < p; ++j) buf[(std::size_t)j * batch_rows + buffered] = x[j];
+    ybuf[buffered] = y;
+    yy += y * y;
+    ysum += y;
+    ++rows;
+    if (++buffered == batch_rows) flush();
+}
+
+void LeastSquares::flush() {
+    const int n = buffered;
+    for (int i = 0; i < p; ++i) {
+        const double* ci = &buf[(std::size_t)i * batch_rows];
+        for (int j = i; j < p; ++j) {
+            const double* cj = &buf[(std::size_t)j * batch_rows];
+            double s = 0.0;
+            for (int k = 0; k < n; ++k) s += ci[k] * cj[k];
+            ata[(std::size_t)i * p + j] += s;
+        }
+        double s = 0.0;
+        for (int k = 0; k < n; ++k) s += ci[k] * ybuf[k];
+        aty[i] += s;
+    }
+    buffered = 0;
+}
+
+int LeastSquares::solve(std::vector<double>& beta, double ridge) {
+    flush();
+    if (rows < p) return 1;
+
+    double diag = 0.0;
+    for (int i = 0; i < p; ++i) diag += ata[(std::size_t)i * p + i];
+    const double lambda = ridge * std::max(diag / p, 1e-300);
+
+    // Cholesky of the symmetric matrix (upper triangle stored): L L^T
+    std::vector<double> L((std::size_t)p * p, 0.0);
+    for (int j = 0; j < p; ++j) {
+        double d = ata[(std::size_t)j * p + j] + lambda;
+        for (int k = 0; k < j; ++k) d -= L[(std::size_t)j * p + k] * L[(std::size_t)j * p + k];
+        if (!(d > 0.0)) return 2;
+        const double ljj = std::sqrt(d);
+        L[(std::size_t)j * p + j] = ljj;
+        for (int i = j + 1; i < p; ++i) {
+            double s = ata[(std::size_t)j * p + i]; // (i, j) = (j, i) of the upper triangle
+            for (int k = 0; k < j; ++k) s -= L[(std::size_t)i * p + k] * L[(std::size_t)j * p + k];
+            L[(std::size_t)i * p + j] = s / ljj;
+        }
+    }
+
+    // L z = A^T y, L^T beta = z
+    std::vector<double> z(p);
+    for (int i = 0; i < p; ++i) {
+        double s = aty[i];
+        for (int k = 0; k < i; ++k) s -= L[(std::size_t)i * p + k] * z[k];
+        z[i] = s / L[(std::size_t)i * p + i];
+    }
+    beta.assign(p, 0.0);
+    for (int i = p - 1; i >= 0; --i) {
+        double s = z[i];
+        for (int k = i + 1; k < p; ++k) s -= L[(std::size_t)k * p + i] * beta[k];
+        beta[i] = s / L[(std::size_t)i * p + i];
+    }
+    return 0;
+}
+
+double LeastSquares::rss(const std::vector<double>& beta) {
+    flush();
+    // |y - A b|^2 = y^T y - 2 b^T A^T y + b^T A^T A b
+    double r = yy;
+    for (int i = 0; i < p; ++i) {
+        r -= 2.0 * beta[i] * aty[i];
+        for (int j = 0; j < p; ++j) {
+            const double a = (i <= j) ? ata[(std::size_t)i * p + j] : ata[(std::size_t)j * p + i];
+            r += beta[i] * a * beta[j];
+        }
+    }
+    return std::max(0.0, r);
+}
+
+double LeastSquares::r2(const std::vector<double>& beta) {
+    if (rows == 0) return 0.0;
+    const double tss = yy - ysum * ysum / rows;
+    return tss > 0.0 ? 1.0 - rss(beta) / tss : 0.0;
+}
@@ -0,0 +1,48 @@
+#ifndef LEAST_SQUARES_H
+#define LEAST_SQUARES_H
+
+#include <vector>
+
+/* ** Batched linear least squares **
+ *
+ * Streams rows into the normal equations (A^T A, A^T y): rows are buffered
+ * column-major in batches, so every batch is one pass of contiguous dot
+ * products per (i, j) pair. solve() runs a Cholesky factorisation with a
+ * ridge term scaled by the mean diagonal (columns that never vary stay at 0
+ * instead of making the system singular). Memory is O(p^2), independent of
+ * the number of rows.
+ *
+ * ex)
+ *   LeastSquares ls(3);
+ *   for (...) ls.add({ x0, x1, x2 }, y);
+ *   std::vector<double> beta;
+ *   if (ls.solve(beta) == 0) { ... }
+ */
+class LeastSquares {
+private:
+    int p;
+    int batch_rows;
+    std::vector<double> ata, aty;     // p x p (upper triangle), p
+    std::vector<double> buf, ybuf;    // batch, column-major
+    int buffered = 0;
+    long rows = 0;
+    double yy = 0.0, ysum = 0.0;      // for R^2
+
+public:
+    explicit LeastSquares(int num_params, int batch_rows = 256);
+
+    void add(const std::vector<double>& x, double y);
+    void add(const double* x, double y);
+    long count() const { return rows; }
+
+    // return 0 on success (1: fewer rows than parameters, 2: not positive definite)
+    int solve(std::vector<double>& beta, double ridge = 1e-8);
+    // residual sum of squares of beta over the rows added (from the normal equations)
+    double rss(const std::vector<double>& beta);
+    double r2(const std::vector<double>& beta);
+
+private:
+    void flush();
+};
+
+#endif // LEAST_SQUARES_H
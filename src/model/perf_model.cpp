@@ -0,0 +1,99 @@
+#include "perf_model.h"
+#include "least_squares.h"
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <sstream>
+#include <utility>
+
+// clocks of a (prime, ram) pair in GHz (NAN: no table)
+static double cpu_ghz(DVFS& dvfs, int slot, int cpu_idx) {
+    const std::vector<int>& clusters = dvfs.get_cluster_indices();
+    const DvfsState st = dvfs.make_state(cpu_idx, -1);
+    if (slot < 0 || slot >= (int)clusters.size() || dvfs.get_cpu_freq().count(clusters[slot]) == 0) return NAN;
+    const std::vector<int>& t = dvfs.get_cpu_freq().at(clusters[slot]);
+    const int idx = (slot < (int)st.cpu_idx.size() && st.cpu_idx[slot] >= 0) ? st.cpu_idx[slot] : (int)t.size() - 1;
+    return t[std::min(idx, (int)t.size() - 1)] / 1e6;
+}
+
+static double ram_ghz(DVFS& dvfs, int ram_idx) {
+    const std::vector<int>& t = dvfs.get_ddr_freq();
+    if (t.empty()) return NAN;
+    return t[(ram_idx >= 0 && ram_idx < (int)t.size()) ? ram_idx : (int)t.size() - 1] / 1e6;
+}
+
+static int fit_phase(const std::vector<PerfPoint>& points, DVFS& dvfs, bool decode, PerfFit& out) {
+    const int nc = (int)dvfs.get_cluster_indices().size();
+    int rc = 2;
+    for (int slot = 0; slot < nc; ++slot) {
+        // both bounds, then one or none: the best fit with non-negative a, b
+        // (noise on flat points would otherwise give negative clock terms)
+        for (int mask : { 3, 1, 2, 0 }) {
+            const bool use_a = mask & 1, use_b = mask & 2;
+            const int p = 1 + use_a + use_b;
+            LeastSquares ls(p);
+            for (const auto& pt : points) {
+                const double y = decode ? pt.decode_ms : pt.prefill_ms;
+                const double fc = cpu_ghz(dvfs, slot, pt.cpu_idx), fr = ram_ghz(dvfs, pt.ram_idx);
+                if (!(y > 0.0) || std::isnan(fc) || std::isnan(fr)) continue;
+                std::vector<double> x;
+                if (use_a) x.push_back(1.0 / fc);
+                if (use_b) x.push_back(1.0 / fr);
+                x.push_back(1.0);
+                ls.add(x, y);
+            }
+            std::vector<double> beta;
+            if (ls.solve(beta) != 0) continue;
+
+            PerfFit f;
+            f.slot = slot;
+            int k = 0;
+            if (use_a) f.a = beta[k++];
+            if (use_b) f.b = beta[k++];
+            f.c = beta[k];
+            if (f.a < 0.0 || f.b < 0.0) continue;
+            f.rmse_ms = std::sqrt(std::max(0.0, ls.rss(beta)) / ls.count());
+            if (rc != 0 || f.rmse_ms < out.rmse_ms) out = f;
+            rc = 0;
+            break;
+        }
+    }
+    return rc;
+}
+
+int PerfModel::fit(const std::vector<PerfPoint>& points, DVFS& dvfs) {
+    std::set<std::pair<int, int>> pairs;
+    for (const auto& p : points) pairs.insert({ p.cpu_idx, p.ram_idx });
+    if (pairs.size() < 3) return 1;
+
+    PerfFit pf, df;
+    if (fit_phase(points, dvfs, false, pf) != 0 || fit_phase(points, dvfs, true, df) != 0) return 2;
+    prefill = pf;
+    decode = df;
+    return 0;
+}
+
+double PerfModel::predict(DVFS& dvfs, int cpu_idx, int ram_idx, bool decode_phase) const {
+    const PerfFit& f = decode_phase ? decode : prefill;
+    return f.a / cpu_ghz(dvfs, f.slot, cpu_idx) + f.b / ram_ghz(dvfs, ram_idx) + f.c;
+}
+
+double PerfModel::compute_share(DVFS& dvfs, int cpu_idx, int ram_idx, bool decode_phase) const {
+    const PerfFit& f = decode_phase ? decode : prefill;
+    const double t = predict(dvfs, cpu_idx, ram_idx, decode_phase);
+    return t > 0.0 ? f.a / cpu_ghz(dvfs, f.slot, cpu_idx) / t : 0.0;
+}
+
+std::string PerfModel::describe(DVFS& dvfs) const {
+    std::ostringstream out;
+    out.precision(4);
+    const std::vector<int>& clusters = dvfs.get_cluster_indices();
+    for (int k = 0; k < 2; ++k) {
+        const PerfFit& f = k ? decode : prefill;
+        out << (k ? "decode " : "prefill") << ": t = " << f.a << " / f_cpu" << clusters[f.slot] << " + " << f.b
+            << " / f_ram + " << f.c << " ms (GHz), rmse " << f.rmse_ms << " ms";
+        if (k == 0) out << "\n";
+    }
+    return out.str();
+}
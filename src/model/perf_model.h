@@ -0,0 +1,54 @@
+#ifndef PERF_MODEL_H
+#define PERF_MODEL_H
+
+#include "dvfs.h"
+
+#include <string>
+#include <vector>
+
+/* ** Throughput model of the dummy LLM **
+ *
+ * Time per token at a (cpu, ram) clock pair, roofline-style as a sum of a
+ * compute-bound and a memory-bound part:
+ *   t = a / f_cpu + b / f_ram + c     (ms, clocks in GHz)
+ * fitted by least squares on a few measured points, separately for prefill
+ * (GEMM, per prompt token) and decode (GEMV, per output token). The threads
+ * are not pinned, so every cluster is tried as f_cpu and the one that fits
+ * the points best is kept. a and b are kept non-negative (a term is dropped
+ * when the points cannot resolve it).
+ *
+ * ex)
+ *   std::vector<PerfPoint> pts = { { 4, 0, 2.1, 9.5 }, { 12, 0, 0.9, 8.7 }, ... };
+ *   PerfModel m;
+ *   if (m.fit(pts, dvfs) == 0) {
+ *       double ttft_ms = 64 * m.predict(dvfs, 8, 5, false);
+ *       double tpot_ms = m.predict(dvfs, 8, 5, true);
+ *   }
+ */
+struct PerfPoint {
+    int cpu_idx = -1;          // prime index (DVFS::make_state())
+    int ram_idx = -1;
+    double prefill_ms = 0.0;   // per prompt token
+    double decode_ms = 0.0;    // per output token
+};
+
+struct PerfFit {
+    int slot = -1;             // cluster whose clock is f_cpu
+    double a = 0.0, b = 0.0, c = 0.0;
+    double rmse_ms = 0.0;      // on the fitted points
+};
+
+class PerfModel {
+public:
+    PerfFit prefill, decode;   // best cluster of each phase
+
+    // return 0 on success (1: fewer than 3 distinct clock pairs, 2: degenerate points)
+    int fit(const std::vector<PerfPoint>& points, DVFS& dvfs);
+    // ms per token (decode: TPOT; prefill: per prompt token, x seq_len for TTFT)
+    double predict(DVFS& dvfs, int cpu_idx, int ram_idx, bool decode) const;
+    // share of the compute-bound term a / f_cpu in the prediction
+    double compute_share(DVFS& dvfs, int cpu_idx, int ram_idx, bool decode) const;
+    std::string describe(DVFS& dvfs) const;
+};
+
+#endif // PERF_MODEL_H
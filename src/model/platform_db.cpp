@@ -0,0 +1,191 @@
+#include "platform_db.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+std::string platform_db_path(const std::string& device) {
+    const char* dir = getenv("DDS_CACHE_DIR");
+    if (!dir || !*dir) dir = getenv("HOME");
+    std::string base = (dir && *dir) ? std::string(dir) : std::string(".");
+    if (base.back() != '/') base += "/";
+    return base + ".dds_platform_" + device + ".txt";
+}
+
+void PlatformDb::put(const ComputePeak& p) {
+    for (auto& c : compute) {
+        if (c.policy == p.policy && c.khz == p.khz) {
+            c = p;
+            return;
+        }
+    }
+    compute.push_back(p);
+    std::sort(compute.begin(), compute.end(), [](const ComputePeak& a, const ComputePeak& b) {
+        return a.policy != b.policy ? a.policy < b.policy : a.khz < b.khz;
+    });
+}
+
+void PlatformDb::put(const MemPeak& p) {
+    for (auto& m : mem) {
+        if (m.policy == p.policy && m.cpu_khz == p.cpu_khz && m.ram_khz == p.ram_khz) {
+            m = p;
+            return;
+        }
+    }
+    mem.push_back(p);
+    std::sort(mem.begin(), mem.end(), [](const MemPeak& a, const MemPeak& b) {
+        if (a.policy != b.policy) return a.policy < b.policy;
+        return a.cpu_khz != b.cpu_khz ? a.cpu_khz < b.cpu_khz : a.ram_khz < b.ram_khz;
+    });
+}
+
+double PlatformDb::peak_gflops(int policy, int khz, bool simd) const {
+    // compute is sorted by (policy, khz)
+    const ComputePeak* lo = nullptr;
+    const ComputePeak* hi = nullptr;
+    for (const auto& c : compute) {
+        if (c.policy != policy) continue;
+        if (c.khz <= khz) lo = &c;
+        if (c.khz >= khz && !hi) hi = &c;
+    }
+    if (!lo && !hi) return NAN;
+    auto v = [simd](const ComputePeak* c) { return simd ? c->simd_gflops : c->scalar_gflops; };
+    if (!lo) return v(hi);
+    if (!hi || hi->khz == lo->khz) return v(lo);
+    const double t = (double)(khz - lo->khz) / (hi->khz - lo->khz);
+    return v(lo) + t * (v(hi) - v(lo));
+}
+
+double PlatformDb::bandwidth_gbs(int policy, int cpu_khz, int ram_khz, MemKernel k) const {
+    // nearest in relative clock distance
+    const MemPeak* best = nullptr;
+    double best_d = 0.0;
+    for (const auto& m : mem) {
+        if (m.policy != policy || m.cpu_khz <= 0 || m.ram_khz <= 0) continue;
+        const double d = std::fabs(std::log((double)m.cpu_khz / std::max(1, cpu_khz))) +
+                         std::fabs(std::log((double)m.ram_khz / std::max(1, ram_khz)));
+        if (!best || d < best_d) {
+            best = &m;
+            best_d = d;
+        }
+    }
+    if (!best) return NAN;
+    switch (k) {
+        case MemKernel::READ: return best->read_gbs;
+        case MemKernel::WRITE: return best->write_gbs;
+        default: return best->copy_gbs;
+    }
+}
+
+double PlatformDb::balance(int policy, int cpu_khz, int ram_khz) const {
+    const double bw = bandwidth_gbs(policy, cpu_khz, ram_khz, MemKernel::READ);
+    return bw > 0.0 ? peak_gflops(policy, cpu_khz, true) / bw : NAN;
+}
+
+double PlatformDb::balance(const DVFS& dvfs, int slot, int cpu_idx, int ram_idx) const {
+    const std::vector<int>& clusters = dvfs.get_cluster_indices();
+    if (slot < 0 || slot >= (int)clusters.size() || dvfs.get_cpu_freq().count(clusters[slot]) == 0) return NAN;
+    const std::vector<int>& ct = dvfs.get_cpu_freq().at(clusters[slot]);
+    const std::vector<int>& rt = dvfs.get_ddr_freq();
+    if (ct.empty() || rt.empty()) return NAN;
+    const int ci = (cpu_idx >= 0 && cpu_idx < (int)ct.size()) ? cpu_idx : (int)ct.size() - 1;
+    const int ri = (ram_idx >= 0 && ram_idx < (int)rt.size()) ? ram_idx : (int)rt.size() - 1;
+    return balance(clusters[slot], ct[ci], rt[ri]);
+}
+
+int PlatformDb::save(const std::string& path) const {
+    std::ofstream f(path);
+    if (!f) return -1;
+    f.precision(6);
+    f << "# dds platform db: compute policy kHz scalar_gflops simd_gflops / mem policy cpu_kHz ram_kHz read write copy (GB/s)\n";
+    f << "version " << VERSION << "\n";
+    f << "device " << device << "\n";
+    f << "kernel " << (kernel.empty() ? "-" : kernel) << "\n";
+    f << "bench " << threads << " " << seconds << " " << buffer_kb << "\n";
+    for (const auto& c : compute) {
+        f << "compute " << c.policy << " " << c.khz << " " << c.scalar_gflops << " " << c.simd_gflops << "\n";
+    }
+    for (const auto& m : mem) {
+        f << "mem " << m.policy << " " << m.cpu_khz << " " << m.ram_khz << " " << m.read_gbs << " " << m.write_gbs
+          << " " << m.copy_gbs << "\n";
+    }
+    return f ? 0 : -1;
+}
+
+int PlatformDb::load(const std::string& path, const std::string& expect_device) {
+    std::ifstream f(path);
+    if (!f) return -1;
+
+    PlatformDb db;
+    int version = -1;
+    std::string line;
+    while (std::getline(f, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream ss(line);
+        std::string key;
+        ss >> key;
+        if (key == "version") {
+            ss >> version;
+            if (version != VERSION) return -3;
+        } else if (version != VERSION) {
+            return -3; // the version line comes first
+        } else if (key == "device") {
+            ss >> db.device;
+        } else if (key == "kernel") {
+            ss >> db.kernel;
+            if (db.kernel == "-") db.kernel.clear();
+        } else if (key == "bench") {
+            ss >> db.threads >> db.seconds >> db.buffer_kb;
+        } else if (key == "compute") {
+            ComputePeak c;
+            ss >> c.policy >> c.khz >> c.scalar_gflops >> c.simd_gflops;
+            db.compute.push_back(c);
+        } else if (key == "mem") {
+            MemPeak m;
+            ss >> m.policy >> m.cpu_khz >> m.ram_khz >> m.read_gbs >> m.write_gbs >> m.copy_gbs;
+            db.mem.push_back(m);
+        } else {
+            return -2;
+        }
+        if (ss.fail()) return -2;
+    }
+    if (version != VERSION) return -3;
+    if (!expect_device.empty() && db.device != expect_device) return -2;
+    *this = db;
+    return 0;
+}
+
+std::string PlatformDb::describe() const {
+    std::ostringstream out;
+    out.precision(4);
+    out << "platform db (" << device << (kernel.empty() ? "" : ", " + kernel) << ", v" << VERSION << ", "
+        << compute.size() << " compute / " << mem.size() << " memory points)";
+    // highest clocks per policy
+    std::vector<int> policies;
+    for (const auto& c : compute) {
+        if (std::find(policies.begin(), policies.end(), c.policy) == policies.end()) policies.push_back(c.policy);
+    }
+    for (const auto& m : mem) {
+        if (std::find(policies.begin(), policies.end(), m.policy) == policies.end()) policies.push_back(m.policy);
+    }
+    for (int p : policies) {
+        int cpu_khz = 0, ram_khz = 0;
+        for (const auto& c : compute) if (c.policy == p) cpu_khz = std::max(cpu_khz, c.khz);
+        for (const auto& m : mem) {
+            if (m.policy != p) continue;
+            cpu_khz = std::max(cpu_khz, m.cpu_khz);
+            ram_khz = std::max(ram_khz, m.ram_khz);
+        }
+        out << "\n  policy" << p << " at " << cpu_khz / 1000 << " MHz";
+        if (ram_khz > 0) out << " / ram " << ram_khz / 1000 << " MHz";
+        out << ": " << peak_gflops(p, cpu_khz, false) << " scalar, " << peak_gflops(p, cpu_khz, true)
+            << " SIMD GFLOP/s, read " << bandwidth_gbs(p, cpu_khz, ram_khz, MemKernel::READ) << ", write "
+            << bandwidth_gbs(p, cpu_khz, ram_khz, MemKernel::WRITE) << ", copy "
+            << bandwidth_gbs(p, cpu_khz, ram_khz, MemKernel::COPY) << " GB/s, balance "
+            << balance(p, cpu_khz, ram_khz) << " FLOP/B";
+    }
+    return out.str();
+}
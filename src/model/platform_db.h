@@ -0,0 +1,81 @@
+#ifndef PLATFORM_DB_H
+#define PLATFORM_DB_H
+
+#include "dvfs.h"
+#include "workload/burn.h"
+
+#include <string>
+#include <vector>
+
+/* ** Platform characterization database **
+ *
+ * Sustained peaks of a device, measured once by platform_char with the
+ * burner kernels (workload/burn.h), threads pinned to one cluster:
+ * - per cluster OPP: scalar and SIMD GFLOP/s
+ * - per cluster OPP x DDR OPP: read, write and copy GB/s
+ * Points are keyed by kHz, so they survive OPP table changes. The file is
+ * text with a version header; a file of another version or device does not
+ * load, and the tool measures again.
+ * Machine balance (FLOP per byte at which a kernel turns compute-bound) is
+ * the SIMD peak over the read bandwidth.
+ *
+ * ex)
+ *   PlatformDb db;
+ *   if (db.load(platform_db_path("Pixel9"), "Pixel9") == 0) {
+ *       double gflops = db.peak_gflops(7, 3105000);
+ *       double balance = db.balance(7, 3105000, 3744000); // FLOP/B
+ *   }
+ */
+struct ComputePeak {
+    int policy = -1;
+    int khz = 0;
+    double scalar_gflops = 0.0;
+    double simd_gflops = 0.0;
+};
+
+struct MemPeak {
+    int policy = -1;
+    int cpu_khz = 0;
+    int ram_khz = 0;
+    double read_gbs = 0.0;
+    double write_gbs = 0.0;
+    double copy_gbs = 0.0;
+};
+
+class PlatformDb {
+public:
+    static constexpr int VERSION = 2; // bump when the kernels or the layout change
+
+    std::string device;
+    std::string kernel;          // uname release when measured
+    int threads = 0;             // per cluster (0: every cpu of the cluster)
+    double seconds = 0.0;        // per kernel and point
+    long buffer_kb = 0;          // per thread, memory kernels
+    std::vector<ComputePeak> compute;
+    std::vector<MemPeak> mem;
+
+    bool empty() const { return compute.empty() && mem.empty(); }
+
+    // replace the point of the same policy and clocks (or add it)
+    void put(const ComputePeak& p);
+    void put(const MemPeak& p);
+
+    // GFLOP/s, linear in kHz between measured OPPs (nearest outside); NAN: policy not measured
+    double peak_gflops(int policy, int khz, bool simd = true) const;
+    // GB/s of the nearest measured (cpu, ram) pair; NAN: policy not measured
+    double bandwidth_gbs(int policy, int cpu_khz, int ram_khz, MemKernel k = MemKernel::READ) const;
+    // SIMD GFLOP/s / read GB/s
+    double balance(int policy, int cpu_khz, int ram_khz) const;
+    // same by OPP indices of the DVFS tables (slot: position in cluster_indices, -1: highest OPP)
+    double balance(const DVFS& dvfs, int slot, int cpu_idx, int ram_idx) const;
+
+    // return 0 on success (-1: I/O, -2: syntax or device mismatch, -3: other version)
+    int save(const std::string& path) const;
+    int load(const std::string& path, const std::string& expect_device = "");
+    std::string describe() const;
+};
+
+// $DDS_CACHE_DIR (else $HOME)/.dds_platform_<device>.txt
+std::string platform_db_path(const std::string& device);
+
+#endif // PLATFORM_DB_H
@@ -0,0 +1,306 @@
+#include "power_model.h"
+#include "least_squares.h"
+#include "thermal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+static int nearest_index(const std::vector<int>& table, double khz) {
+    int best = -1;
+    double best_d = 0.0;
+    for (int i = 0; i < (int)table.size(); ++i) {
+        const double d = std::fabs(table[i] - khz);
+        if (best < 0 || d < best_d) { best = i; best_d = d; }
+    }
+    return best;
+}
+
+// ---- model ----
+double PowerModel::cluster_w(int slot, int idx, double util, double temp_c) const {
+    if (slot < 0 || slot >= (int)clusters.size()) return 0.0;
+    const ClusterPower& c = clusters[slot];
+    if (idx < 0 || idx >= (int)c.khz.size()) idx = (int)c.khz.size() - 1; // released: top
+    if (idx < 0) return 0.0;
+    const double v = c.uv[idx] / 1e6;
+    return c.dyn * util * v * v * (c.khz[idx] / 1e6) + c.leak * v + c.leak_t * v * (temp_c - 25.0);
+}
+
+double PowerModel::mif_power(int ram_idx) const {
+    int best = -1;
+    for (int i = 0; i < (int)mif_w.size(); ++i) {
+        if (std::isnan(mif_w[i])) continue;
+        if (ram_idx < 0) { best = i; continue; } // highest observed
+        if (best < 0 || std::abs(i - ram_idx) < std::abs(best - ram_idx)) best = i;
+    }
+    return best < 0 ? 0.0 : mif_w[best];
+}
+
+double PowerModel::predict(const std::vector<int>& cpu_idx, const std::vector<double>& util, int ram_idx, double temp_c) const {
+    double w = mif_power(ram_idx);
+    for (int s = 0; s < (int)clusters.size(); ++s) {
+        const int idx = s < (int)cpu_idx.size() ? cpu_idx[s] : -1;
+        const double u = s < (int)util.size() ? util[s] : 1.0;
+        w += cluster_w(s, idx, u, temp_c);
+    }
+    return w;
+}
+
+std::string power_model_path(const std::string& device) {
+    const char* dir = getenv("DDS_CACHE_DIR");
+    if (!dir || !*dir) dir = getenv("HOME");
+    std::string base = (dir && *dir) ? std::string(dir) : std::string(".");
+    if (base.back() != '/') base += "/";
+    return base + ".dds_power_" + device + ".txt";
+}
+
+int PowerModel::save(const std::string& path) const {
+    std::ofstream f(path);
+    if (!f) return -1;
+    f.precision(9);
+    f << "# dds power model: P = sum(dyn*util*V^2*GHz + leak*V + leak_t*V*(T-25)) + mif[idx]\n";
+    f << "device " << device << "\n";
+    f << "voltage_proxy " << (voltage_proxy ? 1 : 0) << "\n";
+    f << "fit " << samples << " " << rmse_w << " " << r2 << "\n";
+    for (const auto& c : clusters) {
+        f << "cluster " << c.policy << " " << c.dyn << " " << c.leak << " " << c.leak_t << " " << c.khz.size();
+        for (std::size_t i = 0; i < c.khz.size(); ++i) f << " " << c.khz[i] << ":" << c.uv[i];
+        f << "\n";
+    }
+    f << "mif " << ddr_khz.size();
+    for (std::size_t i = 0; i < ddr_khz.size(); ++i) {
+        f << " " << ddr_khz[i] << ":";
+        if (std::isnan(mif_w[i])) f << "nan";
+        else f << mif_w[i];
+    }
+    f << "\n";
+    return f ? 0 : -1;
+}
+
+int PowerModel::load(const std::string& path, const std::string& expect_device) {
+    std::ifstream f(path);
+    if (!f) return -1;
+
+    PowerModel m;
+    std::string line;
+    while (std::getline(f, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream ss(line);
+        std::string key;
+        ss >> key;
+        if (key == "device") {
+            ss >> m.device;
+        } else if (key == "voltage_proxy") {
+            int v = 0;
+            ss >> v;
+            m.voltage_proxy = v != 0;
+        } else if (key == "fit") {
+            ss >> m.samples >> m.rmse_w >> m.r2;
+        } else if (key == "cluster" || key == "mif") {
+            ClusterPower c;
+            std::size_t n = 0;
+            if (key == "cluster") ss >> c.policy >> c.dyn >> c.leak >> c.leak_t;
+            if (!(ss >> n)) return -2;
+            for (std::size_t i = 0; i < n; ++i) {
+                std::string item;
+                if (!(ss >> item) || item.find(':') == std::string::npos) return -2;
+                const int khz = atoi(item.c_str());
+                const std::string val = item.substr(item.find(':') + 1);
+                if (key == "cluster") {
+                    c.khz.push_back(khz);
+                    c.uv.push_back(atoi(val.c_str()));
+                } else {
+                    m.ddr_khz.push_back(khz);
+                    m.mif_w.push_back(val == "nan" ? NAN : atof(val.c_str()));
+                }
+            }
+            if (key == "cluster") m.clusters.push_back(c);
+        } else {
+            return -2;
+        }
+        if (ss.fail() && !ss.eof()) return -2;
+    }
+    if (m.clusters.empty() || (!expect_device.empty() && m.device != expect_device)) return -2;
+    *this = m;
+    return 0;
+}
+
+std::string PowerModel::describe() const {
+    std::ostringstream out;
+    out.precision(4);
+    out << "power model (" << device << ", " << samples << " samples, rmse " << rmse_w << " W, R^2 " << r2
+        << (voltage_proxy ? ", voltage proxy" : "") << ")\n";
+    for (const auto& c : clusters) {
+        out << "  policy" << c.policy << ": dyn " << c.dyn << " W/(V^2 GHz), leak " << c.leak
+            << " W/V, leak_t " << c.leak_t << " W/(V degC)\n";
+    }
+    out << "  mif:";
+    for (std::size_t i = 0; i < mif_w.size(); ++i) {
+        if (!std::isnan(mif_w[i])) out << " [" << i << "] " << mif_w[i] << " W";
+    }
+    return out.str();
+}
+
+// ---- kernel_hard logs ----
+static std::vector<std::string> split_csv(const std::string& line) {
+    std::vector<std::string> out;
+    std::string cur;
+    for (char ch : line) {
+        if (ch == ',') { out.push_back(cur); cur.clear(); }
+        else if (ch != '\0' && ch != '\r' && ch != ' ') cur += ch; // meminfo names carry NULs
+    }
+    if (!cur.empty()) out.push_back(cur);
+    return out;
+}
+
+int load_hard_log(const std::string& path, const DVFS& dvfs, std::vector<PowerObs>& out) {
+    std::ifstream f(path);
+    if (!f) return -1;
+    std::string line;
+    if (!std::getline(f, line)) return -2;
+
+    const std::vector<std::string> names = split_csv(line);
+    auto col = [&names](const std::string& n) {
+        auto it = std::find(names.begin(), names.end(), n);
+        return it == names.end() ? -1 : (int)(it - names.begin());
+    };
+
+    const std::vector<int> clusters = dvfs.get_cluster_indices();
+    std::vector<int> freq_col, util_col;
+    for (int p : clusters) {
+        freq_col.push_back(col("cpu" + std::to_string(p) + "_cur_freq"));
+        util_col.push_back(col("cpu" + std::to_string(p) + "_util"));
+        if (freq_col.back() < 0) return -2;
+    }
+    const int cur_col = col("current_now"), volt_col = col("voltage_now"), mif_col = col("cur_freq");
+    if (cur_col < 0 || volt_col < 0 || mif_col < 0) return -2;
+
+    // thermal zone types sit between Time and gpu_min_clock
+    std::vector<std::pair<int, ThermalRole>> temp_cols;
+    const int gpu_col = col("gpu_min_clock");
+    for (int i = 1; i < (gpu_col < 0 ? 0 : gpu_col); ++i) {
+        temp_cols.emplace_back(i, thermal_role_of(dvfs.get_device_name(), names[i]));
+    }
+
+    int rows = 0;
+    while (std::getline(f, line)) {
+        const std::vector<std::string> v = split_csv(line);
+        if (v.size() < names.size()) continue;
+        auto num = [&v](int c, double& x) {
+            char* end;
+            x = strtod(v[c].c_str(), &end);
+            return end != v[c].c_str();
+        };
+
+        PowerObs o;
+        bool ok = true;
+        for (std::size_t s = 0; s < clusters.size() && ok; ++s) {
+            double mhz, u = 1.0;
+            ok = num(freq_col[s], mhz);
+            if (util_col[s] >= 0 && !num(util_col[s], u)) ok = false;
+            o.cpu_idx.push_back(nearest_index(dvfs.get_cpu_freq().at(clusters[s]), mhz * 1000.0));
+            o.util.push_back(std::min(1.0, std::max(0.0, u)));
+        }
+        double ua, uv, mif_mhz;
+        ok = ok && num(cur_col, ua) && num(volt_col, uv) && num(mif_col, mif_mhz);
+        if (!ok) continue;
+        o.watts = std::fabs(ua) * uv * 1e-12;
+        o.ram_idx = nearest_index(dvfs.get_ddr_freq(), mif_mhz * 1000.0);
+
+        double t_max = NAN;
+        o.role_c.assign((int)ThermalRole::OTHER + 1, NAN);
+        for (const auto& tc : temp_cols) {
+            double t;
+            if (!num(tc.first, t)) continue;
+            double& r = o.role_c[(int)tc.second];
+            if (!(t <= r)) r = t;
+            if (is_cpu_role(tc.second) && !(t <= t_max)) t_max = t;
+        }
+        if (!std::isnan(t_max)) o.temp_c = t_max;
+        num(0, o.t_s);
+
+        out.push_back(o);
+        ++rows;
+    }
+    return rows;
+}
+
+// ---- fitting ----
+int fit_power_model(const std::vector<PowerObs>& obs, const DVFS& dvfs, PowerModel& model) {
+    PowerModel m;
+    m.device = dvfs.get_device_name();
+    m.ddr_khz = dvfs.get_ddr_freq();
+    m.mif_w.assign(m.ddr_khz.size(), NAN);
+
+    for (int p : dvfs.get_cluster_indices()) {
+        ClusterPower c;
+        c.policy = p;
+        c.khz = dvfs.get_cpu_freq().at(p);
+        c.uv = dvfs.get_cpu_volt(p);
+        if (c.khz.empty()) return 2;
+        if (std::any_of(c.uv.begin(), c.uv.end(), [](int v) { return v <= 0; })) {
+            m.voltage_proxy = true;
+            for (std::size_t i = 0; i < c.khz.size(); ++i) {
+                c.uv[i] = (int)(1e6 * (0.5 + 0.5 * c.khz[i] / c.khz.back()));
+            }
+        }
+        m.clusters.push_back(c);
+    }
+
+    // columns: 3 per cluster, then one per observed ram index
+    const int nc = (int)m.clusters.size();
+    std::map<int, int> ram_col;
+    for (const auto& o : obs) {
+        if (o.ram_idx >= 0 && o.ram_idx < (int)m.ddr_khz.size()) ram_col.emplace(o.ram_idx, 0);
+    }
+    int p = 3 * nc;
+    for (auto& kv : ram_col) kv.second = p++;
+    if (ram_col.empty()) return 2;
+
+    LeastSquares ls(p);
+    std::vector<double> x(p);
+    for (const auto& o : obs) {
+        if ((int)o.cpu_idx.size() != nc || !ram_col.count(o.ram_idx)) continue;
+        std::fill(x.begin(), x.end(), 0.0);
+        for (int s = 0; s < nc; ++s) {
+            const ClusterPower& c = m.clusters[s];
+            const int idx = std::min((int)c.khz.size() - 1, std::max(0, o.cpu_idx[s]));
+            const double v = c.uv[idx] / 1e6;
+            x[3 * s] = o.util[s] * v * v * (c.khz[idx] / 1e6);
+            x[3 * s + 1] = v;
+            x[3 * s + 2] = v * (o.temp_c - 25.0);
+        }
+        x[ram_col[o.ram_idx]] = 1.0;
+        ls.add(x, o.watts);
+    }
+
+    std::vector<double> beta;
+    const int rc = ls.solve(beta);
+    if (rc != 0) return rc;
+
+    for (int s = 0; s < nc; ++s) {
+        m.clusters[s].dyn = beta[3 * s];
+        m.clusters[s].leak = beta[3 * s + 1];
+        m.clusters[s].leak_t = beta[3 * s + 2];
+    }
+    for (const auto& kv : ram_col) m.mif_w[kv.first] = beta[kv.second];
+    m.samples = ls.count();
+    m.rmse_w = std::sqrt(ls.rss(beta) / std::max(1L, m.samples));
+    m.r2 = ls.r2(beta);
+    model = m;
+    return 0;
+}
+
+double power_model_rmse(const PowerModel& model, const std::vector<PowerObs>& obs) {
+    double se = 0.0;
+    for (const auto& o : obs) {
+        const double e = model.predict(o.cpu_idx, o.util, o.ram_idx, o.temp_c) - o.watts;
+        se += e * e;
+    }
+    return obs.empty() ? 0.0 : std::sqrt(se / obs.size());
+}
@@ -0,0 +1,83 @@
+#ifndef POWER_MODEL_H
+#define POWER_MODEL_H
+
+#include "dvfs.h"
+
+#include <string>
+#include <vector>
+
+/* ** Platform power model **
+ *
+ * P = sum over clusters [ dyn x util x V^2 x f  +  leak x V  +  leak_t x V x (T - 25) ]
+ *     + mif[ram index]   (DDR power and the platform base power)
+ * with V in volts, f in GHz and T the hottest cpu zone in degC.
+ * Fitted by least squares (least_squares.h) on kernel_hard logs of burner
+ * runs (record_hard(): cpu<p>_cur_freq, cpu<p>_util, current_now x voltage_now,
+ * MIF cur_freq, thermal zones). OPP voltages come from DVFS::load_voltages();
+ * without them V is a proxy, 0.5 + 0.5 x f / f_max.
+ * Saved as text per device, so controllers can predict power at their own
+ * rate instead of the fuel-gauge refresh rate.
+ *
+ * ex)
+ *   std::vector<PowerObs> obs;
+ *   load_hard_log("output/kernel_hard_12_11.txt", dvfs, obs);
+ *   PowerModel m;
+ *   if (fit_power_model(obs, dvfs, m) == 0) m.save(power_model_path("Pixel9"));
+ *   double w = m.predict(dvfs.make_state(12, 11).cpu_idx, {}, 11, 40.0);
+ */
+struct ClusterPower {
+    int policy = -1;
+    std::vector<int> khz;      // OPP table
+    std::vector<int> uv;       // voltage per OPP (proxy if voltage_proxy)
+    double dyn = 0.0;          // W per util x V^2 x GHz
+    double leak = 0.0;         // W per V
+    double leak_t = 0.0;       // W per V x degC above 25
+};
+
+class PowerModel {
+public:
+    std::string device;
+    std::vector<ClusterPower> clusters; // cluster_indices order
+    std::vector<int> ddr_khz;
+    std::vector<double> mif_w;          // per ram index (NAN: not observed)
+    bool voltage_proxy = false;
+    long samples = 0;
+    double rmse_w = 0.0;
+    double r2 = 0.0;
+
+    bool empty() const { return clusters.empty(); }
+
+    // W; util per slot (missing: 1), ram_idx -1: highest observed index
+    double predict(const std::vector<int>& cpu_idx, const std::vector<double>& util, int ram_idx, double temp_c) const;
+    double cluster_w(int slot, int idx, double util, double temp_c) const;
+    double mif_power(int ram_idx) const; // nearest observed index
+
+    // return 0 on success (-1: I/O, -2: syntax or device mismatch)
+    int save(const std::string& path) const;
+    int load(const std::string& path, const std::string& expect_device = "");
+    std::string describe() const;
+};
+
+// $DDS_CACHE_DIR (else $HOME)/.dds_power_<device>.txt
+std::string power_model_path(const std::string& device);
+
+struct PowerObs {
+    double t_s = 0.0;          // log Time
+    std::vector<int> cpu_idx;  // per slot
+    std::vector<double> util;  // per slot (1 if not logged)
+    int ram_idx = -1;
+    double temp_c = 25.0;      // hottest cpu zone
+    std::vector<double> role_c; // hottest zone per ThermalRole (NAN: none logged)
+    double watts = 0.0;
+};
+
+// kernel_hard log -> observations on the OPP tables of dvfs
+// return the number of rows read (-1: unreadable, -2: missing columns)
+int load_hard_log(const std::string& path, const DVFS& dvfs, std::vector<PowerObs>& out);
+
+// return 0 on success (1: too few samples, 2: degenerate data)
+int fit_power_model(const std::vector<PowerObs>& obs, const DVFS& dvfs, PowerModel& model);
+// rms error of the model on observations (W)
+double power_model_rmse(const PowerModel& model, const std::vector<PowerObs>& obs);
+
+#endif // POWER_MODEL_H
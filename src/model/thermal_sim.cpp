@@ -0,0 +1,426 @@
+#include "thermal_sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+// ---- network ----
+ThermalNetwork ThermalNetwork::make_default(const DVFS& dvfs) {
+    ThermalNetwork net;
+    net.device = dvfs.get_device_name();
+
+    const std::vector<int> clusters = dvfs.get_cluster_indices();
+    const int nc = (int)clusters.size();
+    for (int s = 0; s < nc; ++s) {
+        ThermalNode c;
+        c.name = "cpu" + std::to_string(clusters[s]);
+        c.slot = s;
+        if (nc == 1) c.role = ThermalRole::CPU;
+        else if (s == nc - 1) c.role = ThermalRole::BIG;
+        else if (s == 0) c.role = ThermalRole::LITTLE;
+        else c.role = ThermalRole::MID;
+        c.cap_j = (nc > 1 && s == nc - 1) ? 4.0 : 2.0;
+        net.nodes.push_back(c);
+    }
+    const int soc = nc, skin = nc + 1, batt = nc + 2;
+    net.nodes.push_back({ "soc", ThermalRole::OTHER, -1, true, 10.0 });
+    net.nodes.push_back({ "skin", ThermalRole::SKIN, -1, false, 40.0 });
+    net.nodes.push_back({ "battery", ThermalRole::BATTERY, -1, false, 80.0 });
+
+    for (int s = 0; s < nc; ++s) {
+        net.edges.push_back({ s, soc, 1.0 });
+        if (s > 0) net.edges.push_back({ s - 1, s, 0.3 });
+    }
+    net.edges.push_back({ soc, skin, 0.5 });
+    net.edges.push_back({ skin, batt, 0.4 });
+    net.edges.push_back({ skin, -1, 0.15 });
+    net.edges.push_back({ batt, -1, 0.03 });
+    return net;
+}
+
+int ThermalNetwork::node_of(ThermalRole role) const {
+    for (int i = 0; i < (int)nodes.size(); ++i) {
+        if (nodes[i].role == role) return i;
+    }
+    return -1;
+}
+
+int ThermalNetwork::hottest_cpu(const std::vector<double>& temp) const {
+    int best = -1;
+    for (int i = 0; i < (int)nodes.size(); ++i) {
+        if (nodes[i].slot >= 0 && (best < 0 || temp[i] > temp[best])) best = i;
+    }
+    return best;
+}
+
+std::string thermal_net_path(const std::string& device) {
+    const char* dir = getenv("DDS_CACHE_DIR");
+    if (!dir || !*dir) dir = getenv("HOME");
+    std::string base = (dir && *dir) ? std::string(dir) : std::string(".");
+    if (base.back() != '/') base += "/";
+    return base + ".dds_thermal_" + device + ".txt";
+}
+
+static bool role_from_name(const std::string& name, ThermalRole& out) {
+    for (int r = 0; r <= (int)ThermalRole::OTHER; ++r) {
+        if (name == thermal_role_name((ThermalRole)r)) {
+            out = (ThermalRole)r;
+            return true;
+        }
+    }
+    return false;
+}
+
+int ThermalNetwork::save(const std::string& path) const {
+    std::ofstream f(path);
+    if (!f) return -1;
+    f.precision(9);
+    f << "# dds thermal network: C dT/dt = P - sum G (T - T_j)\n";
+    f << "device " << device << "\n";
+    f << "ambient " << ambient_c << "\n";
+    f << "fit " << samples << " " << rmse_c << "\n";
+    for (const auto& n : nodes) {
+        f << "node " << n.name << " " << thermal_role_name(n.role) << " " << n.slot << " " << (n.mif ? 1 : 0)
+          << " " << n.cap_j << "\n";
+    }
+    for (const auto& e : edges) f << "edge " << e.a << " " << e.b << " " << e.g << "\n";
+    return f ? 0 : -1;
+}
+
+int ThermalNetwork::load(const std::string& path, const std::string& expect_device) {
+    std::ifstream f(path);
+    if (!f) return -1;
+
+    ThermalNetwork net;
+    std::string line;
+    while (std::getline(f, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream ss(line);
+        std::string key;
+        ss >> key;
+        if (key == "device") {
+            ss >> net.device;
+        } else if (key == "ambient") {
+            ss >> net.ambient_c;
+        } else if (key == "fit") {
+            ss >> net.samples >> net.rmse_c;
+        } else if (key == "node") {
+            ThermalNode n;
+            std::string role;
+            int mif = 0;
+            if (!(ss >> n.name >> role >> n.slot >> mif >> n.cap_j) || !role_from_name(role, n.role)) return -2;
+            n.mif = mif != 0;
+            net.nodes.push_back(n);
+        } else if (key == "edge") {
+            ThermalEdge e;
+            if (!(ss >> e.a >> e.b >> e.g)) return -2;
+            net.edges.push_back(e);
+        } else {
+            return -2;
+        }
+        if (ss.fail()) return -2;
+    }
+    for (const auto& e : net.edges) {
+        if (e.a < 0 || e.a >= (int)net.nodes.size() || e.b >= (int)net.nodes.size()) return -2;
+    }
+    if (net.nodes.empty() || (!expect_device.empty() && net.device != expect_device)) return -2;
+    *this = net;
+    return 0;
+}
+
+std::string ThermalNetwork::describe() const {
+    std::ostringstream out;
+    out.precision(4);
+    out << "thermal network (" << device << ", ambient " << ambient_c << " degC";
+    if (samples > 0) out << ", " << samples << " samples, rmse " << rmse_c << " degC";
+    out << ")\n";
+    for (const auto& n : nodes) {
+        out << "  " << n.name << " [" << thermal_role_name(n.role) << "]: C " << n.cap_j << " J/K\n";
+    }
+    for (std::size_t i = 0; i < edges.size(); ++i) {
+        const ThermalEdge& e = edges[i];
+        out << "  " << nodes[e.a].name << " - " << (e.b < 0 ? std::string("ambient") : nodes[e.b].name)
+            << ": G " << e.g << " W/K";
+        if (i + 1 < edges.size()) out << "\n";
+    }
+    return out.str();
+}
+
+
+// ---- integrator ----
+ThermalStepper::ThermalStepper(const ThermalNetwork& net, double dt_sec) : dt(dt_sec), ambient_c(net.ambient_c) {
+    const int m = (int)net.nodes.size();
+    if (m == 0 || dt <= 0.0) return;
+
+    // A = C/dt + G (conductance Laplacian, ambient on the diagonal)
+    std::vector<double> a((std::size_t)m * m, 0.0);
+    c_dt.assign(m, 0.0);
+    g_amb.assign(m, 0.0);
+    for (int i = 0; i < m; ++i) {
+        c_dt[i] = net.nodes[i].cap_j / dt;
+        a[(std::size_t)i * m + i] = c_dt[i];
+    }
+    for (const auto& e : net.edges) {
+        a[(std::size_t)e.a * m + e.a] += e.g;
+        if (e.b < 0) {
+            g_amb[e.a] += e.g;
+            continue;
+        }
+        a[(std::size_t)e.b * m + e.b] += e.g;
+        a[(std::size_t)e.a * m + e.b] -= e.g;
+        a[(std::size_t)e.b * m + e.a] -= e.g;
+    }
+
+    // Gauss-Jordan with partial pivoting
+    inv.assign((std::size_t)m * m, 0.0);
+    for (int i = 0; i < m; ++i) inv[(std::size_t)i * m + i] = 1.0;
+    for (int col = 0; col < m; ++col) {
+        int piv = col;
+        for (int r = col + 1; r < m; ++r) {
+            if (std::fabs(a[(std::size_t)r * m + col]) > std::fabs(a[(std::size_t)piv * m + col])) piv = r;
+        }
+        if (std::fabs(a[(std::size_t)piv * m + col]) < 1e-12) return; // singular: ok() stays false
+        if (piv != col) {
+            for (int k = 0; k < m; ++k) {
+                std::swap(a[(std::size_t)piv * m + k], a[(std::size_t)col * m + k]);
+                std::swap(inv[(std::size_t)piv * m + k], inv[(std::size_t)col * m + k]);
+            }
+        }
+        const double d = 1.0 / a[(std::size_t)col * m + col];
+        for (int k = 0; k < m; ++k) {
+            a[(std::size_t)col * m + k] *= d;
+            inv[(std::size_t)col * m + k] *= d;
+        }
+        for (int r = 0; r < m; ++r) {
+            const double f = a[(std::size_t)r * m + col];
+            if (r == col || f == 0.0) continue;
+            for (int k = 0; k < m; ++k) {
+                a[(std::size_t)r * m + k] -= f * a[(std::size_t)col * m + k];
+                inv[(std::size_t)r * m + k] -= f * inv[(std::size_t)col * m + k];
+            }
+        }
+    }
+    n = m;
+}
+
+void ThermalStepper::step(std::vector<double>& temp, const std::vector<double>& power) const {
+    double rhs[32];
+    std::vector<double> big;
+    double* b = rhs;
+    if (n > 32) {
+        big.resize(n);
+        b = big.data();
+    }
+    for (int i = 0; i < n; ++i) b[i] = c_dt[i] * temp[i] + power[i] + g_amb[i] * ambient_c;
+    for (int i = 0; i < n; ++i) {
+        const double* row = &inv[(std::size_t)i * n];
+        double s = 0.0;
+        for (int k = 0; k < n; ++k) s += row[k] * b[k];
+        temp[i] = s;
+    }
+}
+
+void node_power(const ThermalNetwork& net, const PowerModel& model, const std::vector<int>& cpu_idx,
+                const std::vector<double>& util, int ram_idx, const std::vector<double>& temp,
+                std::vector<double>& power) {
+    power.assign(net.nodes.size(), 0.0);
+    for (std::size_t i = 0; i < net.nodes.size(); ++i) {
+        const ThermalNode& n = net.nodes[i];
+        if (n.slot >= 0) {
+            const int idx = n.slot < (int)cpu_idx.size() ? cpu_idx[n.slot] : -1;
+            const double u = n.slot < (int)util.size() ? util[n.slot] : 1.0;
+            power[i] += model.cluster_w(n.slot, idx, u, temp[i]);
+        }
+        if (n.mif) power[i] += model.mif_power(ram_idx);
+    }
+}
+
+
+// ---- fitting ----
+// temperature of a node in an observation (the BIG node also takes generic cpu zones)
+static double observed_c(const ThermalNetwork& net, int node, const PowerObs& o) {
+    const ThermalNode& n = net.nodes[node];
+    if ((int)o.role_c.size() <= (int)ThermalRole::OTHER || n.role == ThermalRole::OTHER) return NAN;
+    double t = o.role_c[(int)n.role];
+    if (std::isnan(t) && n.slot >= 0 && net.node_of(ThermalRole::CPU) < 0) {
+        bool last = true;
+        for (const auto& m : net.nodes) last = last && m.slot <= n.slot;
+        if (last) t = o.role_c[(int)ThermalRole::CPU];
+    }
+    return t;
+}
+
+static bool consecutive(const PowerObs& a, const PowerObs& b) {
+    const double dt = b.t_s - a.t_s;
+    return dt > 0.0 && dt <= 5.0;
+}
+
+int fit_thermal_network(const std::vector<PowerObs>& obs, const PowerModel& model, ThermalNetwork& net) {
+    // step of the free run: median spacing of the rows
+    std::vector<double> gaps;
+    bool seen = false;
+    for (std::size_t k = 0; k + 1 < obs.size(); ++k) {
+        if (consecutive(obs[k], obs[k + 1])) gaps.push_back(obs[k + 1].t_s - obs[k].t_s);
+    }
+    for (std::size_t i = 0; i < net.nodes.size() && !obs.empty(); ++i) {
+        seen = seen || !std::isnan(observed_c(net, (int)i, obs[0]));
+    }
+    if (gaps.size() < 10) return 1;
+    if (!seen) return 2;
+    std::nth_element(gaps.begin(), gaps.begin() + gaps.size() / 2, gaps.end());
+    const double dt = gaps[gaps.size() / 2];
+
+    // parameters in log scale: capacities, then conductances
+    const std::size_t nn = net.nodes.size();
+    std::vector<double> x;
+    for (const auto& n : net.nodes) x.push_back(std::log(n.cap_j));
+    for (const auto& e : net.edges) x.push_back(std::log(e.g));
+    auto apply = [&](const std::vector<double>& v, ThermalNetwork& out) {
+        for (std::size_t i = 0; i < nn; ++i) out.nodes[i].cap_j = std::exp(v[i]);
+        for (std::size_t e = 0; e < out.edges.size(); ++e) out.edges[e].g = std::exp(v[nn + e]);
+    };
+
+    // compass search on the free-run error: unobserved nodes (soc, ...) are fitted
+    // through their effect on the observed ones, which one-step regression cannot do
+    ThermalNetwork trial = net;
+    double best = thermal_trace_rmse(net, model, obs, dt);
+    for (double step = std::log(2.0); step > std::log(1.01); step *= 0.5) {
+        for (int sweep = 0; sweep < 20; ++sweep) {
+            bool improved = false;
+            for (std::size_t i = 0; i < x.size(); ++i) {
+                for (double dir : { step, -step }) {
+                    std::vector<double> y = x;
+                    y[i] = std::min(std::log(1e4), std::max(std::log(1e-4), y[i] + dir));
+                    apply(y, trial);
+                    const double err = thermal_trace_rmse(trial, model, obs, dt);
+                    if (err < best - 1e-9) {
+                        best = err;
+                        x = y;
+                        improved = true;
+                        break;
+                    }
+                }
+            }
+            if (!improved) break;
+        }
+    }
+
+    apply(x, net);
+    net.samples = (long)obs.size();
+    net.rmse_c = best;
+    return 0;
+}
+
+double thermal_trace_rmse(const ThermalNetwork& net, const PowerModel& model, const std::vector<PowerObs>& obs,
+                          double dt_sec) {
+    ThermalStepper st(net, dt_sec);
+    if (!st.ok() || obs.empty()) return 0.0;
+    const int m = (int)net.nodes.size();
+
+    std::vector<double> temp(m), power;
+    // (re)start from the observed nodes, the others at their mean
+    auto init = [&](const PowerObs& o) {
+        double sum = 0.0;
+        int n = 0;
+        for (int i = 0; i < m; ++i) {
+            temp[i] = observed_c(net, i, o);
+            if (!std::isnan(temp[i])) { sum += temp[i]; ++n; }
+        }
+        for (int i = 0; i < m; ++i) {
+            if (std::isnan(temp[i])) temp[i] = n > 0 ? sum / n : net.ambient_c;
+        }
+    };
+
+    init(obs[0]);
+    double se = 0.0;
+    long cnt = 0;
+    for (std::size_t k = 0; k + 1 < obs.size(); ++k) {
+        if (!consecutive(obs[k], obs[k + 1])) {
+            init(obs[k + 1]);
+            continue;
+        }
+        const int steps = std::max(1, (int)std::lround((obs[k + 1].t_s - obs[k].t_s) / dt_sec));
+        for (int s = 0; s < steps; ++s) {
+            node_power(net, model, obs[k].cpu_idx, obs[k].util, obs[k].ram_idx, temp, power);
+            st.step(temp, power);
+        }
+        for (int i = 0; i < m; ++i) {
+            const double t = observed_c(net, i, obs[k + 1]);
+            if (std::isnan(t)) continue;
+            se += (temp[i] - t) * (temp[i] - t);
+            ++cnt;
+        }
+    }
+    return cnt > 0 ? std::sqrt(se / cnt) : 0.0;
+}
+
+
+// ---- pulse scenarios ----
+int simulate_jolts(const ThermalNetwork& net, const PowerModel& model, DVFS& dvfs,
+                   const std::vector<JoltScenario>& scenarios, std::vector<JoltResult>& results,
+                   int threads, double dt_sec) {
+    if (model.empty()) return 2;
+    const ThermalStepper st(net, dt_sec);
+    if (!st.ok()) return 1;
+
+    // DVFS states resolved once (make_state() reads the cluster mapping table)
+    std::vector<DvfsState> warm(scenarios.size()), pulse(scenarios.size());
+    for (std::size_t i = 0; i < scenarios.size(); ++i) {
+        warm[i] = dvfs.make_state(scenarios[i].warm_cpu, scenarios[i].warm_ram);
+        pulse[i] = dvfs.make_state(scenarios[i].pulse_cpu, scenarios[i].pulse_ram);
+    }
+    results.assign(scenarios.size(), JoltResult());
+
+    auto run_one = [&](std::size_t i, std::vector<double>& temp, std::vector<double>& power) {
+        const JoltScenario& sc = scenarios[i];
+        JoltResult& r = results[i];
+        const std::vector<double> util(warm[i].cpu_idx.size(), sc.util);
+        temp.assign(net.nodes.size(), std::isnan(sc.start_c) ? net.ambient_c : sc.start_c);
+
+        const long n_warm = std::lround(sc.warm_s / dt_sec);
+        const long n_pulse = std::lround(sc.pulse_s / dt_sec);
+        const long n_after = std::lround(sc.after_s / dt_sec);
+        for (long k = 0; k < n_warm + n_pulse + n_after; ++k) {
+            const DvfsState& s = (k >= n_warm && k < n_warm + n_pulse) ? pulse[i] : warm[i];
+            node_power(net, model, s.cpu_idx, util, s.ram_idx, temp, power);
+            for (double w : power) r.energy_j += w * dt_sec;
+            st.step(temp, power);
+
+            const double hot = temp[net.hottest_cpu(temp)];
+            if (k + 1 == n_warm) r.pulse_start_c = hot;
+            if (k >= n_warm && hot > r.peak_c) {
+                r.peak_c = hot;
+                r.time_to_peak_s = (k + 1 - n_warm) * dt_sec;
+            }
+            r.end_c = hot;
+        }
+        if (n_warm == 0) r.pulse_start_c = std::isnan(sc.start_c) ? net.ambient_c : sc.start_c;
+    };
+
+    if (threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min<int>(threads, (int)std::max<std::size_t>(1, scenarios.size()));
+
+    // dynamic chunks: scenarios of different lengths keep every worker busy
+    const std::size_t chunk = 16;
+    std::atomic<std::size_t> next{0};
+    auto worker = [&]() {
+        std::vector<double> temp, power;
+        for (;;) {
+            const std::size_t begin = next.fetch_add(chunk, std::memory_order_relaxed);
+            if (begin >= scenarios.size()) break;
+            const std::size_t end = std::min(scenarios.size(), begin + chunk);
+            for (std::size_t i = begin; i < end; ++i) run_one(i, temp, power);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool) th.join();
+    return 0;
+}
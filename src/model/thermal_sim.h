@@ -0,0 +1,127 @@
+#ifndef THERMAL_SIM_H
+#define THERMAL_SIM_H
+
+#include "power_model.h"
+#include "thermal.h"
+
+#include <string>
+#include <vector>
+
+/* ** RC thermal network **
+ *
+ * Lumped thermal model of a device: one node per cpu cluster, the SoC,
+ * the skin and the battery, with heat capacities (J/K) and conductances
+ * (W/K) between nodes and to the ambient:
+ *   C_i dT_i/dt = P_i - sum_j G_ij (T_i - T_j) - G_i,amb (T_i - T_amb)
+ * Cluster nodes take the cluster power of a PowerModel (leakage at the node
+ * temperature), the SoC node the MIF term. Integration is backward Euler:
+ * (C/dt + G) T' = C/dt T + P + G_amb T_amb, unconditionally stable, with the
+ * matrix inverted once per step size (ThermalStepper), so one step is a
+ * small matrix-vector product.
+ * Parameters start from generic values (make_default()) and are fitted on
+ * kernel_hard logs, where the zones of each role (thermal.h) observe one
+ * node, by minimising the free-run error of the whole trace.
+ *
+ * ex)
+ *   ThermalNetwork net = ThermalNetwork::make_default(dvfs);
+ *   net.load(thermal_net_path("Pixel9"), "Pixel9");
+ *   std::vector<JoltScenario> sc(1000);    // thermo_jolt-style pulses
+ *   std::vector<JoltResult> res;
+ *   simulate_jolts(net, power_model, dvfs, sc, res);
+ */
+struct ThermalNode {
+    std::string name;
+    ThermalRole role = ThermalRole::OTHER; // zones observing this node
+    int slot = -1;             // cpu slot powered by this node (-1: none)
+    bool mif = false;          // takes the MIF power
+    double cap_j = 10.0;       // J/K
+};
+
+struct ThermalEdge {
+    int a = 0;
+    int b = -1;                // -1: ambient
+    double g = 0.1;            // W/K
+};
+
+class ThermalNetwork {
+public:
+    std::string device;
+    std::vector<ThermalNode> nodes;
+    std::vector<ThermalEdge> edges;
+    double ambient_c = 25.0;
+    long samples = 0;          // fit
+    double rmse_c = 0.0;       // free-run error of the fit
+
+    // clusters (LITTLE .. BIG in slot order), soc, skin, battery with generic values
+    static ThermalNetwork make_default(const DVFS& dvfs);
+    int node_of(ThermalRole role) const; // -1 if no node
+    int hottest_cpu(const std::vector<double>& temp) const; // node index of the hottest cluster
+
+    // return 0 on success (-1: I/O, -2: syntax or device mismatch)
+    int save(const std::string& path) const;
+    int load(const std::string& path, const std::string& expect_device = "");
+    std::string describe() const;
+};
+
+// $DDS_CACHE_DIR (else $HOME)/.dds_thermal_<device>.txt
+std::string thermal_net_path(const std::string& device);
+
+class ThermalStepper {
+private:
+    int n = 0;
+    double dt = 0.0;
+    std::vector<double> inv;   // (C/dt + G)^-1, n x n
+    std::vector<double> c_dt;  // C/dt
+    std::vector<double> g_amb;
+    double ambient_c = 25.0;
+
+public:
+    ThermalStepper(const ThermalNetwork& net, double dt_sec);
+    bool ok() const { return n > 0; }  // false: singular network (no path to ambient)
+    double get_dt() const { return dt; }
+    // advance temp (degC per node) by dt under power (W per node)
+    void step(std::vector<double>& temp, const std::vector<double>& power) const;
+};
+
+// power per node for a DVFS state (cpu_idx per slot, util per slot, leakage at the node temperature)
+void node_power(const ThermalNetwork& net, const PowerModel& model, const std::vector<int>& cpu_idx,
+                const std::vector<double>& util, int ram_idx, const std::vector<double>& temp,
+                std::vector<double>& power);
+
+// fit capacities and conductances on kernel_hard observations (load_hard_log()),
+// starting from the values in net; return 0 on success (1: too few consecutive rows, 2: no node observed)
+int fit_thermal_network(const std::vector<PowerObs>& obs, const PowerModel& model, ThermalNetwork& net);
+// free run from the first observation; rms error over the observed nodes (degC)
+double thermal_trace_rmse(const ThermalNetwork& net, const PowerModel& model, const std::vector<PowerObs>& obs,
+                          double dt_sec = 0.05);
+
+
+/* ** Pulse scenarios **
+ *
+ * thermo_jolt in simulation: warm_s at the warm-up state, pulse_s at the
+ * pulse state, then after_s back at the warm-up state (prime cpu indices
+ * through DVFS::make_state(), -1: top OPP). Scenarios are independent and
+ * spread over worker threads.
+ */
+struct JoltScenario {
+    int warm_cpu = 0, warm_ram = -1;
+    int pulse_cpu = -1, pulse_ram = -1;
+    double warm_s = 30.0, pulse_s = 1.0, after_s = 10.0;
+    double util = 1.0;
+    double start_c = NAN;      // initial temperature of every node (NAN: ambient)
+};
+
+struct JoltResult {
+    double pulse_start_c = 0.0; // hottest cluster at the pulse
+    double peak_c = 0.0;
+    double time_to_peak_s = 0.0; // from the pulse
+    double end_c = 0.0;
+    double energy_j = 0.0;
+};
+
+// return 0 on success (1: singular network, 2: empty power model)
+int simulate_jolts(const ThermalNetwork& net, const PowerModel& model, DVFS& dvfs,
+                   const std::vector<JoltScenario>& scenarios, std::vector<JoltResult>& results,
+                   int threads = 0, double dt_sec = 0.05);
+
+#endif // THERMAL_SIM_H
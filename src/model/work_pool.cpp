@@ -0,0 +1,83 @@
+#include "work_pool.h"
+
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(int threads) {
+    if (threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 0; i < threads; ++i) queues.emplace_back(new Queue());
+    for (int i = 0; i < threads; ++i) workers.emplace_back(&WorkStealingPool::run, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lk(mu);
+        stopping = true;
+    }
+    work_cv.notify_all();
+    for (auto& th : workers) th.join();
+}
+
+void WorkStealingPool::submit(std::function<void()> task) {
+    Queue& q = *queues[next++ % queues.size()];
+    pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lk(q.mu);
+        q.tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lk(mu);
+        queued.fetch_add(1, std::memory_order_relaxed);
+    }
+    work_cv.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> lk(mu);
+    done_cv.wait(lk, [this] { return pending.load(std::memory_order_acquire) == 0; });
+}
+
+bool WorkStealingPool::take(int self, std::function<void()>& task) {
+    const int n = (int)queues.size();
+    // own deque: newest first (still warm in cache)
+    {
+        Queue& q = *queues[self];
+        std::lock_guard<std::mutex> lk(q.mu);
+        if (!q.tasks.empty()) {
+            task = std::move(q.tasks.back());
+            q.tasks.pop_back();
+            return true;
+        }
+    }
+    // steal the oldest task of another worker
+    for (int k = 1; k < n; ++k) {
+        Queue& q = *queues[(self + k) % n];
+        std::lock_guard<std::mutex> lk(q.mu);
+        if (!q.tasks.empty()) {
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+            stolen.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::run(int self) {
+    std::function<void()> task;
+    for (;;) {
+        if (take(self, task)) {
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            task();
+            task = nullptr;
+            if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lk(mu);
+                done_cv.notify_all();
+            }
+            continue;
+        }
+        std::unique_lock<std::mutex> lk(mu);
+        work_cv.wait(lk, [this] { return stopping || queued.load(std::memory_order_relaxed) > 0; });
+        if (stopping && queued.load(std::memory_order_relaxed) == 0) return;
+    }
+}
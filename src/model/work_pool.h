@@ -0,0 +1,59 @@
+#ifndef WORK_POOL_H
+#define WORK_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* ** Work-stealing pool **
+ *
+ * One task deque per worker: submit() deals tasks round-robin, a worker
+ * pops its own deque from the back and, when empty, steals from the front
+ * of the others. Tasks of uneven length (long traces, slow policies) then
+ * even out without a shared queue on the hot path.
+ *
+ * ex)
+ *   WorkStealingPool pool;                 // # of online cpus
+ *   for (int i = 0; i < n; ++i) pool.submit([&, i] { results[i] = run(i); });
+ *   pool.wait();
+ */
+class WorkStealingPool {
+private:
+    struct Queue {
+        std::mutex mu;
+        std::deque<std::function<void()>> tasks;
+    };
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex mu;                 // guards the sleep/wake and wait() conditions
+    std::condition_variable work_cv, done_cv;
+    std::atomic<long> queued{0};   // submitted, not yet taken
+    std::atomic<long> pending{0};  // submitted, not yet finished
+    std::atomic<long> stolen{0};
+    std::size_t next = 0;
+    bool stopping = false;
+
+public:
+    explicit WorkStealingPool(int threads = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void submit(std::function<void()> task);
+    void wait(); // until every submitted task has run
+    int size() const { return (int)workers.size(); }
+    long steals() const { return stolen.load(std::memory_order_relaxed); }
+
+private:
+    bool take(int self, std::function<void()>& task);
+    void run(int self);
+};
+
+#endif // WORK_POOL_H
@@ -0,0 +1,15 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <stdint.h>
+
+#include <chrono>
+
+// steady_clock in ns: the one time base of deadlines, periods and stamps
+// (actuator targets, governor and controller loops, trace playback, meters)
+inline int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#endif // CLOCK_H
@@ -0,0 +1,299 @@
+#include "burn.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+#if defined(__linux__) || defined(__ANDROID__)
+  #include <sched.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+  #include <immintrin.h>
+#elif defined(__aarch64__)
+  #include <arm_neon.h>
+  #if defined(__linux__)
+    #include <sys/auxv.h>
+    #ifndef HWCAP_SVE
+      #define HWCAP_SVE (1 << 22)
+    #endif
+  #endif
+#endif
+
+static void pin_self(int cpu) {
+#if defined(__linux__) || defined(__ANDROID__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    (void)sched_setaffinity(0, sizeof(set), &set);
+#else
+    (void)cpu;
+#endif
+}
+
+// run `threads` pinned threads until `seconds` pass; body(i, end) returns the work
+// done by thread i (and checks its own stop flag); return total work / elapsed seconds
+static double run_threads(int threads, double seconds, const std::vector<int>& cpus,
+                          const std::function<double(int, std::chrono::steady_clock::time_point)>& body) {
+    if (threads <= 0) threads = 1;
+    using clock = std::chrono::steady_clock;
+    const auto t0 = clock::now();
+    const auto end = t0 + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(seconds));
+
+    std::vector<double> work(threads, 0.0);
+    std::vector<std::thread> ths;
+    ths.reserve(threads);
+    for (int i = 0; i < threads; ++i) {
+        ths.emplace_back([&, i] {
+            if (!cpus.empty()) pin_self(cpus[i % cpus.size()]);
+            work[i] = body(i, end);
+        });
+    }
+    for (auto& t : ths) t.join();
+
+    double total = 0.0;
+    for (double w : work) total += w;
+    const double elapsed = std::chrono::duration<double>(clock::now() - t0).count();
+    return elapsed > 0.0 ? total / elapsed : 0.0;
+}
+
+static bool stopped(const std::atomic<bool>* stop) {
+    return stop && stop->load(std::memory_order_relaxed);
+}
+
+// ---- power-virus kernels ----
+// keep a value in a register, opaque to the optimizer: the chains stay
+// independent and are neither folded nor merged into wider vectors
+#if defined(__x86_64__) || defined(__i386__)
+  #define BURN_KEEP(x) asm volatile("" : "+x"(x))
+  #define BURN_KEEP_V(x) asm volatile("" : "+v"(x)) // any of zmm0-31
+#elif defined(__aarch64__)
+  #define BURN_KEEP(x) asm volatile("" : "+w"(x))
+#else
+  #define BURN_KEEP(x) asm volatile("" : "+m"(x))
+#endif
+
+// independent accumulators: FMA latency x FP pipes, within the register file
+// (x86 before AVX-512: 16 vector registers, 12 chains + 2 operands)
+#define BURN_CHAINS12(S) S(a0) S(a1) S(a2) S(a3) S(a4) S(a5) S(a6) S(a7) S(a8) S(a9) S(a10) S(a11)
+#define BURN_CHAINS16(S) BURN_CHAINS12(S) S(a12) S(a13) S(a14) S(a15)
+#if defined(__aarch64__)
+  #define BURN_CHAINS BURN_CHAINS16 // 32 registers, up to 4 FP pipes (Cortex-X)
+  static constexpr int CHAINS = 16;
+#else
+  #define BURN_CHAINS BURN_CHAINS12
+  static constexpr int CHAINS = 12;
+#endif
+
+typedef double v2d __attribute__((vector_size(16)));
+
+static constexpr int FLOP_ITERS = 100000;
+
+const char* flop_kernel_name(FlopKernel k) {
+    return k == FlopKernel::SCALAR ? "scalar" : "simd";
+}
+
+const char* mem_kernel_name(MemKernel k) {
+    switch (k) {
+        case MemKernel::READ: return "read";
+        case MemKernel::WRITE: return "write";
+        default: return "copy";
+    }
+}
+
+// scalar and 128-bit vector extension (SSE2 on x86)
+#define BURN_STEP(a) a = a * m + c; BURN_KEEP(a);
+#define BURN_SUM(a) sum += a;
+template <typename T>
+static double fma_chains() {
+    T a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15;
+    a0 = a1 = a2 = a3 = a4 = a5 = a6 = a7 = a8 = a9 = a10 = a11 = a12 = a13 = a14 = a15 = T{} + 1.0;
+    T m = T{} + 0.9999999, c = T{} + 1e-7;
+    BURN_KEEP(m);
+    BURN_KEEP(c);
+    for (int i = 0; i < FLOP_ITERS; ++i) {
+        BURN_CHAINS(BURN_STEP)
+    }
+    T sum = T{};
+    BURN_CHAINS(BURN_SUM)
+    asm volatile("" :: "m"(sum) : "memory");
+    return (double)CHAINS * 2.0 * FLOP_ITERS * (sizeof(T) / sizeof(double));
+}
+
+static double chains_scalar() { return fma_chains<double>(); }
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+static double chains_sse2() { return fma_chains<v2d>(); }
+
+#define AVX2_STEP(a) a = _mm256_fmadd_pd(a, m, c); BURN_KEEP(a);
+#define AVX2_SUM(a) sum = _mm256_add_pd(sum, a);
+__attribute__((target("avx2,fma"))) static double chains_avx2() {
+    __m256d a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11;
+    a0 = a1 = a2 = a3 = a4 = a5 = a6 = a7 = a8 = a9 = a10 = a11 = _mm256_set1_pd(1.0);
+    __m256d m = _mm256_set1_pd(0.9999999), c = _mm256_set1_pd(1e-7);
+    BURN_KEEP(m);
+    BURN_KEEP(c);
+    for (int i = 0; i < FLOP_ITERS; ++i) {
+        BURN_CHAINS12(AVX2_STEP)
+    }
+    __m256d sum = _mm256_setzero_pd();
+    BURN_CHAINS12(AVX2_SUM)
+    asm volatile("" :: "m"(sum) : "memory");
+    return 12.0 * 2.0 * FLOP_ITERS * 4;
+}
+
+#define AVX512_STEP(a) a = _mm512_fmadd_pd(a, m, c); BURN_KEEP_V(a);
+#define AVX512_SUM(a) sum = _mm512_add_pd(sum, a);
+__attribute__((target("avx512f"))) static double chains_avx512() {
+    __m512d a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15;
+    a0 = a1 = a2 = a3 = a4 = a5 = a6 = a7 = a8 = a9 = a10 = a11 = a12 = a13 = a14 = a15 = _mm512_set1_pd(1.0);
+    __m512d m = _mm512_set1_pd(0.9999999), c = _mm512_set1_pd(1e-7);
+    BURN_KEEP_V(m);
+    BURN_KEEP_V(c);
+    for (int i = 0; i < FLOP_ITERS; ++i) {
+        BURN_CHAINS16(AVX512_STEP)
+    }
+    __m512d sum = _mm512_setzero_pd();
+    BURN_CHAINS16(AVX512_SUM)
+    asm volatile("" :: "m"(sum) : "memory");
+    return 16.0 * 2.0 * FLOP_ITERS * 8;
+}
+#endif
+
+#if defined(__aarch64__)
+#define NEON_STEP(a) a = vfmaq_f64(c, a, m); BURN_KEEP(a);
+#define NEON_SUM(a) sum = vaddq_f64(sum, a);
+static double chains_neon() {
+    float64x2_t a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15;
+    a0 = a1 = a2 = a3 = a4 = a5 = a6 = a7 = a8 = a9 = a10 = a11 = a12 = a13 = a14 = a15 = vdupq_n_f64(1.0);
+    float64x2_t m = vdupq_n_f64(0.9999999), c = vdupq_n_f64(1e-7);
+    BURN_KEEP(m);
+    BURN_KEEP(c);
+    for (int i = 0; i < FLOP_ITERS; ++i) {
+        BURN_CHAINS16(NEON_STEP)
+    }
+    float64x2_t sum = vdupq_n_f64(0.0);
+    BURN_CHAINS16(NEON_SUM)
+    asm volatile("" :: "m"(sum) : "memory");
+    return 16.0 * 2.0 * FLOP_ITERS * 2;
+}
+
+#if defined(__linux__)
+// SVE in asm: the rest of the binary needs no SVE target. z0-z15 accumulate
+// z16 x z17 (a += 0.25: bounded over a chunk), at the vector length of the cpu
+static double chains_sve() {
+    uint64_t lanes = 0;
+    long n = FLOP_ITERS;
+    asm volatile(
+        ".arch_extension sve\n"
+        "cntd %[lanes]\n"
+        "ptrue p0.d\n"
+        "fmov z16.d, #0.5\n"
+        "fmov z17.d, #0.5\n"
+        "fmov z0.d, #1.0\n"  "fmov z1.d, #1.0\n"  "fmov z2.d, #1.0\n"  "fmov z3.d, #1.0\n"
+        "fmov z4.d, #1.0\n"  "fmov z5.d, #1.0\n"  "fmov z6.d, #1.0\n"  "fmov z7.d, #1.0\n"
+        "fmov z8.d, #1.0\n"  "fmov z9.d, #1.0\n"  "fmov z10.d, #1.0\n" "fmov z11.d, #1.0\n"
+        "fmov z12.d, #1.0\n" "fmov z13.d, #1.0\n" "fmov z14.d, #1.0\n" "fmov z15.d, #1.0\n"
+        "1:\n"
+        "fmla z0.d, p0/m, z16.d, z17.d\n"  "fmla z1.d, p0/m, z16.d, z17.d\n"
+        "fmla z2.d, p0/m, z16.d, z17.d\n"  "fmla z3.d, p0/m, z16.d, z17.d\n"
+        "fmla z4.d, p0/m, z16.d, z17.d\n"  "fmla z5.d, p0/m, z16.d, z17.d\n"
+        "fmla z6.d, p0/m, z16.d, z17.d\n"  "fmla z7.d, p0/m, z16.d, z17.d\n"
+        "fmla z8.d, p0/m, z16.d, z17.d\n"  "fmla z9.d, p0/m, z16.d, z17.d\n"
+        "fmla z10.d, p0/m, z16.d, z17.d\n" "fmla z11.d, p0/m, z16.d, z17.d\n"
+        "fmla z12.d, p0/m, z16.d, z17.d\n" "fmla z13.d, p0/m, z16.d, z17.d\n"
+        "fmla z14.d, p0/m, z16.d, z17.d\n" "fmla z15.d, p0/m, z16.d, z17.d\n"
+        "subs %[n], %[n], #1\n"
+        "b.ne 1b\n"
+        : [lanes] "=&r"(lanes), [n] "+r"(n)
+        :
+        // p0 is caller-saved and not live here (no SVE code generated around)
+        : "cc", "memory", "v0", "v1", "v2", "v3", "v4", "v5", "v6", "v7", "v8", "v9", "v10", "v11", "v12",
+          "v13", "v14", "v15", "v16", "v17");
+    return 16.0 * 2.0 * FLOP_ITERS * lanes;
+}
+#endif
+#endif
+
+const std::vector<BurnKernel>& burn_kernels() {
+    static const std::vector<BurnKernel> kernels = [] {
+        std::vector<BurnKernel> ks;
+        ks.push_back({ "scalar", 1, chains_scalar });
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+        __builtin_cpu_init();
+        ks.push_back({ "sse2", 2, chains_sse2 });
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) ks.push_back({ "avx2", 4, chains_avx2 });
+        if (__builtin_cpu_supports("avx512f")) ks.push_back({ "avx512", 8, chains_avx512 });
+#elif defined(__aarch64__)
+        ks.push_back({ "neon", 2, chains_neon });
+  #if defined(__linux__)
+        if (getauxval(AT_HWCAP) & HWCAP_SVE) ks.push_back({ "sve", 0, chains_sve });
+  #endif
+#else
+        ks.push_back({ "simd128", 2, [] { return fma_chains<v2d>(); } });
+#endif
+        return ks;
+    }();
+    return kernels;
+}
+
+const BurnKernel* find_burn_kernel(const std::string& name) {
+    const std::vector<BurnKernel>& ks = burn_kernels();
+    if (name == "auto") return &ks.back();
+    for (const auto& k : ks) {
+        if (name == k.name) return &k;
+    }
+    return nullptr;
+}
+
+double kernel_flops_for(const BurnKernel& k, int threads, double seconds, const std::vector<int>& cpus,
+                        const std::atomic<bool>* stop) {
+    return run_threads(threads, seconds, cpus, [&k, stop](int, std::chrono::steady_clock::time_point end) {
+        double flop = 0.0;
+        while (std::chrono::steady_clock::now() < end && !stopped(stop)) flop += k.chunk();
+        return flop;
+    }) / 1e9;
+}
+
+double flops_chunk(FlopKernel k) {
+    return k == FlopKernel::SCALAR ? chains_scalar() : find_burn_kernel("auto")->chunk();
+}
+
+double flops_for(FlopKernel k, int threads, double seconds, const std::vector<int>& cpus, const std::atomic<bool>* stop) {
+    return kernel_flops_for(k == FlopKernel::SCALAR ? burn_kernels().front() : *find_burn_kernel("auto"),
+                            threads, seconds, cpus, stop);
+}
+
+double membw_for(MemKernel k, int threads, double seconds, std::size_t bytes, const std::vector<int>& cpus,
+                 const std::atomic<bool>* stop) {
+    const std::size_t n = std::max<std::size_t>(bytes / sizeof(uint64_t), 1024);
+    return run_threads(threads, seconds, cpus, [k, n, stop](int, std::chrono::steady_clock::time_point end) {
+        // allocated and touched by the pinned thread (first touch)
+        std::vector<uint64_t> src(n, 1), dst(k == MemKernel::COPY ? n : 0, 0);
+        double moved = 0.0;
+        uint64_t pass = 0;
+        while (std::chrono::steady_clock::now() < end && !stopped(stop)) {
+            if (k == MemKernel::READ) {
+                uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+                for (std::size_t i = 0; i + 4 <= n; i += 4) {
+                    s0 += src[i]; s1 += src[i + 1]; s2 += src[i + 2]; s3 += src[i + 3];
+                }
+                uint64_t sum = s0 + s1 + s2 + s3;
+                asm volatile("" :: "r"(sum) : "memory");
+                moved += (double)n * sizeof(uint64_t);
+            } else if (k == MemKernel::WRITE) {
+                std::fill(src.begin(), src.end(), ++pass);
+                asm volatile("" :: "r"(src.data()) : "memory");
+                moved += (double)n * sizeof(uint64_t);
+            } else {
+                std::memcpy(dst.data(), src.data(), n * sizeof(uint64_t));
+                asm volatile("" :: "r"(dst.data()) : "memory");
+                moved += 2.0 * n * sizeof(uint64_t);
+            }
+        }
+        return moved;
+    }) / 1e9;
+}
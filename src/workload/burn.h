@@ -0,0 +1,70 @@
+#ifndef BURN_H
+#define BURN_H
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/* ** Power-virus kernels **
+ *
+ * FMA chains per instruction set, picked at run time (cpuid / hwcap):
+ *   scalar, sse2 | neon (128-bit), avx2 (FMA3, 256-bit), avx512 (512-bit),
+ *   sve (vector length of the cpu)
+ * 12 independent accumulators on x86 before AVX-512, 16 elsewhere, keep
+ * every FP pipe busy; register barriers keep the compiler from folding or
+ * merging the chains, so the binaries build at -O2.
+ * An FMA (a = a x m + c) counts 2 FLOP per lane.
+ *
+ * ex)
+ *   const BurnKernel* k = find_burn_kernel("auto"); // widest of this cpu
+ *   while (!stop) flop += k->chunk();
+ *   double gflops = kernel_flops_for(*k, 4, 1.0, { 4, 5, 6, 7 });
+ */
+struct BurnKernel {
+    const char* name;
+    int lanes;             // doubles per vector (0: known at run time)
+    double (*chunk)();     // one chunk (about 0.1-1 ms); return the FLOP done
+};
+
+// kernels this cpu runs, narrowest first
+const std::vector<BurnKernel>& burn_kernels();
+// by name, "auto": the widest (nullptr if not available here)
+const BurnKernel* find_burn_kernel(const std::string& name);
+// run `threads` busy threads for `seconds` (or until *stop)
+// cpus: pin thread i to cpus[i % size] (empty: no pinning)
+// return GFLOP/s over all threads
+double kernel_flops_for(const BurnKernel& k, int threads, double seconds, const std::vector<int>& cpus = {},
+                        const std::atomic<bool>* stop = nullptr);
+
+
+/* ** Peak kernels **
+ *
+ * Sustained FLOP/s and memory bandwidth, for the platform characterization
+ * (platform_char, model/platform_db.h):
+ * - SCALAR: the scalar power-virus kernel
+ * - SIMD:   the widest power-virus kernel of the cpu
+ * - READ / WRITE / COPY: streaming over a private buffer per thread, large
+ *   enough to miss the caches; COPY counts read + written bytes (STREAM).
+ *
+ * ex)
+ *   double gflops = flops_for(FlopKernel::SIMD, 4, 1.0, { 4, 5, 6, 7 });
+ *   double gbs = membw_for(MemKernel::COPY, 4, 1.0, 64 << 20);
+ */
+enum class FlopKernel { SCALAR, SIMD };
+enum class MemKernel { READ, WRITE, COPY };
+
+const char* flop_kernel_name(FlopKernel k);
+const char* mem_kernel_name(MemKernel k);
+
+// one chunk of FMA chains; return the FLOP done
+double flops_chunk(FlopKernel k);
+
+// run like kernel_flops_for(); return GFLOP/s over all threads
+double flops_for(FlopKernel k, int threads, double seconds, const std::vector<int>& cpus = {},
+                 const std::atomic<bool>* stop = nullptr);
+// bytes: buffer per thread; return GB/s over all threads
+double membw_for(MemKernel k, int threads, double seconds, std::size_t bytes = 64 << 20,
+                 const std::vector<int>& cpus = {}, const std::atomic<bool>* stop = nullptr);
+
+#endif // BURN_H
@@ -0,0 +1,184 @@
+#include "llm_sim.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+Matrix gemm(const Matrix &A, const Matrix &B, const std::string &op_name, const int &num_th, const bool verbose) {
+    // debugging output
+    if (!op_name.empty() && verbose) {
+        std::cout << "\n[GEMM Debug] Operation: '" << op_name << "'" << std::endl;
+        if (!A.empty() && !A[0].empty())
+            std::cout << "  - Matrix A dims: (" << A.size() << ", " << A[0].size() << ")" << std::endl;
+        else
+            std::cout << "  - Matrix A is empty or malformed." << std::endl;
+        if (!B.empty() && !B[0].empty())
+            std::cout << "  - Matrix B dims: (" << B.size() << ", " << B[0].size() << ")" << std::endl;
+        else
+            std::cout << "  - Matrix B is empty or malformed." << std::endl;
+    }
+
+    if (A.empty() || B.empty() || A[0].size() != B.size()) {
+        throw std::invalid_argument("Invalid GEMM dimensions.");
+    }
+
+    int m = A.size(), k = B.size(), n = B[0].size();
+    Matrix C(m, Vector(n, 0.0f));
+
+    unsigned int num_threads = num_th;
+    if (num_threads == 0) num_threads = 4;
+    std::vector<std::thread> threads;
+
+    int rows_per_thread = m / num_threads;
+
+    // worker function for each thread
+    auto worker = [&](int start_row, int end_row) {
+        for (int i = start_row; i < end_row; ++i) {
+            for (int j = 0; j < n; ++j) {
+                for (int l = 0; l < k; ++l) {
+                    C[i][j] += A[i][l] * B[l][j];
+                }
+            }
+        }
+    };
+
+    // spawn threads and distribute work
+    for (unsigned int i = 0; i < num_threads; ++i) {
+        int start_row = i * rows_per_thread;
+        int end_row = (i == num_threads - 1) ? m : start_row + rows_per_thread;
+        threads.emplace_back(worker, start_row, end_row);
+    }
+
+    // wait for all threads to finish
+    for (auto &th : threads) { th.join(); }
+
+    return C;
+}
+
+Vector gemv(const Vector &y, const Matrix &A, const Vector &x, const int &num_th, const bool verbose) {
+    if (verbose) { /* empty */
+    }
+
+    if (A.empty() || x.empty() || A[0].size() != x.size()) throw std::invalid_argument("Invalid GEMV dimensions.");
+    int m = A.size(), n = x.size();
+    Vector result_y = y; // y copy
+
+    unsigned int num_threads = num_th;
+    if (num_threads == 0) num_threads = 4;
+    std::vector<std::thread> threads;
+
+    int rows_per_thread = m / num_threads;
+
+    // worker function for each thread
+    auto worker = [&](int start_row, int end_row) {
+        for (int i = start_row; i < end_row; ++i) {
+            for (int j = 0; j < n; ++j) {
+                result_y[i] += A[i][j] * x[j];
+            }
+        }
+    };
+
+    // spawn threads and distribute work
+    for (unsigned int i = 0; i < num_threads; ++i) {
+        int start_row = i * rows_per_thread;
+        int end_row = (i == num_threads - 1) ? m : start_row + rows_per_thread;
+        threads.emplace_back(worker, start_row, end_row);
+    }
+
+    // wait for all threads to finish
+    for (auto &th : threads) { th.join(); }
+
+    return result_y;
+}
+
+// [mod] add name tags for debugging in GEMM
+Matrix transformer_layer_prefill(const Matrix &input,
+                                 const Matrix &W_q, const Matrix &/*W_k*/, const Matrix &W_v,
+                                 const Matrix &W_o, const Matrix &W_ffn1, const Matrix &W_ffn2,
+                                 const int &num_th) {
+    // prefill: input shape (seq_len, hidden_dim)
+    Matrix Q = gemm(input, W_q, "Prefill: Q = input * W_q", num_th);
+    Matrix AttentionOutput = gemm(Q, W_v, "Prefill: AttentionOutput = Q * W_v", num_th);
+    Matrix AttentionFinal = gemm(AttentionOutput, W_o, "Prefill: AttentionFinal = AttentionOutput * W_o", num_th);
+    Matrix ffn1_output = gemm(AttentionFinal, W_ffn1, "Prefill: ffn1_output = AttentionFinal * W_ffn1", num_th);
+    Matrix ffn2_output = gemm(ffn1_output, W_ffn2, "Prefill: ffn2_output = ffn1_output * W_ffn2", num_th);
+    return ffn2_output;
+}
+
+Vector transformer_layer_decode(const Vector &token,
+                                const Matrix &W_q, const Matrix &/*W_k*/, const Matrix &W_v,
+                                const Matrix &W_o, const Matrix &W_ffn1, const Matrix &W_ffn2,
+                                const int &num_th) {
+    // decode: token shape (hidden_dim,)
+    Vector y(W_q.size(), 0.0f);
+    Vector q = gemv(y, W_q, token, num_th);
+    Vector v = gemv(y, W_v, token, num_th);
+    Vector AttentionOutput = gemv(y, W_o, v, num_th);
+
+    Vector y_ffn(W_ffn2.size(), 0.0f);
+    Vector ffn1_output = gemv(y_ffn, W_ffn2, AttentionOutput, num_th);
+
+    Vector y_final(W_ffn1.size(), 0.0f);
+    Vector ffn2_output = gemv(y_final, W_ffn1, ffn1_output, num_th);
+    return ffn2_output;
+}
+
+LlmWeights random_weights(int hidden_dim, int ffn_dim, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> dis(-0.05f, 0.05f);
+    auto mat = [&](int rows, int cols) {
+        Matrix m(rows, Vector(cols));
+        for (auto &row : m) {
+            for (auto &v : row) v = dis(gen);
+        }
+        return m;
+    };
+
+    LlmWeights w;
+    w.hidden_dim = hidden_dim;
+    w.ffn_dim = ffn_dim;
+    w.W_q = mat(hidden_dim, hidden_dim);
+    w.W_k = mat(hidden_dim, hidden_dim);
+    w.W_v = mat(hidden_dim, hidden_dim);
+    w.W_o = mat(hidden_dim, hidden_dim);
+    w.W_ffn1 = mat(hidden_dim, ffn_dim);
+    w.W_ffn2 = mat(ffn_dim, hidden_dim);
+    return w;
+}
+
+double llm_prefill_for(const LlmWeights &w, int num_layers, int seq_len, int num_th, double seconds,
+                       const std::atomic<bool> *stop) {
+    using clock = std::chrono::steady_clock;
+    const auto t0 = clock::now();
+    long tokens = 0;
+    while (std::chrono::duration<double>(clock::now() - t0).count() < seconds &&
+           !(stop && stop->load(std::memory_order_relaxed))) {
+        Matrix out(seq_len, Vector(w.hidden_dim, 0.1f));
+        for (int l = 0; l < num_layers; ++l) {
+            out = transformer_layer_prefill(out, w.W_q, w.W_k, w.W_v, w.W_o, w.W_ffn1, w.W_ffn2, num_th);
+        }
+        tokens += seq_len;
+    }
+    const double elapsed = std::chrono::duration<double>(clock::now() - t0).count();
+    return elapsed > 0.0 ? tokens / elapsed : 0.0;
+}
+
+double llm_decode_for(const LlmWeights &w, int num_layers, int num_th, double seconds,
+                      const std::atomic<bool> *stop) {
+    using clock = std::chrono::steady_clock;
+    const auto t0 = clock::now();
+    long tokens = 0;
+    Vector token(w.hidden_dim, 0.1f);
+    while (std::chrono::duration<double>(clock::now() - t0).count() < seconds &&
+           !(stop && stop->load(std::memory_order_relaxed))) {
+        Vector t = token;
+        for (int l = 0; l < num_layers; ++l) {
+            t = transformer_layer_decode(t, w.W_q, w.W_k, w.W_v, w.W_o, w.W_ffn1, w.W_ffn2, num_th);
+        }
+        ++tokens;
+    }
+    const double elapsed = std::chrono::duration<double>(clock::now() - t0).count();
+    return elapsed > 0.0 ? tokens / elapsed : 0.0;
+}
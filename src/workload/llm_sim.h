@@ -0,0 +1,51 @@
+#ifndef LLM_SIM_H
+#define LLM_SIM_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+/* ** Dummy LLM inference kernels **
+ *
+ * The GEMM/GEMV transformer layers of dummy_test:
+ * - prefill: (seq_len, hidden) x weights, compute-bound (GEMM)
+ * - decode:  one token (hidden,) x weights, memory-bound (GEMV)
+ * Rows are split over num_th threads per operation.
+ *
+ * ex)
+ *   LlmWeights w = random_weights(256, 588);
+ *   double tok_s = llm_decode_for(w, 24, 4, 5.0); // decode tokens/s over 5 s
+ */
+using Vector = std::vector<float>;
+using Matrix = std::vector<std::vector<float>>;
+
+Matrix gemm(const Matrix &A, const Matrix &B, const std::string &op_name = "", const int &num_th = 4, const bool verbose = false);
+Vector gemv(const Vector &y, const Matrix &A, const Vector &x, const int &num_th = 4, const bool verbose = false);
+
+Matrix transformer_layer_prefill(const Matrix &input,
+                                 const Matrix &W_q, const Matrix &W_k, const Matrix &W_v,
+                                 const Matrix &W_o, const Matrix &W_ffn1, const Matrix &W_ffn2,
+                                 const int &num_th);
+Vector transformer_layer_decode(const Vector &token,
+                                const Matrix &W_q, const Matrix &W_k, const Matrix &W_v,
+                                const Matrix &W_o, const Matrix &W_ffn1, const Matrix &W_ffn2,
+                                const int &num_th);
+
+// one layer's weights (shared by every layer, as in dummy_test)
+struct LlmWeights {
+    Matrix W_q, W_k, W_v, W_o;
+    Matrix W_ffn1, W_ffn2;
+    int hidden_dim = 0;
+    int ffn_dim = 0;
+};
+
+LlmWeights random_weights(int hidden_dim, int ffn_dim, unsigned seed = 1);
+
+// run for `seconds` (or until *stop); return tokens/s
+// prefill: whole prompts of seq_len tokens, decode: single tokens
+double llm_prefill_for(const LlmWeights &w, int num_layers, int seq_len, int num_th, double seconds,
+                       const std::atomic<bool> *stop = nullptr);
+double llm_decode_for(const LlmWeights &w, int num_layers, int num_th, double seconds,
+                      const std::atomic<bool> *stop = nullptr);
+
+#endif // LLM_SIM_H